@@ -0,0 +1,20 @@
+#ifndef BINDLESS_GLSL
+#define BINDLESS_GLSL
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Must match RHI::Vulkan::BindlessHeapVK::SetIndex and BindlessHeapVK::Table
+#define BINDLESS_SET 1
+
+layout(set = BINDLESS_SET, binding = 0) uniform texture2D BindlessTextures[];
+layout(set = BINDLESS_SET, binding = 0) uniform textureCube BindlessCubeTextures[];
+layout(set = BINDLESS_SET, binding = 1, rgba8) uniform image2D BindlessStorageImages[];
+layout(set = BINDLESS_SET, binding = 3) uniform sampler BindlessSamplers[];
+
+#define BINDLESS_STORAGE_BUFFER(Type, Name) \
+    layout(set = BINDLESS_SET, binding = 2) buffer Name##Block { Type Data[]; } Name[]
+
+#define SampleBindless(textureIndex, samplerIndex, uv) \
+    texture(sampler2D(BindlessTextures[nonuniformEXT(textureIndex)], BindlessSamplers[nonuniformEXT(samplerIndex)]), uv)
+
+#endif
@@ -1,5 +1,7 @@
 #include "VaultEngine.hpp"
 
+#include <cassert>
+
 namespace Core
 {
     VaultEngine* VaultEngine::GetInstance()
@@ -10,20 +12,27 @@ namespace Core
 
     void VaultEngine::Init(Windows::GLFWindow *window, uint32_t width, uint32_t height)
     {
-        mWindow = window;
-
         Renderer::RendererCreateInfo rendererCI;
         rendererCI.Width = width;
         rendererCI.Height = height;
         rendererCI.ApplicationName = "Vultana";
         rendererCI.bEnableValidationLayers = true;
 
+        this->Init(window, rendererCI);
+    }
+
+    void VaultEngine::Init(Windows::GLFWindow *window, const Renderer::RendererCreateInfo &rendererCI)
+    {
+        assert(window != nullptr || rendererCI.bNullBackend);
+        mWindow = window;
+
         mRenderer = std::make_unique<Renderer::RendererBase>(mWindow);
         mRenderer->InitContext(rendererCI);
     }
 
     void VaultEngine::Shutdown()
     {
+        if (mRenderer) { mRenderer->Cleanup(); }
     }
 
     void VaultEngine::Tick()
@@ -13,6 +13,8 @@ namespace Core
         static VaultEngine* GetInstance();
 
         void Init(Windows::GLFWindow* window, uint32_t width, uint32_t height);
+        // 空后端不需要窗口，window可以为空
+        void Init(Windows::GLFWindow* window, const Renderer::RendererCreateInfo& rendererCI);
         void Shutdown();
         void Tick();
 
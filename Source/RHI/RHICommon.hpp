@@ -40,6 +40,8 @@ namespace RHI
             ACCELERATION_STRUCTURE_BUILD_INPUT_READONLY = (Value)vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR,
             ACCELERATION_STRUCTURE_STORAGE = (Value)vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR,
             SHADER_BINDING_TABLE = (Value)vk::BufferUsageFlagBits::eShaderBindingTableKHR,
+            SAMPLER_DESCRIPTOR_BUFFER = (Value)vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT,
+            RESOURCE_DESCRIPTOR_BUFFER = (Value)vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT,
         };
     };
 
@@ -58,6 +60,8 @@ namespace RHI
             DEPTH_STENCIL_ATTACHMENT = (Value)vk::ImageUsageFlagBits::eDepthStencilAttachment,
             INPUT_ATTACHMENT = (Value)vk::ImageUsageFlagBits::eInputAttachment,
             FRAGMENT_SHADING_RATE_ATTACHMENT = (Value)vk::ImageUsageFlagBits::eFragmentShadingRateAttachmentKHR,
+            // 只作为创建标志，内容不离开渲染通道的附件可以使用惰性分配的内存
+            TRANSIENT_ATTACHMENT = (Value)vk::ImageUsageFlagBits::eTransientAttachment,
         };
     };
 
@@ -1,12 +1,21 @@
 #pragma once
 
+#include "RHI/VulkanRHI/BindlessVK.hpp"
 #include "RHI/VulkanRHI/BufferVK.hpp"
 #include "RHI/VulkanRHI/CommandBufferVK.hpp"
+#include "RHI/VulkanRHI/CommandPoolVK.hpp"
 #include "RHI/VulkanRHI/DescriptorVK.hpp"
+#include "RHI/VulkanRHI/DescriptorBufferVK.hpp"
 #include "RHI/VulkanRHI/ImageVK.hpp"
+#include "RHI/VulkanRHI/IndirectDrawListVK.hpp"
+#include "RHI/VulkanRHI/MipDownsamplerVK.hpp"
+#include "RHI/VulkanRHI/NullBackendVK.hpp"
+#include "RHI/VulkanRHI/ParallelRecorderVK.hpp"
+#include "RHI/VulkanRHI/PipelineCacheVK.hpp"
 #include "RHI/VulkanRHI/PipelineVK.hpp"
 #include "RHI/VulkanRHI/RenderPassVK.hpp"
 #include "RHI/VulkanRHI/SamplerVK.hpp"
 #include "RHI/VulkanRHI/ShaderReflection.hpp"
 #include "RHI/VulkanRHI/ShaderVK.hpp"
+#include "RHI/VulkanRHI/TimestampQueryVK.hpp"
 #include "RHI/VulkanRHI/VirtualFrameVK.hpp"
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "BarrierBatchVK.hpp"
+
+#include <algorithm>
+
+namespace RHI::Vulkan
+{
+    // 队列族所有权转移必须与另一队列上的屏障成对出现，不能与其他屏障合并
+    template<typename Barrier>
+    static bool IsOwnershipTransfer(const Barrier& barrier)
+    {
+        return barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex;
+    }
+
+    void BarrierBatchVK::AddImageBarrier(const vk::ImageMemoryBarrier2 &barrier)
+    {
+        // 同一子资源上未提交的A->B与B->C可以直接合并为A->C
+        auto pending = std::find_if(mImageBarriers.begin(), mImageBarriers.end(),
+            [&barrier](const vk::ImageMemoryBarrier2& other)
+            {
+                return !IsOwnershipTransfer(other) && !IsOwnershipTransfer(barrier) &&
+                    other.image == barrier.image &&
+                    other.subresourceRange == barrier.subresourceRange &&
+                    other.newLayout == barrier.oldLayout;
+            });
+
+        if (pending != mImageBarriers.end())
+        {
+            // 中间状态之间没有命令，合并后的屏障只需等待A并阻塞C
+            pending->setNewLayout(barrier.newLayout);
+            pending->setDstStageMask(barrier.dstStageMask);
+            pending->setDstAccessMask(barrier.dstAccessMask);
+            mMergedCount++;
+        }
+        else
+        {
+            mImageBarriers.push_back(barrier);
+        }
+    }
+
+    void BarrierBatchVK::AddBufferBarrier(const vk::BufferMemoryBarrier2 &barrier)
+    {
+        auto pending = std::find_if(mBufferBarriers.begin(), mBufferBarriers.end(),
+            [&barrier](const vk::BufferMemoryBarrier2& other)
+            {
+                return !IsOwnershipTransfer(other) && !IsOwnershipTransfer(barrier) &&
+                    other.buffer == barrier.buffer && other.offset == barrier.offset && other.size == barrier.size;
+            });
+
+        if (pending != mBufferBarriers.end())
+        {
+            pending->setDstStageMask(barrier.dstStageMask);
+            pending->setDstAccessMask(barrier.dstAccessMask);
+            mMergedCount++;
+        }
+        else
+        {
+            mBufferBarriers.push_back(barrier);
+        }
+    }
+
+    static bool RangesOverlap(uint32_t baseA, uint32_t countA, uint32_t baseB, uint32_t countB)
+    {
+        return baseA < baseB + countB && baseB < baseA + countA;
+    }
+
+    bool BarrierBatchVK::Conflicts(const vk::ImageMemoryBarrier2 &barrier) const
+    {
+        const auto& range = barrier.subresourceRange;
+        for (const auto& pending : mImageBarriers)
+        {
+            if (pending.image != barrier.image) { continue; }
+            const auto& other = pending.subresourceRange;
+            bool mergeable = !IsOwnershipTransfer(pending) && !IsOwnershipTransfer(barrier);
+            if (mergeable && other == range && pending.newLayout == barrier.oldLayout) { continue; }
+
+            if ((other.aspectMask & range.aspectMask) &&
+                RangesOverlap(other.baseMipLevel, other.levelCount, range.baseMipLevel, range.levelCount) &&
+                RangesOverlap(other.baseArrayLayer, other.layerCount, range.baseArrayLayer, range.layerCount))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool BarrierBatchVK::Conflicts(const vk::BufferMemoryBarrier2 &barrier) const
+    {
+        for (const auto& pending : mBufferBarriers)
+        {
+            if (pending.buffer != barrier.buffer) { continue; }
+            bool mergeable = !IsOwnershipTransfer(pending) && !IsOwnershipTransfer(barrier);
+            if (mergeable && pending.offset == barrier.offset && pending.size == barrier.size) { continue; }
+
+            vk::DeviceSize pendingEnd = pending.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : pending.offset + pending.size;
+            vk::DeviceSize barrierEnd = barrier.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : barrier.offset + barrier.size;
+            if (pending.offset < barrierEnd && barrier.offset < pendingEnd) { return true; }
+        }
+        return false;
+    }
+
+    void BarrierBatchVK::Flush(const vk::CommandBuffer &cmdBuffer, CommandBufferStats &stats)
+    {
+        if (this->IsEmpty()) { return; }
+
+        // 每个屏障携带自己的阶段掩码，不再把整批屏障的阶段合并在一起
+        vk::DependencyInfo dependencyInfo {};
+        dependencyInfo.setBufferMemoryBarriers(mBufferBarriers);
+        dependencyInfo.setImageMemoryBarriers(mImageBarriers);
+        // 空后端的命令缓冲为空句柄，只统计数量
+        if (cmdBuffer) { cmdBuffer.pipelineBarrier2(dependencyInfo); }
+
+        stats.PipelineBarriers++;
+        stats.ImageBarriers += uint32_t(mImageBarriers.size());
+        stats.BufferBarriers += uint32_t(mBufferBarriers.size());
+        stats.MergedBarriers += mMergedCount;
+
+        this->Clear();
+    }
+
+    void BarrierBatchVK::Clear()
+    {
+        mImageBarriers.clear();
+        mBufferBarriers.clear();
+        mMergedCount = 0;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+
+#include <vector>
+
+namespace RHI::Vulkan
+{
+    struct CommandBufferStats
+    {
+        uint32_t PipelineBarriers = 0;
+        uint32_t ImageBarriers = 0;
+        uint32_t BufferBarriers = 0;
+        uint32_t MergedBarriers = 0;
+        uint32_t SkippedTransitions = 0;
+        uint32_t ElidedCommands = 0;
+        uint32_t DrawCalls = 0;
+        uint32_t Dispatches = 0;
+        uint32_t Copies = 0;
+        uint64_t CopiedBufferBytes = 0;
+
+        CommandBufferStats& operator+=(const CommandBufferStats& other)
+        {
+            PipelineBarriers += other.PipelineBarriers;
+            ImageBarriers += other.ImageBarriers;
+            BufferBarriers += other.BufferBarriers;
+            MergedBarriers += other.MergedBarriers;
+            SkippedTransitions += other.SkippedTransitions;
+            ElidedCommands += other.ElidedCommands;
+            DrawCalls += other.DrawCalls;
+            Dispatches += other.Dispatches;
+            Copies += other.Copies;
+            CopiedBufferBytes += other.CopiedBufferBytes;
+            return *this;
+        }
+    };
+
+    // 收集连续的布局转换，在下一次需要它们的命令之前合并为一次pipelineBarrier2
+    class BarrierBatchVK
+    {
+    public:
+        void AddImageBarrier(const vk::ImageMemoryBarrier2& barrier);
+        void AddBufferBarrier(const vk::BufferMemoryBarrier2& barrier);
+        // 与未提交的屏障作用于重叠的子资源且无法合并时返回true，此时必须先Flush
+        bool Conflicts(const vk::ImageMemoryBarrier2& barrier) const;
+        bool Conflicts(const vk::BufferMemoryBarrier2& barrier) const;
+        void Flush(const vk::CommandBuffer& cmdBuffer, CommandBufferStats& stats);
+        void Clear();
+
+        bool IsEmpty() const { return mImageBarriers.empty() && mBufferBarriers.empty(); }
+
+    private:
+        std::vector<vk::ImageMemoryBarrier2> mImageBarriers;
+        std::vector<vk::BufferMemoryBarrier2> mBufferBarriers;
+        uint32_t mMergedCount = 0;
+    };
+}
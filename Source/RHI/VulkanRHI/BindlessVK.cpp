@@ -0,0 +1,281 @@
+#include "BindlessVK.hpp"
+#include "BufferVK.hpp"
+#include "ImageVK.hpp"
+#include "SamplerVK.hpp"
+#include "CommonVK.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+
+namespace RHI::Vulkan
+{
+    static vk::DescriptorType TableToDescriptorType(BindlessHeapVK::Table table)
+    {
+        switch (table)
+        {
+        case BindlessHeapVK::Table::SAMPLED_IMAGE:
+            return vk::DescriptorType::eSampledImage;
+        case BindlessHeapVK::Table::STORAGE_IMAGE:
+            return vk::DescriptorType::eStorageImage;
+        case BindlessHeapVK::Table::STORAGE_BUFFER:
+            return vk::DescriptorType::eStorageBuffer;
+        case BindlessHeapVK::Table::SAMPLER:
+            return vk::DescriptorType::eSampler;
+        default:
+            assert(false);
+            return vk::DescriptorType::eSampler;
+        }
+    }
+
+    void BindlessHeapVK::Init(uint32_t virtualFrameCount)
+    {
+        auto& renderer = GetCurrentRenderer();
+        auto& device = renderer.GetDevice();
+
+        mVirtualFrameCount = std::max(virtualFrameCount, 1u);
+
+        // 空后端只维护索引分配，不创建描述符对象
+        if (renderer.IsNullBackend())
+        {
+            for (uint32_t i = 0; i < (uint32_t)Table::Count; i++)
+            {
+                mTables[i] = TableState {};
+                mTables[i].Capacity = DefaultCapacity[i];
+            }
+            return;
+        }
+
+        auto properties = renderer.GetPhysicalDevice().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+        const auto& limits = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+
+        const std::array<uint32_t, (size_t)Table::Count> deviceLimits = {
+            limits.maxDescriptorSetUpdateAfterBindSampledImages,
+            limits.maxDescriptorSetUpdateAfterBindStorageImages,
+            limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+            limits.maxDescriptorSetUpdateAfterBindSamplers,
+        };
+
+        std::array<vk::DescriptorSetLayoutBinding, (size_t)Table::Count> bindings {};
+        std::array<vk::DescriptorBindingFlags, (size_t)Table::Count> bindingFlags {};
+        std::array<vk::DescriptorPoolSize, (size_t)Table::Count> poolSizes {};
+
+        for (uint32_t i = 0; i < (uint32_t)Table::Count; i++)
+        {
+            auto& table = mTables[i];
+            table = TableState {};
+            table.Capacity = std::min(DefaultCapacity[i], deviceLimits[i]);
+
+            bindings[i]
+                .setBinding(i)
+                .setDescriptorType(TableToDescriptorType((Table)i))
+                .setDescriptorCount(table.Capacity)
+                .setStageFlags(vk::ShaderStageFlagBits::eAll);
+
+            bindingFlags[i] =
+                vk::DescriptorBindingFlagBits::ePartiallyBound |
+                vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+                vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+
+            poolSizes[i]
+                .setType(TableToDescriptorType((Table)i))
+                .setDescriptorCount(table.Capacity);
+        }
+
+        vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCI {};
+        bindingFlagsCI.setBindingFlags(bindingFlags);
+
+        vk::DescriptorSetLayoutCreateInfo layoutCI {};
+        layoutCI.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool);
+        layoutCI.setBindings(bindings);
+        layoutCI.setPNext(&bindingFlagsCI);
+        mDescSetLayout = device.createDescriptorSetLayout(layoutCI);
+
+        vk::DescriptorPoolCreateInfo poolCI {};
+        poolCI.setFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
+        poolCI.setMaxSets(1);
+        poolCI.setPoolSizes(poolSizes);
+        mDescPool = device.createDescriptorPool(poolCI);
+
+        vk::DescriptorSetAllocateInfo setAI {};
+        setAI.setDescriptorPool(mDescPool);
+        setAI.setSetLayouts(mDescSetLayout);
+        mDescSet = device.allocateDescriptorSets(setAI).front();
+
+        GDebugInfoCallback("Bindless", "Created bindless heap: " +
+            std::to_string(mTables[0].Capacity) + " sampled images, " +
+            std::to_string(mTables[1].Capacity) + " storage images, " +
+            std::to_string(mTables[2].Capacity) + " storage buffers, " +
+            std::to_string(mTables[3].Capacity) + " samplers");
+    }
+
+    void BindlessHeapVK::Destroy()
+    {
+        auto& device = GetCurrentRenderer().GetDevice();
+
+        if (mDescPool) { device.destroyDescriptorPool(mDescPool); }
+        if (mDescSetLayout) { device.destroyDescriptorSetLayout(mDescSetLayout); }
+
+        mDescPool = vk::DescriptorPool();
+        mDescSetLayout = vk::DescriptorSetLayout();
+        mDescSet = vk::DescriptorSet();
+        mPendingWrites.clear();
+        mPendingImageInfos.clear();
+        mPendingBufferInfos.clear();
+        for (auto& table : mTables) { table = TableState {}; }
+    }
+
+    BindlessIndex BindlessHeapVK::RegisterSampledImage(const ImageVK &image, ImageView view)
+    {
+        BindlessIndex index = AllocateIndex(Table::SAMPLED_IMAGE);
+        if (index == InvalidBindlessIndex) { return index; }
+
+        QueueImageWrite(Table::SAMPLED_IMAGE, index, vk::DescriptorImageInfo{
+            vk::Sampler{ },
+            image.GetNativeView(view),
+            ImageUsageToImageLayout(ImageUsage::SHADER_READ)
+        });
+        return index;
+    }
+
+    BindlessIndex BindlessHeapVK::RegisterStorageImage(const ImageVK &image, ImageView view)
+    {
+        BindlessIndex index = AllocateIndex(Table::STORAGE_IMAGE);
+        if (index == InvalidBindlessIndex) { return index; }
+
+        QueueImageWrite(Table::STORAGE_IMAGE, index, vk::DescriptorImageInfo{
+            vk::Sampler{ },
+            image.GetNativeView(view),
+            ImageUsageToImageLayout(ImageUsage::STORAGE)
+        });
+        return index;
+    }
+
+    BindlessIndex BindlessHeapVK::RegisterStorageBuffer(const BufferVK &buffer)
+    {
+        BindlessIndex index = AllocateIndex(Table::STORAGE_BUFFER);
+        if (index == InvalidBindlessIndex) { return index; }
+
+        QueueBufferWrite(Table::STORAGE_BUFFER, index, vk::DescriptorBufferInfo{
+            buffer.GetNativeBuffer(),
+            0,
+            VK_WHOLE_SIZE
+        });
+        return index;
+    }
+
+    BindlessIndex BindlessHeapVK::RegisterSampler(const SamplerVK &sampler)
+    {
+        BindlessIndex index = AllocateIndex(Table::SAMPLER);
+        if (index == InvalidBindlessIndex) { return index; }
+
+        QueueImageWrite(Table::SAMPLER, index, vk::DescriptorImageInfo{
+            sampler.GetNativeSampler(),
+            vk::ImageView{ },
+            vk::ImageLayout::eUndefined
+        });
+        return index;
+    }
+
+    void BindlessHeapVK::Release(Table table, BindlessIndex index)
+    {
+        if (index == InvalidBindlessIndex) { return; }
+
+        // 资源可能仍在飞行中的帧里被使用，等待所有虚拟帧结束后再复用索引
+        auto& state = mTables[(size_t)table];
+        state.RetiredIndices.push_back(RetiredIndex{ index, mFrameCounter });
+
+        // 丢弃尚未提交的写入，避免写入已经销毁的资源
+        mPendingWrites.erase(std::remove_if(mPendingWrites.begin(), mPendingWrites.end(),
+            [table, index](const PendingWrite& write) { return write.TableType == table && write.Index == index; }),
+            mPendingWrites.end());
+    }
+
+    void BindlessHeapVK::AdvanceFrame()
+    {
+        mFrameCounter++;
+        for (auto& table : mTables)
+        {
+            auto retired = std::partition(table.RetiredIndices.begin(), table.RetiredIndices.end(),
+                [this](const RetiredIndex& entry) { return entry.Frame + mVirtualFrameCount > mFrameCounter; });
+            for (auto it = retired; it != table.RetiredIndices.end(); it++)
+            {
+                table.FreeIndices.push_back(it->Index);
+            }
+            table.RetiredIndices.erase(retired, table.RetiredIndices.end());
+        }
+    }
+
+    void BindlessHeapVK::FlushWrites()
+    {
+        if (mPendingWrites.empty()) { return; }
+
+        std::vector<vk::WriteDescriptorSet> writeDescSets;
+        writeDescSets.reserve(mPendingWrites.size());
+
+        for (const auto& pending : mPendingWrites)
+        {
+            auto& writeDescSet = writeDescSets.emplace_back();
+            writeDescSet.setDstSet(mDescSet);
+            writeDescSet.setDstBinding((uint32_t)pending.TableType);
+            writeDescSet.setDstArrayElement(pending.Index);
+            writeDescSet.setDescriptorType(TableToDescriptorType(pending.TableType));
+            writeDescSet.setDescriptorCount(1);
+
+            if (pending.TableType == Table::STORAGE_BUFFER)
+            {
+                writeDescSet.setPBufferInfo(mPendingBufferInfos.data() + pending.InfoIndex);
+            }
+            else
+            {
+                writeDescSet.setPImageInfo(mPendingImageInfos.data() + pending.InfoIndex);
+            }
+        }
+        if (mDescSet) { GetCurrentRenderer().GetDevice().updateDescriptorSets(writeDescSets, { }); }
+
+        mPendingWrites.clear();
+        mPendingImageInfos.clear();
+        mPendingBufferInfos.clear();
+    }
+
+    void BindlessHeapVK::Bind(const vk::CommandBuffer &cmdBuffer, vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout)
+    {
+        this->FlushWrites();
+        if (cmdBuffer) { cmdBuffer.bindDescriptorSets(bindPoint, layout, SetIndex, mDescSet, { }); }
+    }
+
+    uint32_t BindlessHeapVK::GetUsedCount(Table table) const
+    {
+        const auto& state = mTables[(size_t)table];
+        return state.NextIndex - uint32_t(state.FreeIndices.size() + state.RetiredIndices.size());
+    }
+
+    BindlessIndex BindlessHeapVK::AllocateIndex(Table table)
+    {
+        auto& state = mTables[(size_t)table];
+        if (!state.FreeIndices.empty())
+        {
+            BindlessIndex index = state.FreeIndices.back();
+            state.FreeIndices.pop_back();
+            return index;
+        }
+        if (state.NextIndex < state.Capacity)
+        {
+            return state.NextIndex++;
+        }
+        GDebugInfoCallback("Bindless", "Bindless table " + std::to_string((uint32_t)table) + " is full");
+        return InvalidBindlessIndex;
+    }
+
+    void BindlessHeapVK::QueueImageWrite(Table table, BindlessIndex index, vk::DescriptorImageInfo imageInfo)
+    {
+        mPendingWrites.push_back(PendingWrite{ table, index, uint32_t(mPendingImageInfos.size()) });
+        mPendingImageInfos.push_back(imageInfo);
+    }
+
+    void BindlessHeapVK::QueueBufferWrite(Table table, BindlessIndex index, vk::DescriptorBufferInfo bufferInfo)
+    {
+        mPendingWrites.push_back(PendingWrite{ table, index, uint32_t(mPendingBufferInfos.size()) });
+        mPendingBufferInfos.push_back(bufferInfo);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace RHI::Vulkan
+{
+    class BufferVK;
+    class ImageVK;
+    class SamplerVK;
+
+    using BindlessIndex = uint32_t;
+    constexpr BindlessIndex InvalidBindlessIndex = BindlessIndex(-1);
+
+    // 全局Bindless描述符表，资源在创建时获得固定索引，Shader通过索引访问
+    class BindlessHeapVK
+    {
+    public:
+        enum class Table : uint32_t
+        {
+            SAMPLED_IMAGE = 0,
+            STORAGE_IMAGE,
+            STORAGE_BUFFER,
+            SAMPLER,
+            Count,
+        };
+
+        // 与Shader中的 layout(set = 1, binding = Table) 对应
+        constexpr static uint32_t SetIndex = 1;
+        constexpr static uint32_t DefaultCapacity[(size_t)Table::Count] = { 65536, 16384, 65536, 2048 };
+
+        void Init(uint32_t virtualFrameCount);
+        void Destroy();
+
+        BindlessIndex RegisterSampledImage(const ImageVK& image, ImageView view = ImageView::NATIVE);
+        BindlessIndex RegisterStorageImage(const ImageVK& image, ImageView view = ImageView::NATIVE);
+        BindlessIndex RegisterStorageBuffer(const BufferVK& buffer);
+        BindlessIndex RegisterSampler(const SamplerVK& sampler);
+        void Release(Table table, BindlessIndex index);
+
+        // 每帧调用一次，回收已经不被GPU使用的索引
+        void AdvanceFrame();
+        // 提交所有挂起的描述符写入
+        void FlushWrites();
+        void Bind(const vk::CommandBuffer& cmdBuffer, vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout);
+
+        const vk::DescriptorSetLayout& GetDescriptorSetLayout() const { return mDescSetLayout; }
+        const vk::DescriptorSet& GetDescriptorSet() const { return mDescSet; }
+        uint32_t GetCapacity(Table table) const { return mTables[(size_t)table].Capacity; }
+        uint32_t GetUsedCount(Table table) const;
+
+    private:
+        BindlessIndex AllocateIndex(Table table);
+        void QueueImageWrite(Table table, BindlessIndex index, vk::DescriptorImageInfo imageInfo);
+        void QueueBufferWrite(Table table, BindlessIndex index, vk::DescriptorBufferInfo bufferInfo);
+
+    private:
+        struct RetiredIndex
+        {
+            BindlessIndex Index;
+            uint64_t Frame;
+        };
+
+        struct TableState
+        {
+            uint32_t Capacity = 0;
+            uint32_t NextIndex = 0;
+            std::vector<BindlessIndex> FreeIndices;
+            std::vector<RetiredIndex> RetiredIndices;
+        };
+
+        struct PendingWrite
+        {
+            Table TableType;
+            BindlessIndex Index;
+            uint32_t InfoIndex;
+        };
+
+        vk::DescriptorPool mDescPool;
+        vk::DescriptorSetLayout mDescSetLayout;
+        vk::DescriptorSet mDescSet;
+
+        std::array<TableState, (size_t)Table::Count> mTables;
+        std::vector<PendingWrite> mPendingWrites;
+        std::vector<vk::DescriptorImageInfo> mPendingImageInfos;
+        std::vector<vk::DescriptorBufferInfo> mPendingBufferInfos;
+
+        uint64_t mFrameCounter = 0;
+        uint32_t mVirtualFrameCount = 1;
+    };
+}
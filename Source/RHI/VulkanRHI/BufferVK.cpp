@@ -12,11 +12,15 @@ namespace RHI::Vulkan
         this->mSize = other.mSize;
         this->mAllocation = other.mAllocation;
         this->mpMapped = other.mpMapped;
+        this->mStorageIndex = other.mStorageIndex;
+        this->mCurrentUsage = other.mCurrentUsage;
 
         other.mBuffer = vk::Buffer();
         other.mSize = 0;
         other.mAllocation = {};
         other.mpMapped = nullptr;
+        other.mStorageIndex = InvalidBindlessIndex;
+        other.mCurrentUsage = BufferUsage::UNKNOWN;
     }
 
     BufferVK::BufferVK(size_t size, BufferUsage::Value usage, MemoryUsage memoryUsage)
@@ -32,11 +36,15 @@ namespace RHI::Vulkan
         this->mSize = other.mSize;
         this->mAllocation = other.mAllocation;
         this->mpMapped = other.mpMapped;
+        this->mStorageIndex = other.mStorageIndex;
+        this->mCurrentUsage = other.mCurrentUsage;
 
         other.mBuffer = vk::Buffer();
         other.mSize = 0;
         other.mAllocation = {};
         other.mpMapped = nullptr;
+        other.mStorageIndex = InvalidBindlessIndex;
+        other.mCurrentUsage = BufferUsage::UNKNOWN;
 
         return *this;
     }
@@ -52,6 +60,12 @@ namespace RHI::Vulkan
         this->Destroy();
 
         this->mSize = size;
+        // 描述符缓冲后端通过设备地址引用Uniform/Storage Buffer
+        if (GetCurrentRenderer().IsDescriptorBufferEnabled() && (usage & (BufferUsage::UNIFORM_BUFFER | BufferUsage::STORAGE_BUFFER)))
+        {
+            usage |= BufferUsage::SHADER_DEVICE_ADDRESS;
+        }
+
         vk::BufferCreateInfo bufferCI {};
         bufferCI.setSize(mSize);
         bufferCI.setUsage(static_cast<vk::BufferUsageFlags>(usage));
@@ -59,6 +73,17 @@ namespace RHI::Vulkan
         bufferCI.setQueueFamilyIndices(bufferQueueFamilyIndices);
 
         this->mAllocation = AllocateBuffer(bufferCI, memoryUsage, &this->mBuffer);
+
+        if (usage & BufferUsage::STORAGE_BUFFER)
+        {
+            this->mStorageIndex = GetCurrentRenderer().GetBindlessHeap().RegisterStorageBuffer(*this);
+        }
+    }
+
+    vk::DeviceAddress BufferVK::GetDeviceAddress() const
+    {
+        if (GetCurrentRenderer().IsNullBackend()) { return 0; }
+        return GetCurrentRenderer().GetDevice().getBufferAddress(vk::BufferDeviceAddressInfo{ this->mBuffer });
     }
 
     bool BufferVK::IsMemoryMapped() const
@@ -121,8 +146,11 @@ namespace RHI::Vulkan
         if (this->mBuffer)
         {
             if (this->mpMapped != nullptr) { this->UnmapMemory(); }
+            GetCurrentRenderer().GetBindlessHeap().Release(BindlessHeapVK::Table::STORAGE_BUFFER, this->mStorageIndex);
+            this->mStorageIndex = InvalidBindlessIndex;
             DeallocateBuffer(this->mBuffer, this->mAllocation);
             this->mBuffer = vk::Buffer();
+            this->mCurrentUsage = BufferUsage::UNKNOWN;
         }
     }
 
@@ -3,6 +3,7 @@
 #include "RHI/RHICommon.hpp"
 
 #include "MemoryAllocatorVK.hpp"
+#include "BindlessVK.hpp"
 
 namespace RHI::Vulkan
 {
@@ -21,6 +22,12 @@ namespace RHI::Vulkan
 
         vk::Buffer GetNativeBuffer() const { return mBuffer; }
         size_t GetSize() const { return mSize; }
+        BindlessIndex GetStorageIndex() const { return mStorageIndex; }
+        vk::DeviceAddress GetDeviceAddress() const;
+
+        // 当前的用途，按录制顺序由CommandBufferVK维护
+        BufferUsage::Bits GetCurrentUsage() const { return mCurrentUsage; }
+        void SetCurrentUsage(BufferUsage::Bits usage) const { mCurrentUsage = usage; }
 
         bool IsMemoryMapped() const;
         uint8_t* MapMemory();
@@ -38,6 +45,8 @@ namespace RHI::Vulkan
         size_t mSize = 0;
         VmaAllocation mAllocation = VK_NULL_HANDLE;
         uint8_t* mpMapped = nullptr;
+        BindlessIndex mStorageIndex = InvalidBindlessIndex;
+        mutable BufferUsage::Bits mCurrentUsage = BufferUsage::UNKNOWN;
     };
 
     using BufferVKReference = std::reference_wrapper<const BufferVK>;
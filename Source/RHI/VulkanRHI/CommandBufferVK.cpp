@@ -1,20 +1,25 @@
 #include "CommandBufferVK.hpp"
 #include "CommonVK.hpp"
 
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+
 namespace RHI::Vulkan
 {
-    static vk::ImageMemoryBarrier GetImageMemoryBarrier(const ImageVK& image, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout)
+    static vk::ImageMemoryBarrier2 GetImageMemoryBarrier(const ImageVK& image, const vk::ImageSubresourceRange& subresourceRange, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout)
     {
-        auto subresourceRange = GetDefaultImageSubresourceRange(image);
-        vk::ImageMemoryBarrier barrier;
+        vk::ImageMemoryBarrier2 barrier;
         barrier
+            .setSrcStageMask(ImageUsageToPipelineStage(oldLayout))
+            .setDstStageMask(ImageUsageToPipelineStage(newLayout))
             .setSrcAccessMask(ImageUsageToAccessFlags(oldLayout))
             .setDstAccessMask(ImageUsageToAccessFlags(newLayout))
             .setOldLayout(ImageUsageToImageLayout(oldLayout))
             .setNewLayout(ImageUsageToImageLayout(newLayout))
             .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
             .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
-            .setImage(image.GetNativeHandle())
+            .setImage(image.GetNativeImage())
             .setSubresourceRange(subresourceRange);
 
         return barrier;
@@ -24,16 +29,96 @@ namespace RHI::Vulkan
     {
         vk::CommandBufferBeginInfo cmdBI {};
         cmdBI.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
-        mCmdBuffer.begin(cmdBI);
+        if (!this->IsNull()) { mCmdBuffer.begin(cmdBI); }
+        mBarriers.Clear();
+        mStats = CommandBufferStats {};
+        mbInsidePass = false;
+        mbSecondary = false;
+        this->InvalidateState();
+    }
+
+    void CommandBufferVK::Begin(const vk::CommandBufferInheritanceInfo &inheritance)
+    {
+        vk::CommandBufferBeginInfo cmdBI {};
+        cmdBI.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        // 动态渲染时pNext上挂vk::CommandBufferInheritanceRenderingInfo
+        if (inheritance.renderPass || inheritance.pNext != nullptr) { cmdBI.setFlags(cmdBI.flags | vk::CommandBufferUsageFlagBits::eRenderPassContinue); }
+        cmdBI.setPInheritanceInfo(&inheritance);
+        if (!this->IsNull()) { mCmdBuffer.begin(cmdBI); }
+        mBarriers.Clear();
+        mStats = CommandBufferStats {};
+        // 继续渲染通道的secondary全程位于通道内
+        mbInsidePass = bool(cmdBI.flags & vk::CommandBufferUsageFlagBits::eRenderPassContinue);
+        mbSecondary = true;
+        this->InvalidateState();
     }
 
     void CommandBufferVK::End()
     {
-        mCmdBuffer.end();
+        this->FlushBarriers();
+        if (!this->IsNull()) { mCmdBuffer.end(); }
+    }
+
+    void CommandBufferVK::FlushBarriers()
+    {
+        mBarriers.Flush(mCmdBuffer, mStats);
+    }
+
+    void CommandBufferVK::ResetQueries(vk::QueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+    {
+        if (this->IsNull()) { return; }
+        mCmdBuffer.resetQueryPool(queryPool, firstQuery, queryCount);
+    }
+
+    void CommandBufferVK::WriteTimestamp(vk::QueryPool queryPool, uint32_t query)
+    {
+        this->FlushBarriers();
+        if (this->IsNull()) { return; }
+        mCmdBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, queryPool, query);
+    }
+
+    template<typename Barrier>
+    static Barrier RestrictBarrierStages(Barrier barrier, vk::PipelineStageFlags2 supportedStages)
+    {
+        // 裁剪后没有剩余阶段时访问掩码也必须为空
+        if (supportedStages & vk::PipelineStageFlagBits2::eAllCommands) { return barrier; }
+        barrier.setSrcStageMask(barrier.srcStageMask & supportedStages);
+        barrier.setDstStageMask(barrier.dstStageMask & supportedStages);
+        if (!barrier.srcStageMask) { barrier.setSrcAccessMask({ }); }
+        if (!barrier.dstStageMask) { barrier.setDstAccessMask({ }); }
+        return barrier;
+    }
+
+    void CommandBufferVK::QueueImageBarrier(const vk::ImageMemoryBarrier2 &barrier)
+    {
+        // 通道内的屏障只能是自依赖，资源转换必须在BeginPass之前完成
+        assert(!mbInsidePass);
+        auto restricted = RestrictBarrierStages(barrier, mSupportedStages);
+        // 同一批次内重叠子资源上的屏障没有执行顺序保证
+        if (mBarriers.Conflicts(restricted)) { this->FlushBarriers(); }
+        mBarriers.AddImageBarrier(restricted);
     }
 
-    void CommandBufferVK::BeginPass(const NativeRenderPass &renderPass)
+    void CommandBufferVK::QueueBufferBarrier(const vk::BufferMemoryBarrier2 &barrier)
     {
+        assert(!mbInsidePass);
+        auto restricted = RestrictBarrierStages(barrier, mSupportedStages);
+        if (mBarriers.Conflicts(restricted)) { this->FlushBarriers(); }
+        mBarriers.AddBufferBarrier(restricted);
+    }
+
+    void CommandBufferVK::BeginPass(const NativeRenderPass &renderPass, vk::SubpassContents contents)
+    {
+        assert(!mbInsidePass);
+        this->FlushBarriers();
+        mbInsidePass = true;
+        if (this->IsNull())
+        {
+            // 空后端不录制通道命令，只跟踪绑定状态
+            if (contents == vk::SubpassContents::eInline) { this->BindPassState(renderPass); }
+            return;
+        }
+
         if (renderPass.RenderPassHandle)
         {
             vk::RenderPassBeginInfo rpBI {};
@@ -42,54 +127,243 @@ namespace RHI::Vulkan
             rpBI.setRenderArea(renderPass.RenderArea);
             rpBI.setClearValues(renderPass.ClearValues);
 
-            mCmdBuffer.beginRenderPass(rpBI, vk::SubpassContents::eInline);
+            mCmdBuffer.beginRenderPass(rpBI, contents);
         }
+        else if (renderPass.DynamicRendering.IsEnabled())
+        {
+            const auto& rendering = renderPass.DynamicRendering;
+
+            vk::RenderingInfo renderingInfo {};
+            renderingInfo.setRenderArea(renderPass.RenderArea);
+            renderingInfo.setLayerCount(rendering.LayerCount);
+            renderingInfo.setColorAttachments(rendering.ColorAttachments);
+            if (rendering.DepthFormat != vk::Format::eUndefined) { renderingInfo.setPDepthAttachment(&rendering.DepthAttachment); }
+            if (rendering.StencilFormat != vk::Format::eUndefined) { renderingInfo.setPStencilAttachment(&rendering.StencilAttachment); }
+            if (contents == vk::SubpassContents::eSecondaryCommandBuffers) { renderingInfo.setFlags(vk::RenderingFlagBits::eContentsSecondaryCommandBuffers); }
+
+            mCmdBuffer.beginRendering(renderingInfo);
+        }
+
+        // 内容由secondary命令缓冲录制时，主命令缓冲不能再录制绑定命令
+        if (contents == vk::SubpassContents::eInline) { this->BindPassState(renderPass); }
+    }
 
+    void CommandBufferVK::NextSubpass(const NativeRenderPass &renderPass, vk::SubpassContents contents)
+    {
+        assert(renderPass.RenderPassHandle && renderPass.Subpass != 0);
+        // 子通道之间的依赖由RenderPass的SubpassDependency表达，这里不会有排队的屏障
+        assert(mbInsidePass && mBarriers.IsEmpty());
+        if (!this->IsNull()) { mCmdBuffer.nextSubpass(contents); }
+
+        // 每个子通道使用自己的管线，绑定状态需要重新录制
+        if (contents == vk::SubpassContents::eInline) { this->BindPassState(renderPass); }
+    }
+
+    void CommandBufferVK::BindPassState(const NativeRenderPass &renderPass)
+    {
         vk::Pipeline pipeline = renderPass.Pipeline;
         vk::PipelineLayout pipelineLayout = renderPass.PipelineLayout;
         vk::PipelineBindPoint pipelineType = renderPass.PipelineType;
         vk::DescriptorSet descriptorSet = renderPass.DescriptorSet;
 
-        if (pipeline) { mCmdBuffer.bindPipeline(pipelineType, pipeline); }
-        if (descriptorSet) { mCmdBuffer.bindDescriptorSets(pipelineType, pipelineLayout, 0, descriptorSet, {}); }
+        if (pipeline) { this->BindPipeline(pipelineType, pipeline); }
+        if (descriptorSet) { this->BindDescriptorSet(pipelineType, pipelineLayout, 0, descriptorSet); }
+        if (renderPass.DescriptorBufferOffset != DescriptorBufferAllocation::InvalidOffset)
+        {
+            this->SetDescriptorBufferOffset(pipelineType, pipelineLayout, 0, renderPass.DescriptorBufferOffset);
+        }
+    }
+
+    CommandBufferVK::BindPointState* CommandBufferVK::GetBindPointState(vk::PipelineBindPoint bindPoint)
+    {
+        switch (bindPoint)
+        {
+        case vk::PipelineBindPoint::eGraphics: return &mShadowState.BindPoints[0];
+        case vk::PipelineBindPoint::eCompute: return &mShadowState.BindPoints[1];
+        default: return nullptr;
+        }
+    }
+
+    void CommandBufferVK::BindLayout(BindPointState &state, vk::PipelineLayout layout)
+    {
+        // 布局变化后不再假设之前绑定的集合仍然兼容
+        if (state.Layout == layout) { return; }
+        state.Layout = layout;
+        state.Sets.fill(vk::DescriptorSet {});
+        state.DescriptorBufferOffsets.fill(DescriptorBufferAllocation::InvalidOffset);
+    }
+
+    void CommandBufferVK::BindPipeline(vk::PipelineBindPoint bindPoint, vk::Pipeline pipeline)
+    {
+        auto state = this->GetBindPointState(bindPoint);
+        if (state != nullptr)
+        {
+            if (state->Pipeline == pipeline)
+            {
+                mStats.ElidedCommands++;
+                return;
+            }
+            state->Pipeline = pipeline;
+        }
+        if (this->IsNull()) { return; }
+        mCmdBuffer.bindPipeline(bindPoint, pipeline);
+    }
+
+    void CommandBufferVK::BindDescriptorSet(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, uint32_t setIndex, vk::DescriptorSet descriptorSet)
+    {
+        auto state = this->GetBindPointState(bindPoint);
+        if (state != nullptr && setIndex < MaxDescriptorSets)
+        {
+            this->BindLayout(*state, layout);
+            if (state->Sets[setIndex] == descriptorSet)
+            {
+                mStats.ElidedCommands++;
+                return;
+            }
+            state->Sets[setIndex] = descriptorSet;
+            state->DescriptorBufferOffsets[setIndex] = DescriptorBufferAllocation::InvalidOffset;
+        }
+        if (this->IsNull()) { return; }
+        mCmdBuffer.bindDescriptorSets(bindPoint, layout, setIndex, descriptorSet, {});
+    }
+
+    void CommandBufferVK::SetDescriptorBufferOffset(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, uint32_t setIndex, uint64_t offset)
+    {
+        auto& descriptorBuffer = GetCurrentRenderer().GetDescriptorBuffer();
+        if (!mbDescriptorBufferBound && !this->IsNull())
+        {
+            descriptorBuffer.BindBuffer(mCmdBuffer);
+            mbDescriptorBufferBound = true;
+        }
+
+        auto state = this->GetBindPointState(bindPoint);
+        if (state != nullptr && setIndex < MaxDescriptorSets)
+        {
+            this->BindLayout(*state, layout);
+            if (state->DescriptorBufferOffsets[setIndex] == offset)
+            {
+                mStats.ElidedCommands++;
+                return;
+            }
+            state->DescriptorBufferOffsets[setIndex] = offset;
+            state->Sets[setIndex] = vk::DescriptorSet {};
+        }
+        if (this->IsNull()) { return; }
+        descriptorBuffer.SetOffset(mCmdBuffer, bindPoint, layout, setIndex, offset);
+    }
+
+    void CommandBufferVK::InvalidateState()
+    {
+        mShadowState = ShadowState {};
+        for (auto& state : mShadowState.BindPoints)
+        {
+            state.DescriptorBufferOffsets.fill(DescriptorBufferAllocation::InvalidOffset);
+        }
+        mbDescriptorBufferBound = false;
+    }
+
+    void CommandBufferVK::ExecuteCommands(ArrayView<const vk::CommandBuffer> secondaries, ArrayView<const CommandBufferStats> secondaryStats)
+    {
+        if (secondaries.empty()) { return; }
+
+        assert(secondaryStats.empty() || secondaryStats.size() == secondaries.size());
+        for (const auto& stats : secondaryStats) { mStats += stats; }
+
+        this->FlushBarriers();
+        if (!this->IsNull()) { mCmdBuffer.executeCommands((uint32_t)secondaries.size(), secondaries.data()); }
+        // secondary执行后主命令缓冲的绑定状态未定义
+        this->InvalidateState();
     }
 
     void CommandBufferVK::EndPass(const NativeRenderPass &renderPass)
     {
+        assert(mbInsidePass && mBarriers.IsEmpty());
+        mbInsidePass = false;
+        if (this->IsNull()) { return; }
         if (renderPass.RenderPassHandle)
         {
             mCmdBuffer.endRenderPass();
         }
+        else if (renderPass.DynamicRendering.IsEnabled())
+        {
+            mCmdBuffer.endRendering();
+        }
     }
 
     void CommandBufferVK::Draw(uint32_t vertexCount, uint32_t instanceCount)
     {
+        this->FlushBarriers();
+        mStats.DrawCalls++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.draw(vertexCount, instanceCount, 0, 0);
     }
 
     void CommandBufferVK::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
     {
+        this->FlushBarriers();
+        mStats.DrawCalls++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.draw(vertexCount, instanceCount, firstVertex, firstInstance);
     }
 
     void CommandBufferVK::DrawIndexed(uint32_t indexCount, uint32_t instanceCount)
     {
+        this->FlushBarriers();
+        mStats.DrawCalls++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.drawIndexed(indexCount, instanceCount, 0, 0, 0);
     }
 
     void CommandBufferVK::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
     {
+        this->FlushBarriers();
+        mStats.DrawCalls++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.drawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
     }
 
+    void CommandBufferVK::BindIndexBuffer(const BufferVK &indexBuffer, vk::IndexType indexType)
+    {
+        vk::Buffer buffer = indexBuffer.GetNativeBuffer();
+        if (mShadowState.IndexBuffer == buffer && mShadowState.IndexType == indexType)
+        {
+            mStats.ElidedCommands++;
+            return;
+        }
+        mShadowState.IndexBuffer = buffer;
+        mShadowState.IndexType = indexType;
+        if (this->IsNull()) { return; }
+        mCmdBuffer.bindIndexBuffer(buffer, 0, indexType);
+    }
+
     void CommandBufferVK::BindIndexBufferUInt32(const BufferVK &indexBuffer)
     {
-        mCmdBuffer.bindIndexBuffer(indexBuffer.GetNativeBuffer(), 0, vk::IndexType::eUint32);
+        this->BindIndexBuffer(indexBuffer, vk::IndexType::eUint32);
     }
 
     void CommandBufferVK::BindIndexBufferUInt16(const BufferVK &indexBuffer)
     {
-        mCmdBuffer.bindIndexBuffer(indexBuffer.GetNativeBuffer(), 0, vk::IndexType::eUint16);
+        this->BindIndexBuffer(indexBuffer, vk::IndexType::eUint16);
+    }
+
+    void CommandBufferVK::BindNativeVertexBuffers(const vk::Buffer *buffers, uint32_t bufferCount)
+    {
+        // 只重新绑定发生变化的连续区间
+        uint32_t first = 0;
+        while (first < bufferCount && mShadowState.VertexBuffers[first] == buffers[first]) { first++; }
+        if (first == bufferCount)
+        {
+            mStats.ElidedCommands++;
+            return;
+        }
+
+        uint32_t last = bufferCount;
+        while (last > first && mShadowState.VertexBuffers[last - 1] == buffers[last - 1]) { last--; }
+
+        std::array<vk::DeviceSize, MaxVertexBuffers> offsets {};
+        std::copy(buffers + first, buffers + last, mShadowState.VertexBuffers.begin() + first);
+        if (this->IsNull()) { return; }
+        mCmdBuffer.bindVertexBuffers(first, last - first, buffers + first, offsets.data());
     }
 
     void CommandBufferVK::SetViewport(const Viewport &viewport)
@@ -101,6 +375,15 @@ namespace RHI::Vulkan
         vp.setHeight(-viewport.Height);
         vp.setMinDepth(viewport.MinDepth);
         vp.setMaxDepth(viewport.MaxDepth);
+
+        // 所有管线都把视口和裁剪矩形声明为动态状态，切换管线不会使其失效
+        if (mShadowState.Viewport == vp)
+        {
+            mStats.ElidedCommands++;
+            return;
+        }
+        mShadowState.Viewport = vp;
+        if (this->IsNull()) { return; }
         mCmdBuffer.setViewport(0, vp);
     }
 
@@ -109,6 +392,14 @@ namespace RHI::Vulkan
         vk::Rect2D rect {};
         rect.setOffset({ scissor.OffsetWidth, scissor.OffSetHeight });
         rect.setExtent({ scissor.Width, scissor.Height });
+
+        if (mShadowState.Scissor == rect)
+        {
+            mStats.ElidedCommands++;
+            return;
+        }
+        mShadowState.Scissor = rect;
+        if (this->IsNull()) { return; }
         mCmdBuffer.setScissor(0, rect);
     }
 
@@ -124,57 +415,94 @@ namespace RHI::Vulkan
         std::array<uint8_t, maxPushConstantByteSize> pushConstants {};
 
         std::memcpy(pushConstants.data(), data, size);
+        if (this->IsNull()) { return; }
 
         mCmdBuffer.pushConstants(renderPass.PipelineLayout, PipelineTypeToShaderStages(renderPass.PipelineType), 0, size, pushConstants.data());
     }
 
+    void CommandBufferVK::PushConstants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, const uint8_t *data, size_t size)
+    {
+        if (this->IsNull()) { return; }
+        mCmdBuffer.pushConstants(layout, stages, 0, (uint32_t)size, data);
+    }
+
     void CommandBufferVK::Dispatch(uint32_t x, uint32_t y, uint32_t z)
     {
+        this->FlushBarriers();
+        mStats.Dispatches++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.dispatch(x, y, z);
     }
 
-    void CommandBufferVK::CopyImage(const ImageInfo &src, const ImageInfo &dst)
+    void CommandBufferVK::DrawIndirect(const BufferVK &buffer, size_t offset, uint32_t drawCount, uint32_t stride)
     {
-        auto srcRange = GetDefaultImageSubresourceRange(src.Resource.get());
-        auto dstRange = GetDefaultImageSubresourceRange(dst.Resource.get());
-
-        std::array<vk::ImageMemoryBarrier, 2> barriers {};
-        size_t barrierCount = 0;
-
-        vk::ImageMemoryBarrier toSrcBarrier {};
-        toSrcBarrier.setSrcAccessMask(ImageUsageToAccessFlags(src.Usage));
-        toSrcBarrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
-        toSrcBarrier.setOldLayout(ImageUsageToImageLayout(src.Usage));
-        toSrcBarrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
-        toSrcBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toSrcBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toSrcBarrier.setImage(src.Resource.get().GetNativeImage());
-        toSrcBarrier.setSubresourceRange(srcRange);
-
-        vk::ImageMemoryBarrier toDstBarrier {};
-        toDstBarrier.setSrcAccessMask(ImageUsageToAccessFlags(dst.Usage));
-        toDstBarrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
-        toDstBarrier.setOldLayout(ImageUsageToImageLayout(dst.Usage));
-        toDstBarrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
-        toDstBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toDstBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toDstBarrier.setImage(dst.Resource.get().GetNativeImage());
-        toDstBarrier.setSubresourceRange(dstRange);
-
-        if (src.Usage != ImageUsage::TRANSFER_SOURCE) { barriers[barrierCount++] = toSrcBarrier; }
-        if (dst.Usage != ImageUsage::TRANSFER_DESTINATION) { barriers[barrierCount++] = toDstBarrier; }
-
-        if (barrierCount > 0)
+        if (drawCount == 0) { return; }
+        assert(buffer.GetSize() >= offset + size_t(drawCount - 1) * stride + sizeof(vk::DrawIndirectCommand));
+
+        assert(buffer.GetCurrentUsage() == BufferUsage::INDIRECT_BUFFER);
+        this->FlushBarriers();
+        mStats.DrawCalls++;
+        if (this->IsNull()) { return; }
+        if (drawCount > 1 && !GetCurrentRenderer().GetEnabledFeatures().multiDrawIndirect)
         {
-            mCmdBuffer.pipelineBarrier(
-                ImageUsageToPipelineStage(src.Usage) | ImageUsageToPipelineStage(dst.Usage),
-                vk::PipelineStageFlagBits::eTransfer,
-                vk::DependencyFlags {},
-                {},
-                {},
-                barriers
-            );
+            // 不支持multiDrawIndirect时drawCount只能为0或1，逐个命令提交
+            for (uint32_t i = 0; i < drawCount; i++) { mCmdBuffer.drawIndirect(buffer.GetNativeBuffer(), offset + size_t(i) * stride, 1, stride); }
+            return;
         }
+        mCmdBuffer.drawIndirect(buffer.GetNativeBuffer(), offset, drawCount, stride);
+    }
+
+    void CommandBufferVK::DrawIndexedIndirect(const BufferVK &buffer, size_t offset, uint32_t drawCount, uint32_t stride)
+    {
+        if (drawCount == 0) { return; }
+        assert(buffer.GetSize() >= offset + size_t(drawCount - 1) * stride + sizeof(vk::DrawIndexedIndirectCommand));
+
+        assert(buffer.GetCurrentUsage() == BufferUsage::INDIRECT_BUFFER);
+        this->FlushBarriers();
+        mStats.DrawCalls++;
+        if (this->IsNull()) { return; }
+        if (drawCount > 1 && !GetCurrentRenderer().GetEnabledFeatures().multiDrawIndirect)
+        {
+            for (uint32_t i = 0; i < drawCount; i++) { mCmdBuffer.drawIndexedIndirect(buffer.GetNativeBuffer(), offset + size_t(i) * stride, 1, stride); }
+            return;
+        }
+        mCmdBuffer.drawIndexedIndirect(buffer.GetNativeBuffer(), offset, drawCount, stride);
+    }
+
+    void CommandBufferVK::DrawIndexedIndirectCount(const BufferVK &buffer, size_t offset, const BufferVK &countBuffer, size_t countOffset, uint32_t maxDrawCount, uint32_t stride)
+    {
+        if (maxDrawCount == 0) { return; }
+        assert(countBuffer.GetSize() >= countOffset + sizeof(uint32_t));
+        // 绘制数量只在GPU上可见，没有逐个提交的回退，调用前需要检查IsDrawIndirectCountEnabled
+        bool bEnabled = this->IsNull() || GetCurrentRenderer().IsDrawIndirectCountEnabled();
+        assert(bEnabled);
+        if (!bEnabled) { return; }
+
+        assert(buffer.GetCurrentUsage() == BufferUsage::INDIRECT_BUFFER);
+        assert(countBuffer.GetCurrentUsage() == BufferUsage::INDIRECT_BUFFER);
+        this->FlushBarriers();
+        mStats.DrawCalls++;
+        if (this->IsNull()) { return; }
+        mCmdBuffer.drawIndexedIndirectCount(buffer.GetNativeBuffer(), offset, countBuffer.GetNativeBuffer(), countOffset, maxDrawCount, stride);
+    }
+
+    void CommandBufferVK::DispatchIndirect(const BufferVK &buffer, size_t offset)
+    {
+        assert(buffer.GetSize() >= offset + sizeof(vk::DispatchIndirectCommand));
+
+        assert(buffer.GetCurrentUsage() == BufferUsage::INDIRECT_BUFFER);
+        this->FlushBarriers();
+        mStats.Dispatches++;
+        if (this->IsNull()) { return; }
+        mCmdBuffer.dispatchIndirect(buffer.GetNativeBuffer(), offset);
+    }
+
+    void CommandBufferVK::CopyImage(const ImageInfo &src, const ImageInfo &dst)
+    {
+        this->TransitionImage(src.Resource.get(), ImageUsage::TRANSFER_SOURCE, src.MipLevel, 1, src.Layer, 1);
+        this->TransitionImage(dst.Resource.get(), ImageUsage::TRANSFER_DESTINATION, dst.MipLevel, 1, dst.Layer, 1);
+        this->FlushBarriers();
+
         auto srcLayers = GetDefaultImageSubresourceLayers(src.Resource.get(), src.MipLevel, src.Layer);
         auto dstLayers = GetDefaultImageSubresourceLayers(dst.Resource.get(), dst.MipLevel, dst.Layer);
 
@@ -185,6 +513,8 @@ namespace RHI::Vulkan
         copyInfo.setDstOffset(0);
         copyInfo.setExtent(vk::Extent3D(dst.Resource.get().GetMipLevelWidth(dst.MipLevel), dst.Resource.get().GetMipLevelHeight(dst.MipLevel), 1));
 
+        mStats.Copies++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.copyImage(
             src.Resource.get().GetNativeImage(),
             vk::ImageLayout::eTransferSrcOptimal,
@@ -204,34 +534,20 @@ namespace RHI::Vulkan
         bufferCopyInfo.setDstOffset(dst.Offset);
         bufferCopyInfo.setSize(byteSize);
 
+        this->TransitionBuffer(src.Resource.get(), BufferUsage::TRANSFER_SOURCE);
+        this->TransitionBuffer(dst.Resource.get(), BufferUsage::TRANSFER_DESTINATION);
+        this->FlushBarriers();
+        mStats.Copies++;
+        mStats.CopiedBufferBytes += byteSize;
+        if (this->IsNull()) { return; }
         mCmdBuffer.copyBuffer(src.Resource.get().GetNativeBuffer(), dst.Resource.get().GetNativeBuffer(), bufferCopyInfo);
     }
 
     void CommandBufferVK::CopyBufferToImage(const BufferInfo &src, const ImageInfo &dst)
     {
-        if (dst.Usage != ImageUsage::TRANSFER_DESTINATION)
-        {
-            auto dstRange = GetDefaultImageSubresourceRange(dst.Resource.get());
-
-            vk::ImageMemoryBarrier toDstBarrier {};
-            toDstBarrier.setSrcAccessMask(ImageUsageToAccessFlags(dst.Usage));
-            toDstBarrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
-            toDstBarrier.setOldLayout(ImageUsageToImageLayout(dst.Usage));
-            toDstBarrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
-            toDstBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-            toDstBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-            toDstBarrier.setImage(dst.Resource.get().GetNativeImage());
-            toDstBarrier.setSubresourceRange(dstRange);
-
-            mCmdBuffer.pipelineBarrier(
-                ImageUsageToPipelineStage(dst.Usage),
-                vk::PipelineStageFlagBits::eTransfer,
-                vk::DependencyFlags {},
-                {},
-                {},
-                toDstBarrier
-            );
-        }
+        this->TransitionBuffer(src.Resource.get(), BufferUsage::TRANSFER_SOURCE);
+        this->TransitionImage(dst.Resource.get(), ImageUsage::TRANSFER_DESTINATION, dst.MipLevel, 1, dst.Layer, 1);
+        this->FlushBarriers();
 
         auto dstLayers = GetDefaultImageSubresourceLayers(dst.Resource.get(), dst.MipLevel, dst.Layer);
 
@@ -243,34 +559,16 @@ namespace RHI::Vulkan
         bufferImageCopyInfo.setImageOffset({ 0, 0, 0 });
         bufferImageCopyInfo.setImageExtent({ dst.Resource.get().GetMipLevelWidth(dst.MipLevel), dst.Resource.get().GetMipLevelHeight(dst.MipLevel), 1 });
 
+        mStats.Copies++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.copyBufferToImage(src.Resource.get().GetNativeBuffer(), dst.Resource.get().GetNativeImage(), vk::ImageLayout::eTransferDstOptimal, bufferImageCopyInfo);
     }
 
     void CommandBufferVK::CopyImageToBuffer(const ImageInfo &src, const BufferInfo &dst)
     {
-        if (src.Usage != ImageUsage::TRANSFER_SOURCE)
-        {
-            auto srcRange = GetDefaultImageSubresourceRange(src.Resource.get());
-
-            vk::ImageMemoryBarrier toSrcBarrier {};
-            toSrcBarrier.setSrcAccessMask(ImageUsageToAccessFlags(src.Usage));
-            toSrcBarrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
-            toSrcBarrier.setOldLayout(ImageUsageToImageLayout(src.Usage));
-            toSrcBarrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
-            toSrcBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-            toSrcBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-            toSrcBarrier.setImage(src.Resource.get().GetNativeImage());
-            toSrcBarrier.setSubresourceRange(srcRange);
-
-            mCmdBuffer.pipelineBarrier(
-                ImageUsageToPipelineStage(src.Usage),
-                vk::PipelineStageFlagBits::eTransfer,
-                vk::DependencyFlags {},
-                {},
-                {},
-                toSrcBarrier
-            );
-        }
+        this->TransitionImage(src.Resource.get(), ImageUsage::TRANSFER_SOURCE, src.MipLevel, 1, src.Layer, 1);
+        this->TransitionBuffer(dst.Resource.get(), BufferUsage::TRANSFER_DESTINATION);
+        this->FlushBarriers();
 
         auto srcLayers = GetDefaultImageSubresourceLayers(src.Resource.get(), src.MipLevel, src.Layer);
 
@@ -282,51 +580,26 @@ namespace RHI::Vulkan
         bufferImageCopyInfo.setImageOffset({ 0, 0, 0 });
         bufferImageCopyInfo.setImageExtent({ src.Resource.get().GetMipLevelWidth(src.MipLevel), src.Resource.get().GetMipLevelHeight(src.MipLevel), 1 });
 
+        mStats.Copies++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.copyImageToBuffer(src.Resource.get().GetNativeImage(), vk::ImageLayout::eTransferSrcOptimal, dst.Resource.get().GetNativeBuffer(), bufferImageCopyInfo);
     }
 
-    void CommandBufferVK::BlitImage(const ImageVK &src, ImageUsage::Bits srcUsage, const ImageVK &dst, ImageUsage::Bits dstUsage, BlitFilter filter)
+    void CommandBufferVK::FillBuffer(const BufferVK &buffer, uint32_t value)
     {
-        auto srcRange = GetDefaultImageSubresourceRange(src);
-        auto dstRange = GetDefaultImageSubresourceRange(dst);
-
-        std::array<vk::ImageMemoryBarrier, 2> barriers {};
-        size_t barrierCount = 0;
-
-        vk::ImageMemoryBarrier toSrcBarrier {};
-        toSrcBarrier.setSrcAccessMask(ImageUsageToAccessFlags(srcUsage));
-        toSrcBarrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
-        toSrcBarrier.setOldLayout(ImageUsageToImageLayout(srcUsage));
-        toSrcBarrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
-        toSrcBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toSrcBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toSrcBarrier.setImage(src.GetNativeImage());
-        toSrcBarrier.setSubresourceRange(srcRange);
-
-        vk::ImageMemoryBarrier toDstBarrier {};
-        toDstBarrier.setSrcAccessMask(ImageUsageToAccessFlags(dstUsage));
-        toDstBarrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
-        toDstBarrier.setOldLayout(ImageUsageToImageLayout(dstUsage));
-        toDstBarrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
-        toDstBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toDstBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        toDstBarrier.setImage(dst.GetNativeImage());
-        toDstBarrier.setSubresourceRange(dstRange);
-
-        if (srcUsage != ImageUsage::TRANSFER_SOURCE) { barriers[barrierCount++] = toSrcBarrier; }
-        if (dstUsage != ImageUsage::TRANSFER_DESTINATION) { barriers[barrierCount++] = toDstBarrier; }
+        this->TransitionBuffer(buffer, BufferUsage::TRANSFER_DESTINATION);
+        this->FlushBarriers();
+        mStats.Copies++;
+        if (this->IsNull()) { return; }
+        mCmdBuffer.fillBuffer(buffer.GetNativeBuffer(), 0, VK_WHOLE_SIZE, value);
+    }
 
-        if (barrierCount > 0)
-        {
-            mCmdBuffer.pipelineBarrier(
-                ImageUsageToPipelineStage(srcUsage) | ImageUsageToPipelineStage(dstUsage),
-                vk::PipelineStageFlagBits::eTransfer,
-                vk::DependencyFlags {},
-                {},
-                {},
-                barriers
-            );
-        }
+    void CommandBufferVK::BlitImage(const ImageVK &src, const ImageVK &dst, BlitFilter filter)
+    {
+        // 只读写mip 0，其余mip保持原有用途
+        this->TransitionImage(src, ImageUsage::TRANSFER_SOURCE, 0, 1);
+        this->TransitionImage(dst, ImageUsage::TRANSFER_DESTINATION, 0, 1);
+        this->FlushBarriers();
 
         auto srcLayers = GetDefaultImageSubresourceLayers(src);
         auto dstLayers = GetDefaultImageSubresourceLayers(dst);
@@ -343,6 +616,8 @@ namespace RHI::Vulkan
             vk::Offset3D((int32_t)dst.GetWidth(), (int32_t)dst.GetHeight(), 1)
         );
 
+        mStats.Copies++;
+        if (this->IsNull()) { return; }
         mCmdBuffer.blitImage(
             src.GetNativeImage(),
             vk::ImageLayout::eTransferSrcOptimal,
@@ -353,23 +628,19 @@ namespace RHI::Vulkan
         );
     }
 
-    void CommandBufferVK::GenerateMipLevels(const ImageVK &image, ImageUsage::Bits initialUsage, BlitFilter filter)
+    void CommandBufferVK::GenerateMipLevels(const ImageVK &image, BlitFilter filter)
     {
         if (image.GetMipLevelCount() < 2) { return; }
 
-        auto srcRange = GetDefaultImageSubresourceRange(image);
-        auto dstRange = GetDefaultImageSubresourceRange(image);
         auto srcLayer = GetDefaultImageSubresourceLayers(image);
         auto dstLayer = GetDefaultImageSubresourceLayers(image);
-        
-        auto srcUsage = initialUsage;
 
         uint32_t srcWidth = image.GetWidth();
         uint32_t srcHeight = image.GetHeight();
         uint32_t dstWidth = image.GetWidth();
         uint32_t dstHeight = image.GetHeight();
 
-        for (size_t i = 0; i + 1 < image.GetMipLevelCount(); i++)
+        for (uint32_t i = 0; i + 1 < image.GetMipLevelCount(); i++)
         {
             srcWidth = dstWidth;
             srcHeight = dstHeight;
@@ -377,43 +648,11 @@ namespace RHI::Vulkan
             dstHeight = std::max(1u, srcHeight / 2);
 
             srcLayer.setMipLevel(i);
-            srcRange.setBaseMipLevel(i);
-            srcRange.setLevelCount(1);
-
             dstLayer.setMipLevel(i + 1);
-            dstRange.setBaseMipLevel(i + 1);
-            dstRange.setLevelCount(1);
-
-            std::array<vk::ImageMemoryBarrier, 2> barriers {};
-            barriers[0] // to transfer source
-                .setSrcAccessMask(ImageUsageToAccessFlags(srcUsage))
-                .setDstAccessMask(ImageUsageToAccessFlags(ImageUsage::TRANSFER_SOURCE))
-                .setOldLayout(ImageUsageToImageLayout(srcUsage))
-                .setNewLayout(ImageUsageToImageLayout(ImageUsage::TRANSFER_SOURCE))
-                .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
-                .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
-                .setImage(image.GetNativeImage())
-                .setSubresourceRange(srcUsage);
-
-            barriers[1] // to transfer distance
-                .setSrcAccessMask(ImageUsageToAccessFlags(ImageUsage::UNKNOWN))
-                .setDstAccessMask(ImageUsageToAccessFlags(ImageUsage::TRANSFER_DESTINATION))
-                .setOldLayout(ImageUsageToImageLayout(ImageUsage::UNKNOWN))
-                .setNewLayout(ImageUsageToImageLayout(ImageUsage::TRANSFER_DESTINATION))
-                .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
-                .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
-                .setImage(image.GetNativeImage())
-                .setSubresourceRange(dstRange);
-
-            mCmdBuffer.pipelineBarrier(
-                vk::PipelineStageFlagBits::eTransfer,
-                vk::PipelineStageFlagBits::eTransfer,
-                {},
-                {},
-                {},
-                barriers
-            );
-            srcUsage = ImageUsage::TRANSFER_DESTINATION;
+
+            this->TransitionImage(image, ImageUsage::TRANSFER_SOURCE, i, 1);
+            this->TransitionImage(image, ImageUsage::TRANSFER_DESTINATION, i + 1, 1);
+            this->FlushBarriers();
 
             vk::ImageBlit blitInfo {};
             blitInfo.setSrcSubresource(srcLayer);
@@ -427,6 +666,8 @@ namespace RHI::Vulkan
                 vk::Offset3D((int32_t)dstWidth, (int32_t)dstHeight, 1)
             );
 
+            mStats.Copies++;
+            if (this->IsNull()) { continue; }
             mCmdBuffer.blitImage(
                 image.GetNativeImage(),
                 vk::ImageLayout::eTransferSrcOptimal,
@@ -436,78 +677,203 @@ namespace RHI::Vulkan
                 BlitFilterToNative(filter)
             );
         }
+        // 结束时mip 0..n-2为TRANSFER_SOURCE，最后一级为TRANSFER_DESTINATION，后续转换由跟踪状态计算
+    }
 
-        auto mipLevelSubRange = GetDefaultImageSubresourceRange(image);
-        mipLevelSubRange.setLevelCount(mipLevelSubRange.levelCount - 1);
-        vk::ImageMemoryBarrier mipTransferBarrier {};
-        mipTransferBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferRead);
-        mipTransferBarrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
-        mipTransferBarrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
-        mipTransferBarrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
-        mipTransferBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        mipTransferBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
-        mipTransferBarrier.setImage(image.GetNativeImage());
-        mipTransferBarrier.setSubresourceRange(mipLevelSubRange);
-
-        mCmdBuffer.pipelineBarrier(
-            vk::PipelineStageFlagBits::eTransfer,
-            vk::PipelineStageFlagBits::eTransfer,
-            {},
-            {},
-            {},
-            mipTransferBarrier
-        );
+    void CommandBufferVK::TransitionImage(const ImageVK &image, ImageUsage::Bits newUsage)
+    {
+        this->TransitionImage(image, newUsage, 0, image.GetMipLevelCount(), 0, image.GetLayerCount());
     }
 
-    void CommandBufferVK::TransferLayout(const ImageVK &image, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout)
+    void CommandBufferVK::TransitionImage(const ImageVK &image, ImageUsage::Bits newUsage, uint32_t baseMipLevel, uint32_t mipLevelCount, uint32_t baseLayer, uint32_t layerCount)
     {
-        auto barrier = GetImageMemoryBarrier(image, oldLayout, newLayout);
+        // 资源上的使用状态被所有录制线程共享，只能在主线程录制的主命令缓冲上修改
+        assert(!mbSecondary);
+        if (mipLevelCount == VK_REMAINING_MIP_LEVELS) { mipLevelCount = image.GetMipLevelCount() - baseMipLevel; }
+        if (layerCount == VK_REMAINING_ARRAY_LAYERS) { layerCount = image.GetLayerCount() - baseLayer; }
 
-        mCmdBuffer.pipelineBarrier(
-            ImageUsageToPipelineStage(oldLayout),
-            ImageUsageToPipelineStage(newLayout),
-            vk::DependencyFlags {},
-            {},
-            {},
-            barrier
-        );
+        this->CollectTransitionRanges(image, newUsage, baseMipLevel, mipLevelCount, baseLayer, layerCount, true);
+        for (const auto& range : mTransitionRanges)
+        {
+            this->QueueImageBarrier(GetImageMemoryBarrier(image, range.Range, range.OldUsage, newUsage));
+        }
+        image.SetSubresourceUsage(newUsage, baseMipLevel, mipLevelCount, baseLayer, layerCount);
     }
 
-    void CommandBufferVK::TransferLayout(ArrayView<ImageVKReference> images, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout)
+    void CommandBufferVK::CollectTransitionRanges(const ImageVK &image, ImageUsage::Bits newUsage, uint32_t baseMipLevel, uint32_t mipLevelCount, uint32_t baseLayer, uint32_t layerCount, bool skipUnchanged)
     {
-        std::vector<vk::ImageMemoryBarrier> barriers {};
-        barriers.reserve(images.size());
+        auto aspect = ImageFormatToImageAspect(image.GetFormat());
+        bool needsDependency = HasImageWriteDependency(newUsage);
 
-        for (const auto& image : images)
+        // 逐layer找出旧用途相同的连续mip区间，与上一layer中完全相同的区间合并成矩形
+        mTransitionRanges.clear();
+        for (uint32_t layer = baseLayer; layer < baseLayer + layerCount; layer++)
         {
-            barriers.push_back(GetImageMemoryBarrier(image.get(), oldLayout, newLayout));
+            uint32_t mip = baseMipLevel;
+            while (mip < baseMipLevel + mipLevelCount)
+            {
+                auto oldUsage = image.GetSubresourceUsage(mip, layer);
+                uint32_t runEnd = mip + 1;
+                while (runEnd < baseMipLevel + mipLevelCount && image.GetSubresourceUsage(runEnd, layer) == oldUsage) { runEnd++; }
+
+                if (skipUnchanged && oldUsage == newUsage && !needsDependency)
+                {
+                    mStats.SkippedTransitions++;
+                    mip = runEnd;
+                    continue;
+                }
+
+                auto previous = std::find_if(mTransitionRanges.begin(), mTransitionRanges.end(),
+                    [&](const TransitionRange& range)
+                    {
+                        return range.OldUsage == oldUsage &&
+                            range.Range.baseMipLevel == mip &&
+                            range.Range.levelCount == runEnd - mip &&
+                            range.Range.baseArrayLayer + range.Range.layerCount == layer;
+                    });
+
+                if (previous != mTransitionRanges.end())
+                {
+                    previous->Range.layerCount++;
+                }
+                else
+                {
+                    mTransitionRanges.push_back(TransitionRange{ vk::ImageSubresourceRange{ aspect, mip, runEnd - mip, layer, 1 }, oldUsage });
+                }
+                mip = runEnd;
+            }
         }
-        mCmdBuffer.pipelineBarrier(
-            ImageUsageToPipelineStage(oldLayout),
-            ImageUsageToPipelineStage(newLayout),
-            vk::DependencyFlags {},
-            {},
-            {},
-            barriers
-        );
     }
 
-    void CommandBufferVK::TransferLayout(ArrayView<ImageVK> images, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout)
+    void CommandBufferVK::TransitionImage(ArrayView<ImageVKReference> images, ImageUsage::Bits newUsage)
     {
-        std::vector<vk::ImageMemoryBarrier> barriers {};
-        barriers.reserve(images.size());
+        for (const auto& image : images)
+        {
+            this->TransitionImage(image.get(), newUsage);
+        }
+    }
 
+    void CommandBufferVK::TransitionImage(ArrayView<ImageVK> images, ImageUsage::Bits newUsage)
+    {
         for (const auto& image : images)
         {
-            barriers.push_back(GetImageMemoryBarrier(image, oldLayout, newLayout));
+            this->TransitionImage(image, newUsage);
         }
-        mCmdBuffer.pipelineBarrier(
-            ImageUsageToPipelineStage(oldLayout),
-            ImageUsageToPipelineStage(newLayout),
-            vk::DependencyFlags {},
-            {},
-            {},
-            barriers
-        );
+    }
+
+    void CommandBufferVK::TransitionBuffer(const BufferVK &buffer, BufferUsage::Bits newUsage)
+    {
+        assert(!mbSecondary);
+        auto oldUsage = buffer.GetCurrentUsage();
+        buffer.SetCurrentUsage(newUsage);
+
+        // 首次使用时主机写入在提交时已经可见，读后读也不需要屏障
+        if (oldUsage == BufferUsage::UNKNOWN || (oldUsage == newUsage && !HasBufferWriteDependency(newUsage)))
+        {
+            mStats.SkippedTransitions++;
+            return;
+        }
+
+        vk::BufferMemoryBarrier2 barrier {};
+        barrier.setSrcStageMask(BufferUsageToPipelineStage(oldUsage));
+        barrier.setDstStageMask(BufferUsageToPipelineStage(newUsage));
+        barrier.setSrcAccessMask(BufferUsageToAccessFlags(oldUsage));
+        barrier.setDstAccessMask(BufferUsageToAccessFlags(newUsage));
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setBuffer(buffer.GetNativeBuffer());
+        barrier.setOffset(0);
+        barrier.setSize(VK_WHOLE_SIZE);
+
+        this->QueueBufferBarrier(barrier);
+    }
+
+    void CommandBufferVK::AliasImage(ArrayView<ImageVKReference> previous, const ImageVK &image, ImageUsage::Bits newUsage)
+    {
+        assert(!mbSecondary);
+        vk::PipelineStageFlags2 srcStages {};
+        vk::AccessFlags2 srcAccess {};
+        // 之前的图像可能逐mip处于不同用途，所有子资源的访问都需要在新图像写入前完成
+        for (const auto& aliased : previous)
+        {
+            const auto& previousImage = aliased.get();
+            for (uint32_t layer = 0; layer < previousImage.GetLayerCount(); layer++)
+            {
+                for (uint32_t mip = 0; mip < previousImage.GetMipLevelCount(); mip++)
+                {
+                    auto usage = previousImage.GetSubresourceUsage(mip, layer);
+                    srcStages |= ImageUsageToPipelineStage(usage);
+                    srcAccess |= ImageUsageToAccessFlags(usage);
+                }
+            }
+        }
+
+        // 旧布局为UNDEFINED，内存中的内容对新图像没有意义
+        auto barrier = GetImageMemoryBarrier(image, GetDefaultImageSubresourceRange(image), ImageUsage::UNKNOWN, newUsage);
+        barrier.setSrcStageMask(srcStages ? srcStages : vk::PipelineStageFlagBits2::eNone);
+        barrier.setSrcAccessMask(srcAccess);
+        this->QueueImageBarrier(barrier);
+        image.ResetSubresourceUsage(newUsage);
+    }
+
+    void CommandBufferVK::ReleaseImage(const ImageVK &image, ImageUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+    {
+        // 所有子资源都要转移所有权，旧布局相同的区间各用一个屏障，AcquireImage按相同的区间划分
+        this->CollectTransitionRanges(image, newUsage, 0, image.GetMipLevelCount(), 0, image.GetLayerCount(), false);
+        for (const auto& range : mTransitionRanges)
+        {
+            auto barrier = GetImageMemoryBarrier(image, range.Range, range.OldUsage, newUsage);
+            barrier.setDstStageMask(vk::PipelineStageFlagBits2::eNone);
+            barrier.setDstAccessMask({ });
+            barrier.setSrcQueueFamilyIndex(srcQueueFamily);
+            barrier.setDstQueueFamilyIndex(dstQueueFamily);
+            this->QueueImageBarrier(barrier);
+        }
+    }
+
+    void CommandBufferVK::AcquireImage(const ImageVK &image, ImageUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+    {
+        assert(!mbSecondary);
+        this->CollectTransitionRanges(image, newUsage, 0, image.GetMipLevelCount(), 0, image.GetLayerCount(), false);
+        for (const auto& range : mTransitionRanges)
+        {
+            auto barrier = GetImageMemoryBarrier(image, range.Range, range.OldUsage, newUsage);
+            barrier.setSrcStageMask(vk::PipelineStageFlagBits2::eNone);
+            barrier.setSrcAccessMask({ });
+            barrier.setSrcQueueFamilyIndex(srcQueueFamily);
+            barrier.setDstQueueFamilyIndex(dstQueueFamily);
+            this->QueueImageBarrier(barrier);
+        }
+        image.ResetSubresourceUsage(newUsage);
+    }
+
+    void CommandBufferVK::ReleaseBuffer(const BufferVK &buffer, BufferUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+    {
+        auto oldUsage = buffer.GetCurrentUsage();
+
+        vk::BufferMemoryBarrier2 barrier {};
+        barrier.setSrcStageMask(BufferUsageToPipelineStage(oldUsage));
+        barrier.setSrcAccessMask(BufferUsageToAccessFlags(oldUsage));
+        barrier.setSrcQueueFamilyIndex(srcQueueFamily);
+        barrier.setDstQueueFamilyIndex(dstQueueFamily);
+        barrier.setBuffer(buffer.GetNativeBuffer());
+        barrier.setOffset(0);
+        barrier.setSize(VK_WHOLE_SIZE);
+        this->QueueBufferBarrier(barrier);
+    }
+
+    void CommandBufferVK::AcquireBuffer(const BufferVK &buffer, BufferUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+    {
+        assert(!mbSecondary);
+        vk::BufferMemoryBarrier2 barrier {};
+        barrier.setDstStageMask(BufferUsageToPipelineStage(newUsage));
+        barrier.setDstAccessMask(BufferUsageToAccessFlags(newUsage));
+        barrier.setSrcQueueFamilyIndex(srcQueueFamily);
+        barrier.setDstQueueFamilyIndex(dstQueueFamily);
+        barrier.setBuffer(buffer.GetNativeBuffer());
+        barrier.setOffset(0);
+        barrier.setSize(VK_WHOLE_SIZE);
+        this->QueueBufferBarrier(barrier);
+        buffer.SetCurrentUsage(newUsage);
     }
 }
\ No newline at end of file
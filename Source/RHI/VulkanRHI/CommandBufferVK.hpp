@@ -6,6 +6,9 @@
 #include "BufferVK.hpp"
 #include "ImageVK.hpp"
 #include "RenderPassVK.hpp"
+#include "BarrierBatchVK.hpp"
+
+#include <optional>
 
 namespace RHI::Vulkan
 {
@@ -14,7 +17,6 @@ namespace RHI::Vulkan
     struct ImageInfo
     {
         ImageVKReference Resource;
-        ImageUsage::Bits Usage = ImageUsage::UNKNOWN;
         uint32_t MipLevel = 0;
         uint32_t Layer = 0;
     };
@@ -32,9 +34,25 @@ namespace RHI::Vulkan
             : mCmdBuffer(std::move(cmdBuffer)) {}
         
         const vk::CommandBuffer& GetNativeCmdBuffer() const { return mCmdBuffer; }
+        // 空后端使用空句柄，所有命令只做状态跟踪和统计
+        bool IsNull() const { return !mCmdBuffer; }
         void Begin();
+        // secondary命令缓冲，在render pass内使用时inheritance需要指定renderPass和framebuffer
+        void Begin(const vk::CommandBufferInheritanceInfo& inheritance);
         void End();
-        void BeginPass(const NativeRenderPass& renderPass);
+        void BeginPass(const NativeRenderPass& renderPass, vk::SubpassContents contents = vk::SubpassContents::eInline);
+        // 进入renderPass.Subpass指定的下一个子通道，只用于带vk::RenderPass的通道
+        void NextSubpass(const NativeRenderPass& renderPass, vk::SubpassContents contents = vk::SubpassContents::eInline);
+        // 绑定pass的管线和描述符，secondary命令缓冲开始录制时调用
+        void BindPassState(const NativeRenderPass& renderPass);
+        // secondaryStats不为空时与secondaries一一对应，累加到本命令缓冲的统计
+        void ExecuteCommands(ArrayView<const vk::CommandBuffer> secondaries, ArrayView<const CommandBufferStats> secondaryStats = {});
+        // 与影子状态相同的绑定和动态状态会被跳过
+        void BindPipeline(vk::PipelineBindPoint bindPoint, vk::Pipeline pipeline);
+        void BindDescriptorSet(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, uint32_t setIndex, vk::DescriptorSet descriptorSet);
+        void SetDescriptorBufferOffset(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, uint32_t setIndex, uint64_t offset);
+        // 绕过CommandBufferVK直接录制绑定命令后需要调用
+        void InvalidateState();
         void EndPass(const NativeRenderPass& renderPass);
         void Draw(uint32_t vertexCount, uint32_t instanceCount);
         void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
@@ -47,27 +65,59 @@ namespace RHI::Vulkan
         void SetRenderArea(const ImageVK& image);
 
         void PushConstants(const NativeRenderPass& renderPass, const uint8_t* data, size_t size);
+        void PushConstants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, const uint8_t* data, size_t size);
         void Dispatch(uint32_t x, uint32_t y, uint32_t z);
+
+        // 间接参数缓冲需要调用方在BeginPass之前转换到INDIRECT_BUFFER（IndirectDrawListVK::Upload或RenderGraph中的缓冲声明），
+        // 这里只检查当前用途，因此也可以在并行录制的secondary命令缓冲中调用
+        void DrawIndirect(const BufferVK& buffer, size_t offset, uint32_t drawCount, uint32_t stride = sizeof(vk::DrawIndirectCommand));
+        void DrawIndexedIndirect(const BufferVK& buffer, size_t offset, uint32_t drawCount, uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand));
+        // 实际绘制数量从countBuffer读取，不超过maxDrawCount，需要设备启用drawIndirectCount
+        void DrawIndexedIndirectCount(const BufferVK& buffer, size_t offset, const BufferVK& countBuffer, size_t countOffset,
+            uint32_t maxDrawCount, uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand));
+        void DispatchIndirect(const BufferVK& buffer, size_t offset);
         
         void CopyImage(const ImageInfo& src, const ImageInfo& dst);
         void CopyBuffer(const BufferInfo& src, const BufferInfo& dst, size_t byteSize);
         void CopyBufferToImage(const BufferInfo& src, const ImageInfo& dst);
         void CopyImageToBuffer(const ImageInfo& src, const BufferInfo& dst);
+        // 整个缓冲填充为value，缓冲会转换到TRANSFER_DESTINATION
+        void FillBuffer(const BufferVK& buffer, uint32_t value);
         
-        void BlitImage(const ImageVK& src, ImageUsage::Bits srcUsage, const ImageVK& dst, ImageUsage::Bits dstUsage, BlitFilter filter);
-        void GenerateMipLevels(const ImageVK& image, ImageUsage::Bits initialUsage, BlitFilter filter);
-    
-        void TransferLayout(const ImageVK& image, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout);
-        void TransferLayout(ArrayView<ImageVKReference> images, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout);
-        void TransferLayout(ArrayView<ImageVK> images, ImageUsage::Bits oldLayout, ImageUsage::Bits newLayout);
+        void BlitImage(const ImageVK& src, const ImageVK& dst, BlitFilter filter);
+        void GenerateMipLevels(const ImageVK& image, BlitFilter filter);
+
+        // 旧用途取自资源上跟踪的状态，只对用途变化的子资源生成屏障；只能在主命令缓冲上调用
+        void TransitionImage(const ImageVK& image, ImageUsage::Bits newUsage);
+        void TransitionImage(const ImageVK& image, ImageUsage::Bits newUsage, uint32_t baseMipLevel, uint32_t mipLevelCount, uint32_t baseLayer = 0, uint32_t layerCount = VK_REMAINING_ARRAY_LAYERS);
+        void TransitionImage(ArrayView<ImageVKReference> images, ImageUsage::Bits newUsage);
+        void TransitionImage(ArrayView<ImageVK> images, ImageUsage::Bits newUsage);
+        void TransitionBuffer(const BufferVK& buffer, BufferUsage::Bits newUsage);
+        // image开始使用与previous共享的内存：等待previous的最后一次访问完成，丢弃image的旧内容并转换到newUsage
+        void AliasImage(ArrayView<ImageVKReference> previous, const ImageVK& image, ImageUsage::Bits newUsage);
+        // 队列族所有权转移，release在源队列上录制，acquire在目标队列上录制，两者使用相同的布局转换
+        // 旧用途取自整张图像当前跟踪的状态，release不修改跟踪状态，acquire之后资源处于newUsage
+        void ReleaseImage(const ImageVK& image, ImageUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+        void AcquireImage(const ImageVK& image, ImageUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+        void ReleaseBuffer(const BufferVK& buffer, BufferUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+        void AcquireBuffer(const BufferVK& buffer, BufferUsage::Bits newUsage, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+        // 专用计算队列不支持图形阶段，屏障中的阶段和访问掩码按队列能力裁剪
+        void RestrictPipelineStages(vk::PipelineStageFlags2 stages) { mSupportedStages = stages; }
+
+        // 屏障先进入队列，在下一次draw/dispatch/copy/BeginPass之前统一提交
+        void FlushBarriers();
+        // 时间戳在之前的所有命令完成后写入，查询在使用前需要在同一帧内重置
+        void ResetQueries(vk::QueryPool queryPool, uint32_t firstQuery, uint32_t queryCount);
+        void WriteTimestamp(vk::QueryPool queryPool, uint32_t query);
+        const CommandBufferStats& GetStats() const { return mStats; }
 
         template<typename... Buffers>
         void BindVertexBuffers(const Buffers&... vertexBuffers)
         {
             constexpr size_t BufferCount = sizeof...(Buffers);
+            static_assert(BufferCount <= MaxVertexBuffers);
             std::array buffers = { vertexBuffers.GetNativeBuffer()... };
-            uint64_t offsets[BufferCount] = { 0 };
-            this->GetNativeCmdBuffer().bindVertexBuffers(0, BufferCount, buffers.data(), offsets);
+            this->BindNativeVertexBuffers(buffers.data(), (uint32_t)BufferCount);
         }
 
         template<typename T>
@@ -82,7 +132,62 @@ namespace RHI::Vulkan
             this->PushConstants(renderPass, (const uint8_t*)constants, sizeof(T));
         }
 
+        template<typename T>
+        void PushConstants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, const T* constants)
+        {
+            this->PushConstants(layout, stages, (const uint8_t*)constants, sizeof(T));
+        }
+
+    public:
+        constexpr static uint32_t MaxVertexBuffers = 16;
+        constexpr static uint32_t MaxDescriptorSets = 4;
+
+    private:
+        struct BindPointState
+        {
+            vk::Pipeline Pipeline;
+            vk::PipelineLayout Layout;
+            std::array<vk::DescriptorSet, MaxDescriptorSets> Sets {};
+            std::array<uint64_t, MaxDescriptorSets> DescriptorBufferOffsets {};
+        };
+
+        // 命令缓冲内已经录制的绑定和动态状态
+        struct ShadowState
+        {
+            std::array<BindPointState, 2> BindPoints {};
+            vk::Buffer IndexBuffer;
+            vk::IndexType IndexType = vk::IndexType::eUint32;
+            std::array<vk::Buffer, MaxVertexBuffers> VertexBuffers {};
+            std::optional<vk::Viewport> Viewport;
+            std::optional<vk::Rect2D> Scissor;
+        };
+
+        struct TransitionRange
+        {
+            vk::ImageSubresourceRange Range;
+            ImageUsage::Bits OldUsage;
+        };
+
+        // 找出旧用途相同的子资源区间写入mTransitionRanges，skipUnchanged时跳过不需要屏障的区间
+        void CollectTransitionRanges(const ImageVK& image, ImageUsage::Bits newUsage, uint32_t baseMipLevel, uint32_t mipLevelCount, uint32_t baseLayer, uint32_t layerCount, bool skipUnchanged);
+        void QueueImageBarrier(const vk::ImageMemoryBarrier2& barrier);
+        void QueueBufferBarrier(const vk::BufferMemoryBarrier2& barrier);
+        BindPointState* GetBindPointState(vk::PipelineBindPoint bindPoint);
+        void BindLayout(BindPointState& state, vk::PipelineLayout layout);
+        void BindIndexBuffer(const BufferVK& indexBuffer, vk::IndexType indexType);
+        void BindNativeVertexBuffers(const vk::Buffer* buffers, uint32_t bufferCount);
+
     private:
         vk::CommandBuffer mCmdBuffer;
+        bool mbDescriptorBufferBound = false;
+        // BeginPass和EndPass之间不允许排队屏障
+        bool mbInsidePass = false;
+        // secondary由ParallelRecorderVK的工作线程录制，不能修改资源上共享的使用状态
+        bool mbSecondary = false;
+        BarrierBatchVK mBarriers;
+        CommandBufferStats mStats;
+        std::vector<TransitionRange> mTransitionRanges;
+        ShadowState mShadowState;
+        vk::PipelineStageFlags2 mSupportedStages = vk::PipelineStageFlagBits2::eAllCommands;
     };
 }
\ No newline at end of file
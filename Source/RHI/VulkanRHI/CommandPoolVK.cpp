@@ -0,0 +1,85 @@
+#include "CommandPoolVK.hpp"
+
+#include <algorithm>
+
+#include "Renderer/RendererBase.hpp"
+
+namespace RHI::Vulkan
+{
+    CommandPoolVK::CommandPoolVK(CommandPoolVK &&other) noexcept
+    {
+        this->mPool = other.mPool;
+        this->mLevels = std::move(other.mLevels);
+
+        other.mPool = vk::CommandPool {};
+    }
+
+    CommandPoolVK &CommandPoolVK::operator=(CommandPoolVK &&other) noexcept
+    {
+        this->Destroy();
+
+        this->mPool = other.mPool;
+        this->mLevels = std::move(other.mLevels);
+
+        other.mPool = vk::CommandPool {};
+        return *this;
+    }
+
+    CommandPoolVK::~CommandPoolVK()
+    {
+        this->Destroy();
+    }
+
+    void CommandPoolVK::Init(uint32_t queueFamilyIndex)
+    {
+        this->Destroy();
+        if (GetCurrentRenderer().IsNullBackend()) { return; }
+
+        vk::CommandPoolCreateInfo commandPoolCI {};
+        commandPoolCI.setQueueFamilyIndex(queueFamilyIndex);
+        commandPoolCI.setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+        mPool = GetCurrentRenderer().GetDevice().createCommandPool(commandPoolCI);
+    }
+
+    void CommandPoolVK::Destroy()
+    {
+        if (!mPool) { return; }
+
+        // 销毁命令池时其中分配的命令缓冲一并释放
+        GetCurrentRenderer().GetDevice().destroyCommandPool(mPool);
+        mPool = vk::CommandPool {};
+        for (auto& list : mLevels)
+        {
+            list.Buffers.clear();
+            list.UsedCount = 0;
+        }
+    }
+
+    vk::CommandBuffer CommandPoolVK::Acquire(vk::CommandBufferLevel level)
+    {
+        if (!mPool) { return vk::CommandBuffer {}; }
+
+        auto& list = mLevels[level == vk::CommandBufferLevel::ePrimary ? 0 : 1];
+        if (list.UsedCount == list.Buffers.size())
+        {
+            // 空闲列表用完时成倍扩充，减少分配调用
+            uint32_t allocateCount = (uint32_t)std::max<size_t>(list.Buffers.size(), 1);
+
+            vk::CommandBufferAllocateInfo cmdBufferAI {};
+            cmdBufferAI.setCommandPool(mPool);
+            cmdBufferAI.setLevel(level);
+            cmdBufferAI.setCommandBufferCount(allocateCount);
+            auto cmdBuffers = GetCurrentRenderer().GetDevice().allocateCommandBuffers(cmdBufferAI);
+            list.Buffers.insert(list.Buffers.end(), cmdBuffers.begin(), cmdBuffers.end());
+        }
+        return list.Buffers[list.UsedCount++];
+    }
+
+    void CommandPoolVK::Reset()
+    {
+        if (!mPool || (mLevels[0].UsedCount == 0 && mLevels[1].UsedCount == 0)) { return; }
+
+        GetCurrentRenderer().GetDevice().resetCommandPool(mPool);
+        for (auto& list : mLevels) { list.UsedCount = 0; }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+
+#include <array>
+#include <vector>
+
+namespace RHI::Vulkan
+{
+    // 分配出的命令缓冲不单独重置，Reset时通过vkResetCommandPool整体回收，之后按分配顺序重新发放
+    // 同一个命令池只能在一个线程中使用
+    class CommandPoolVK
+    {
+    public:
+        CommandPoolVK() = default;
+        CommandPoolVK(const CommandPoolVK&) = delete;
+        CommandPoolVK& operator=(const CommandPoolVK&) = delete;
+        CommandPoolVK(CommandPoolVK&& other) noexcept;
+        CommandPoolVK& operator=(CommandPoolVK&& other) noexcept;
+        ~CommandPoolVK();
+
+        void Init(uint32_t queueFamilyIndex);
+        void Destroy();
+
+        // 空后端返回空句柄，CommandBufferVK对空句柄只做状态跟踪
+        vk::CommandBuffer Acquire(vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary);
+        // 需要保证该池分配的命令缓冲都已执行完成
+        void Reset();
+
+        vk::CommandPool GetNativePool() const { return mPool; }
+        size_t GetAllocatedCount() const { return mLevels[0].Buffers.size() + mLevels[1].Buffers.size(); }
+
+    private:
+        // 下标在UsedCount之后的命令缓冲为空闲
+        struct CommandBufferList
+        {
+            std::vector<vk::CommandBuffer> Buffers;
+            size_t UsedCount = 0;
+        };
+
+        vk::CommandPool mPool;
+        std::array<CommandBufferList, 2> mLevels;
+    };
+}
@@ -74,91 +74,101 @@ namespace RHI::Vulkan
         }
     }
 
-    vk::PipelineStageFlags BufferUsageToPipelineStage(BufferUsage::Bits layout)
+    vk::PipelineStageFlags2 BufferUsageToPipelineStage(BufferUsage::Bits layout)
     {
+        // 着色器访问无法得知具体阶段，只覆盖实际会访问资源的着色器阶段
+        constexpr vk::PipelineStageFlags2 shaderStages = vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+
         switch (layout)
         {
         case BufferUsage::UNKNOWN:
-            return vk::PipelineStageFlagBits::eTopOfPipe;
+            return vk::PipelineStageFlagBits2::eNone;
         case BufferUsage::TRANSFER_SOURCE:
-            return vk::PipelineStageFlagBits::eTransfer;
+            return vk::PipelineStageFlagBits2::eCopy;
         case BufferUsage::TRANSFER_DESTINATION:
-            return vk::PipelineStageFlagBits::eTransfer;
+            return vk::PipelineStageFlagBits2::eCopy | vk::PipelineStageFlagBits2::eClear;
         case BufferUsage::UNIFORM_TEXEL_BUFFER:
-            return vk::PipelineStageFlagBits::eVertexShader; // TODO: from other shader stages?
+            return shaderStages;
         case BufferUsage::STORAGE_TEXEL_BUFFER:
-            return vk::PipelineStageFlagBits::eComputeShader;
+            return shaderStages;
         case BufferUsage::UNIFORM_BUFFER:
-            return vk::PipelineStageFlagBits::eVertexShader;
+            return shaderStages;
         case BufferUsage::STORAGE_BUFFER:
-            return vk::PipelineStageFlagBits::eComputeShader;
+            return shaderStages;
         case BufferUsage::INDEX_BUFFER:
-            return vk::PipelineStageFlagBits::eVertexInput;
+            return vk::PipelineStageFlagBits2::eIndexInput;
         case BufferUsage::VERTEX_BUFFER:
-            return vk::PipelineStageFlagBits::eVertexInput;
+            return vk::PipelineStageFlagBits2::eVertexAttributeInput;
         case BufferUsage::INDIRECT_BUFFER:
-            return vk::PipelineStageFlagBits::eDrawIndirect;
+            return vk::PipelineStageFlagBits2::eDrawIndirect;
         case BufferUsage::SHADER_DEVICE_ADDRESS:
-            return vk::PipelineStageFlagBits::eFragmentShader; // TODO: what should be here?
+            return shaderStages;
         case BufferUsage::TRANSFORM_FEEDBACK_BUFFER:
-            return vk::PipelineStageFlagBits::eTransformFeedbackEXT;
+            return vk::PipelineStageFlagBits2::eTransformFeedbackEXT;
         case BufferUsage::TRANSFORM_FEEDBACK_COUNTER_BUFFER:
-            return vk::PipelineStageFlagBits::eTransformFeedbackEXT;
+            return vk::PipelineStageFlagBits2::eTransformFeedbackEXT | vk::PipelineStageFlagBits2::eDrawIndirect;
         case BufferUsage::CONDITIONAL_RENDERING:
-            return vk::PipelineStageFlagBits::eConditionalRenderingEXT;
+            return vk::PipelineStageFlagBits2::eConditionalRenderingEXT;
         case BufferUsage::ACCELERATION_STRUCTURE_BUILD_INPUT_READONLY:
-            return vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR;
+            return vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR;
         case BufferUsage::ACCELERATION_STRUCTURE_STORAGE:
-            return vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR; // TODO: what should be here?
+            return vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR;
         case BufferUsage::SHADER_BINDING_TABLE:
-            return vk::PipelineStageFlagBits::eFragmentShader; // TODO: what should be here?
+            return vk::PipelineStageFlagBits2::eRayTracingShaderKHR;
+        case BufferUsage::SAMPLER_DESCRIPTOR_BUFFER:
+        case BufferUsage::RESOURCE_DESCRIPTOR_BUFFER:
+            return shaderStages;
         default:
             assert(false);
-            return vk::PipelineStageFlags{};
+            return vk::PipelineStageFlags2{};
         }
     }
 
-    vk::AccessFlags BufferUsageToAccessFlags(BufferUsage::Bits layout)
+    vk::AccessFlags2 BufferUsageToAccessFlags(BufferUsage::Bits layout)
     {
         switch (layout)
         {
         case BufferUsage::UNKNOWN:
-            return vk::AccessFlags{};
+            return vk::AccessFlagBits2::eNone;
         case BufferUsage::TRANSFER_SOURCE:
-            return vk::AccessFlagBits::eTransferRead;
+            return vk::AccessFlagBits2::eTransferRead;
         case BufferUsage::TRANSFER_DESTINATION:
-            return vk::AccessFlagBits::eTransferWrite;
+            return vk::AccessFlagBits2::eTransferWrite;
         case BufferUsage::UNIFORM_TEXEL_BUFFER:
-            return vk::AccessFlagBits::eShaderRead;
+            return vk::AccessFlagBits2::eShaderSampledRead;
         case BufferUsage::STORAGE_TEXEL_BUFFER:
-            return vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eShaderRead;
+            return vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite;
         case BufferUsage::UNIFORM_BUFFER:
-            return vk::AccessFlagBits::eShaderRead;
+            return vk::AccessFlagBits2::eUniformRead;
         case BufferUsage::STORAGE_BUFFER:
-            return vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eShaderRead;
+            return vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite;
         case BufferUsage::INDEX_BUFFER:
-            return vk::AccessFlagBits::eIndexRead;
+            return vk::AccessFlagBits2::eIndexRead;
         case BufferUsage::VERTEX_BUFFER:
-            return vk::AccessFlagBits::eVertexAttributeRead;
+            return vk::AccessFlagBits2::eVertexAttributeRead;
         case BufferUsage::INDIRECT_BUFFER:
-            return vk::AccessFlagBits::eIndirectCommandRead;
+            return vk::AccessFlagBits2::eIndirectCommandRead;
         case BufferUsage::SHADER_DEVICE_ADDRESS:
-            return vk::AccessFlagBits::eShaderRead;
+            return vk::AccessFlagBits2::eShaderStorageRead;
         case BufferUsage::TRANSFORM_FEEDBACK_BUFFER:
-            return vk::AccessFlagBits::eTransformFeedbackWriteEXT;
+            return vk::AccessFlagBits2::eTransformFeedbackWriteEXT;
         case BufferUsage::TRANSFORM_FEEDBACK_COUNTER_BUFFER:
-            return vk::AccessFlagBits::eTransformFeedbackCounterWriteEXT;
+            return vk::AccessFlagBits2::eTransformFeedbackCounterReadEXT | vk::AccessFlagBits2::eTransformFeedbackCounterWriteEXT;
         case BufferUsage::CONDITIONAL_RENDERING:
-            return vk::AccessFlagBits::eConditionalRenderingReadEXT;
+            return vk::AccessFlagBits2::eConditionalRenderingReadEXT;
         case BufferUsage::ACCELERATION_STRUCTURE_BUILD_INPUT_READONLY:
-            return vk::AccessFlagBits::eAccelerationStructureReadKHR;
+            // 与构建阶段配对；规范要求几何输入缓冲按着色器读取同步，两者一起设置
+            return vk::AccessFlagBits2::eAccelerationStructureReadKHR | vk::AccessFlagBits2::eShaderRead;
         case BufferUsage::ACCELERATION_STRUCTURE_STORAGE:
-            return vk::AccessFlagBits::eAccelerationStructureReadKHR;
+            return vk::AccessFlagBits2::eAccelerationStructureReadKHR | vk::AccessFlagBits2::eAccelerationStructureWriteKHR;
         case BufferUsage::SHADER_BINDING_TABLE:
-            return vk::AccessFlagBits::eShaderRead;
+            return vk::AccessFlagBits2::eShaderBindingTableReadKHR;
+        case BufferUsage::SAMPLER_DESCRIPTOR_BUFFER:
+        case BufferUsage::RESOURCE_DESCRIPTOR_BUFFER:
+            return vk::AccessFlagBits2::eDescriptorBufferReadEXT;
         default:
             assert(false);
-            return vk::AccessFlags{};
+            return vk::AccessFlags2{};
         }
     }
 
@@ -250,7 +260,8 @@ namespace RHI::Vulkan
         case ImageUsage::DEPTH_STENCIL_ATTACHMENT:
             return vk::ImageLayout::eDepthStencilAttachmentOptimal;
         case ImageUsage::INPUT_ATTACHMENT:
-            return vk::ImageLayout::eAttachmentOptimalKHR; // TODO: is it ok?
+            // 颜色和深度格式的输入附件都可以使用通用的只读布局
+            return vk::ImageLayout::eReadOnlyOptimal;
         case ImageUsage::FRAGMENT_SHADING_RATE_ATTACHMENT:
             return vk::ImageLayout::eFragmentShadingRateAttachmentOptimalKHR;
         default:
@@ -259,59 +270,59 @@ namespace RHI::Vulkan
         }
     }
 
-    vk::AccessFlags ImageUsageToAccessFlags(ImageUsage::Bits usage)
+    vk::AccessFlags2 ImageUsageToAccessFlags(ImageUsage::Bits usage)
     {
         switch (usage)
         {
         case ImageUsage::UNKNOWN:
-            return vk::AccessFlags{};
+            return vk::AccessFlagBits2::eNone;
         case ImageUsage::TRANSFER_SOURCE:
-            return vk::AccessFlagBits::eTransferRead;
+            return vk::AccessFlagBits2::eTransferRead;
         case ImageUsage::TRANSFER_DESTINATION:
-            return vk::AccessFlagBits::eTransferWrite;
+            return vk::AccessFlagBits2::eTransferWrite;
         case ImageUsage::SHADER_READ:
-            return vk::AccessFlagBits::eShaderRead;
+            return vk::AccessFlagBits2::eShaderSampledRead;
         case ImageUsage::STORAGE:
-            return vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite; // TODO: what if storage is not read or write?
+            return vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite;
         case ImageUsage::COLOR_ATTACHMENT:
-            return vk::AccessFlagBits::eColorAttachmentWrite;
+            return vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite;
         case ImageUsage::DEPTH_STENCIL_ATTACHMENT:
-            return vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+            return vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite;
         case ImageUsage::INPUT_ATTACHMENT:
-            return vk::AccessFlagBits::eInputAttachmentRead;
+            return vk::AccessFlagBits2::eInputAttachmentRead;
         case ImageUsage::FRAGMENT_SHADING_RATE_ATTACHMENT:
-            return vk::AccessFlagBits::eFragmentShadingRateAttachmentReadKHR;
+            return vk::AccessFlagBits2::eFragmentShadingRateAttachmentReadKHR;
         default:
             assert(false);
-            return vk::AccessFlags{};
+            return vk::AccessFlags2{};
         }
     }
 
-    vk::PipelineStageFlags ImageUsageToPipelineStage(ImageUsage::Bits usage)
+    vk::PipelineStageFlags2 ImageUsageToPipelineStage(ImageUsage::Bits usage)
     {
         switch (usage)
         {
         case ImageUsage::UNKNOWN:
-            return vk::PipelineStageFlagBits::eTopOfPipe;
+            return vk::PipelineStageFlagBits2::eNone;
         case ImageUsage::TRANSFER_SOURCE:
-            return vk::PipelineStageFlagBits::eTransfer;
+            return vk::PipelineStageFlagBits2::eCopy | vk::PipelineStageFlagBits2::eBlit;
         case ImageUsage::TRANSFER_DESTINATION:
-            return vk::PipelineStageFlagBits::eTransfer;
+            return vk::PipelineStageFlagBits2::eCopy | vk::PipelineStageFlagBits2::eBlit | vk::PipelineStageFlagBits2::eClear;
         case ImageUsage::SHADER_READ:
-            return vk::PipelineStageFlagBits::eFragmentShader; // TODO: whats for vertex shader reads?
+            return vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
         case ImageUsage::STORAGE:
-            return vk::PipelineStageFlagBits::eFragmentShader; // TODO: whats for vertex shader reads?
+            return vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
         case ImageUsage::COLOR_ATTACHMENT:
-            return vk::PipelineStageFlagBits::eColorAttachmentOutput;
+            return vk::PipelineStageFlagBits2::eColorAttachmentOutput;
         case ImageUsage::DEPTH_STENCIL_ATTACHMENT:
-            return vk::PipelineStageFlagBits::eEarlyFragmentTests; // TODO: whats for late fragment test?
+            return vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests;
         case ImageUsage::INPUT_ATTACHMENT:
-            return vk::PipelineStageFlagBits::eFragmentShader; // TODO: check if at least works
+            return vk::PipelineStageFlagBits2::eFragmentShader;
         case ImageUsage::FRAGMENT_SHADING_RATE_ATTACHMENT:
-            return vk::PipelineStageFlagBits::eFragmentShadingRateAttachmentKHR;
+            return vk::PipelineStageFlagBits2::eFragmentShadingRateAttachmentKHR;
         default:
             assert(false);
-            return vk::PipelineStageFlags{};
+            return vk::PipelineStageFlags2{};
         }
     }
 
@@ -380,7 +391,7 @@ namespace RHI::Vulkan
         }
     }
 
-    vk::ImageMemoryBarrier CreateImageMemoryBarrier(vk::Image image, ImageUsage::Bits oldUsage, ImageUsage::Bits newUsage, Format format, uint32_t mipLevelCount, uint32_t layerCount)
+    vk::ImageMemoryBarrier2 CreateImageMemoryBarrier(vk::Image image, ImageUsage::Bits oldUsage, ImageUsage::Bits newUsage, Format format, uint32_t mipLevelCount, uint32_t layerCount)
     {
         vk::ImageSubresourceRange subresourceRange;
         subresourceRange
@@ -390,9 +401,11 @@ namespace RHI::Vulkan
             .setLayerCount(layerCount)
             .setLevelCount(mipLevelCount);
 
-        vk::ImageMemoryBarrier imageBarrier;
+        vk::ImageMemoryBarrier2 imageBarrier;
         imageBarrier
             .setImage(image)
+            .setSrcStageMask(ImageUsageToPipelineStage(oldUsage))
+            .setDstStageMask(ImageUsageToPipelineStage(newUsage))
             .setOldLayout(ImageUsageToImageLayout(oldUsage))
             .setNewLayout(ImageUsageToImageLayout(newUsage))
             .setSrcAccessMask(ImageUsageToAccessFlags(oldUsage))
@@ -10,16 +10,16 @@ namespace RHI::Vulkan
     vk::ShaderStageFlags PipelineTypeToShaderStages(vk::PipelineBindPoint type);
     vk::AttachmentLoadOp AttachmentStateToLoadOp(AttachmentState state);
     ImageUsage::Bits AttachmentStateToImageUsage(AttachmentState state);
-    vk::PipelineStageFlags BufferUsageToPipelineStage(BufferUsage::Bits layout);
-    vk::AccessFlags BufferUsageToAccessFlags(BufferUsage::Bits layout);
+    vk::PipelineStageFlags2 BufferUsageToPipelineStage(BufferUsage::Bits layout);
+    vk::AccessFlags2 BufferUsageToAccessFlags(BufferUsage::Bits layout);
     bool HasImageWriteDependency(ImageUsage::Bits usage);
     bool HasBufferWriteDependency(BufferUsage::Bits usage);
     vk::Filter BlitFilterToNative(BlitFilter filter);
 
     vk::ImageAspectFlags ImageFormatToImageAspect(Format format);
     vk::ImageLayout ImageUsageToImageLayout(ImageUsage::Bits usage);
-    vk::AccessFlags ImageUsageToAccessFlags(ImageUsage::Bits usage);
-    vk::PipelineStageFlags ImageUsageToPipelineStage(ImageUsage::Bits usage);
+    vk::AccessFlags2 ImageUsageToAccessFlags(ImageUsage::Bits usage);
+    vk::PipelineStageFlags2 ImageUsageToPipelineStage(ImageUsage::Bits usage);
 
     vk::ImageSubresourceLayers GetDefaultImageSubresourceLayers(const ImageVK& image);
     vk::ImageSubresourceLayers GetDefaultImageSubresourceLayers(const ImageVK& image, uint32_t mipLevel, uint32_t layer);
@@ -29,7 +29,7 @@ namespace RHI::Vulkan
     uint32_t CalculateImageLayerCount(ImageOptions::Value options);
 
     vk::ImageViewType GetImageViewType(const ImageVK& image);
-    vk::ImageMemoryBarrier CreateImageMemoryBarrier(vk::Image image, ImageUsage::Bits oldUsage, ImageUsage::Bits newUsage, Format format, uint32_t mipLevelCount, uint32_t layerCount);
+    vk::ImageMemoryBarrier2 CreateImageMemoryBarrier(vk::Image image, ImageUsage::Bits oldUsage, ImageUsage::Bits newUsage, Format format, uint32_t mipLevelCount, uint32_t layerCount);
 
     ImageUsage::Bits UniformTypeToImageUsage(UniformType type);
     BufferUsage::Bits UniformTypeToBufferUsage(UniformType type);
@@ -0,0 +1,122 @@
+#include "DescriptorBufferVK.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+namespace RHI::Vulkan
+{
+    static size_t AlignUp(size_t value, size_t alignment)
+    {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
+    void DescriptorBufferVK::Init(size_t frameCount, size_t frameByteSize)
+    {
+        auto& renderer = GetCurrentRenderer();
+
+        auto properties = renderer.GetPhysicalDevice().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDescriptorBufferPropertiesEXT>();
+        mProperties = properties.get<vk::PhysicalDeviceDescriptorBufferPropertiesEXT>();
+
+        mFrameByteSize = AlignUp(frameByteSize, (size_t)mProperties.descriptorBufferOffsetAlignment);
+        mBuffer.Init(
+            mFrameByteSize * frameCount,
+            BufferUsage::SAMPLER_DESCRIPTOR_BUFFER | BufferUsage::RESOURCE_DESCRIPTOR_BUFFER | BufferUsage::SHADER_DEVICE_ADDRESS,
+            MemoryUsage::CPUToGPU
+        );
+        (void)mBuffer.MapMemory();
+        mBufferAddress = mBuffer.GetDeviceAddress();
+
+        mFrameBase = 0;
+        mFrameCursor = 0;
+    }
+
+    void DescriptorBufferVK::Destroy()
+    {
+        mBuffer = BufferVK();
+        mBufferAddress = 0;
+    }
+
+    void DescriptorBufferVK::StartFrame(size_t frameIndex)
+    {
+        mFrameBase = frameIndex * mFrameByteSize;
+        mFrameCursor = mFrameBase;
+    }
+
+    DescriptorBufferAllocation DescriptorBufferVK::Allocate(vk::DescriptorSetLayout layout)
+    {
+        const auto& dispatch = GetCurrentRenderer().GetDynamicDispatch();
+        size_t layoutSize = (size_t)GetCurrentRenderer().GetDevice().getDescriptorSetLayoutSizeEXT(layout, dispatch);
+
+        size_t offset = AlignUp(mFrameCursor, (size_t)mProperties.descriptorBufferOffsetAlignment);
+        if (offset + layoutSize > mFrameBase + mFrameByteSize)
+        {
+            GDebugInfoCallback("DescriptorBuffer", "Descriptor buffer frame region is full");
+            return DescriptorBufferAllocation{ };
+        }
+        mFrameCursor = offset + layoutSize;
+
+        return DescriptorBufferAllocation{ offset, mBuffer.MapMemory() + offset };
+    }
+
+    void DescriptorBufferVK::Flush()
+    {
+        if (mFrameCursor > mFrameBase)
+        {
+            mBuffer.FlushMemory(mFrameCursor - mFrameBase, mFrameBase);
+        }
+    }
+
+    void DescriptorBufferVK::BindBuffer(const vk::CommandBuffer &cmdBuffer) const
+    {
+        vk::DescriptorBufferBindingInfoEXT bindingInfo {};
+        bindingInfo.setAddress(mBufferAddress);
+        bindingInfo.setUsage(vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT | vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT);
+        cmdBuffer.bindDescriptorBuffersEXT(bindingInfo, GetCurrentRenderer().GetDynamicDispatch());
+    }
+
+    void DescriptorBufferVK::SetOffset(const vk::CommandBuffer &cmdBuffer, vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, uint32_t set, uint64_t offset) const
+    {
+        uint32_t bufferIndex = 0;
+        vk::DeviceSize bufferOffset = offset;
+        cmdBuffer.setDescriptorBufferOffsetsEXT(bindPoint, layout, set, bufferIndex, bufferOffset, GetCurrentRenderer().GetDynamicDispatch());
+    }
+
+    uint64_t DescriptorBufferVK::GetBindingOffset(vk::DescriptorSetLayout layout, uint32_t binding) const
+    {
+        return GetCurrentRenderer().GetDevice().getDescriptorSetLayoutBindingOffsetEXT(layout, binding, GetCurrentRenderer().GetDynamicDispatch());
+    }
+
+    size_t DescriptorBufferVK::GetDescriptorSize(vk::DescriptorType type) const
+    {
+        switch (type)
+        {
+        case vk::DescriptorType::eSampler:
+            return mProperties.samplerDescriptorSize;
+        case vk::DescriptorType::eCombinedImageSampler:
+            return mProperties.combinedImageSamplerDescriptorSize;
+        case vk::DescriptorType::eSampledImage:
+            return mProperties.sampledImageDescriptorSize;
+        case vk::DescriptorType::eStorageImage:
+            return mProperties.storageImageDescriptorSize;
+        case vk::DescriptorType::eUniformTexelBuffer:
+            return mProperties.uniformTexelBufferDescriptorSize;
+        case vk::DescriptorType::eStorageTexelBuffer:
+            return mProperties.storageTexelBufferDescriptorSize;
+        case vk::DescriptorType::eUniformBuffer:
+            return mProperties.uniformBufferDescriptorSize;
+        case vk::DescriptorType::eStorageBuffer:
+            return mProperties.storageBufferDescriptorSize;
+        case vk::DescriptorType::eInputAttachment:
+            return mProperties.inputAttachmentDescriptorSize;
+        case vk::DescriptorType::eAccelerationStructureKHR:
+            return mProperties.accelerationStructureDescriptorSize;
+        default:
+            assert(false);
+            return 0;
+        }
+    }
+
+    void DescriptorBufferVK::WriteDescriptor(const vk::DescriptorGetInfoEXT &info, uint8_t *dst) const
+    {
+        GetCurrentRenderer().GetDevice().getDescriptorEXT(info, GetDescriptorSize(info.type), dst, GetCurrentRenderer().GetDynamicDispatch());
+    }
+}
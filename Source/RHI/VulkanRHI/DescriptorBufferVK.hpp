@@ -0,0 +1,50 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+#include "BufferVK.hpp"
+
+#include <cstdint>
+
+namespace RHI::Vulkan
+{
+    struct DescriptorBufferAllocation
+    {
+        constexpr static uint64_t InvalidOffset = uint64_t(-1);
+
+        uint64_t Offset = InvalidOffset;
+        uint8_t* Data = nullptr;
+
+        bool IsValid() const { return Offset != InvalidOffset; }
+    };
+
+    // VK_EXT_descriptor_buffer后端：描述符直接写入映射内存，按虚拟帧划分为环形区域，绑定时只设置偏移
+    class DescriptorBufferVK
+    {
+    public:
+        void Init(size_t frameCount, size_t frameByteSize);
+        void Destroy();
+
+        // 切换到当前虚拟帧的区域，该区域上一次的内容已经不再被GPU使用
+        void StartFrame(size_t frameIndex);
+        DescriptorBufferAllocation Allocate(vk::DescriptorSetLayout layout);
+        // 提交前刷新本帧写入的区域
+        void Flush();
+
+        void BindBuffer(const vk::CommandBuffer& cmdBuffer) const;
+        void SetOffset(const vk::CommandBuffer& cmdBuffer, vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, uint32_t set, uint64_t offset) const;
+
+        uint64_t GetBindingOffset(vk::DescriptorSetLayout layout, uint32_t binding) const;
+        size_t GetDescriptorSize(vk::DescriptorType type) const;
+        void WriteDescriptor(const vk::DescriptorGetInfoEXT& info, uint8_t* dst) const;
+
+        size_t GetFrameUsedBytes() const { return mFrameCursor - mFrameBase; }
+
+    private:
+        BufferVK mBuffer;
+        vk::DeviceAddress mBufferAddress = 0;
+        vk::PhysicalDeviceDescriptorBufferPropertiesEXT mProperties;
+        size_t mFrameByteSize = 0;
+        size_t mFrameBase = 0;
+        size_t mFrameCursor = 0;
+    };
+}
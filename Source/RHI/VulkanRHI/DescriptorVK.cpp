@@ -1,65 +1,114 @@
 #include "DescriptorVK.hpp"
 #include "CommonVK.hpp"
+#include "NullBackendVK.hpp"
 
 #include "Renderer/RendererBase.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
 namespace RHI::Vulkan
 {
-    SamplerVK EmptySampler;
+    // 同一个Binding对象通常只写入每个虚拟帧各自的DescriptorSet，超过这个数量时丢弃最旧的记录
+    constexpr size_t MaxTrackedDescriptorSets = 8;
+
+    static vk::DescriptorBufferInfo ToDescriptorBufferInfo(const BufferVK& buffer)
+    {
+        return vk::DescriptorBufferInfo{ buffer.GetNativeBuffer(), 0, buffer.GetSize() };
+    }
+
+    static vk::DescriptorImageInfo ToDescriptorImageInfo(const ImageVK* image, ImageView view, ImageUsage::Bits usage, const SamplerVK* sampler)
+    {
+        return vk::DescriptorImageInfo{
+            sampler ? sampler->GetNativeSampler() : vk::Sampler{ },
+            image ? image->GetNativeView(view) : vk::ImageView{ },
+            ImageUsageToImageLayout(usage)
+        };
+    }
     
-    void ResolveInfo::Resolve(const std::string &name, const BufferVK &buffer)
+    void ResolveInfo::Resolve(NameID name, const BufferVK &buffer)
     {
-        assert(mBufferResolves.find(name) == mBufferResolves.end());
-        mBufferResolves[name] = { buffer };
+        auto& slot = AcquireBufferSlot(name);
+        slot.push_back(buffer);
     }
     
-    void ResolveInfo::Resolve(const std::string &name, ArrayView<const BufferVK> buffers)
+    void ResolveInfo::Resolve(NameID name, ArrayView<const BufferVK> buffers)
     {
-        assert(mBufferResolves.find(name) == mBufferResolves.end());
+        auto& slot = AcquireBufferSlot(name);
         for (const auto& buffer : buffers) 
         {
-            mBufferResolves[name].push_back(buffer);
+            slot.push_back(buffer);
         }
     }
 
-    void ResolveInfo::Resolve(const std::string &name, ArrayView<const BufferVKReference> buffers)
+    void ResolveInfo::Resolve(NameID name, ArrayView<const BufferVKReference> buffers)
     {
-        assert(mBufferResolves.find(name) == mBufferResolves.end());
-        for (const auto& buffer : buffers)
-        {
-            mBufferResolves[name].push_back(buffer);
-        }
+        auto& slot = AcquireBufferSlot(name);
+        slot.insert(slot.end(), buffers.begin(), buffers.end());
     }
 
-    void ResolveInfo::Resolve(const std::string &name, const ImageVK &image)
+    void ResolveInfo::Resolve(NameID name, const ImageVK &image)
     {
-        assert(mImageResolves.find(name) == mImageResolves.end());
-        mImageResolves[name] = { image };
+        auto& slot = AcquireImageSlot(name);
+        slot.push_back(image);
     }
 
-    void ResolveInfo::Resolve(const std::string &name, ArrayView<const ImageVK> images)
+    void ResolveInfo::Resolve(NameID name, ArrayView<const ImageVK> images)
     {
-        assert(mImageResolves.find(name) == mImageResolves.end());
+        auto& slot = AcquireImageSlot(name);
         for (const auto& image : images)
         {
-            mImageResolves[name].push_back(image);
+            slot.push_back(image);
         }
     }
 
-    void ResolveInfo::Resolve(const std::string &name, ArrayView<const ImageVKReference> images)
+    void ResolveInfo::Resolve(NameID name, ArrayView<const ImageVKReference> images)
     {
-        assert(mImageResolves.find(name) == mImageResolves.end());
-        for (const auto& image : images)
-        {
-            mImageResolves[name].push_back(image);
-        }
+        auto& slot = AcquireImageSlot(name);
+        slot.insert(slot.end(), images.begin(), images.end());
+    }
+
+    void ResolveInfo::Clear()
+    {
+        // 保留每个槽位的容量，下一帧重新Resolve时不再分配内存
+        for (auto& buffers : mBufferResolves) { buffers.clear(); }
+        for (auto& images : mImageResolves) { images.clear(); }
+    }
+
+    const std::vector<BufferVKReference>& ResolveInfo::GetBuffers(NameID name) const
+    {
+        assert(name.Index < mBufferResolves.size() && !mBufferResolves[name.Index].empty());
+        return mBufferResolves[name.Index];
+    }
+
+    const std::vector<ImageVKReference>& ResolveInfo::GetImages(NameID name) const
+    {
+        assert(name.Index < mImageResolves.size() && !mImageResolves[name.Index].empty());
+        return mImageResolves[name.Index];
+    }
+
+    std::vector<BufferVKReference>& ResolveInfo::AcquireBufferSlot(NameID name)
+    {
+        assert(name.IsValid());
+        if (name.Index >= mBufferResolves.size()) { mBufferResolves.resize(name.Index + 1); }
+        assert(mBufferResolves[name.Index].empty());
+        return mBufferResolves[name.Index];
     }
 
-    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, const std::string &name, UniformType type)
+    std::vector<ImageVKReference>& ResolveInfo::AcquireImageSlot(NameID name)
+    {
+        assert(name.IsValid());
+        if (name.Index >= mImageResolves.size()) { mImageResolves.resize(name.Index + 1); }
+        assert(mImageResolves[name.Index].empty());
+        return mImageResolves[name.Index];
+    }
+
+    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, NameID name, UniformType type)
     {
         if (UniformTypeToBufferUsage(type) == BufferUsage::UNKNOWN)
         {
-            return Bind(binding, name, EmptySampler, type, ImageView::NATIVE);
+            return Bind(binding, name, type, ImageView::NATIVE);
         }
         mBufferToResolve.push_back(BufferToResolve(
             name,
@@ -70,17 +119,26 @@ namespace RHI::Vulkan
         return *this;
     }
 
-    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, const std::string &name, UniformType type, ImageView view)
+    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, NameID name, UniformType type, ImageView view)
     {
-        return Bind(binding, name, EmptySampler, type, view);
+        // 不带采样器的图像绑定，SamplerHandle为空
+        mImageToResolve.push_back(ImageToResolve(
+            name,
+            binding,
+            type,
+            UniformTypeToImageUsage(type),
+            view,
+            nullptr
+        ));
+        return *this;
     }
 
-    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, const std::string &name, const SamplerVK &sampler, UniformType type)
+    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, NameID name, const SamplerVK &sampler, UniformType type)
     {
         return Bind(binding, name, sampler, type, ImageView::NATIVE);
     }
 
-    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, const std::string &name, const SamplerVK &sampler, UniformType type, ImageView view)
+    DescriptorBinding &DescriptorBinding::Bind(uint32_t binding, NameID name, const SamplerVK &sampler, UniformType type, ImageView view)
     {
         mImageToResolve.push_back(ImageToResolve(
             name,
@@ -105,15 +163,19 @@ namespace RHI::Vulkan
 
     void DescriptorBinding::Resolve(const ResolveInfo &resolveInfo)
     {
+        std::swap(mPrevDescWrites, mDescWrites);
+        std::swap(mPrevBufferWriteInfos, mBufferWirteInfos);
+        std::swap(mPrevImageWriteInfos, mImageWriteInfos);
+
         mImageWriteInfos.clear();
         mBufferWirteInfos.clear();
         mDescWrites.clear();
 
         for (const auto& imageToResolve : mImageToResolve)
         {
-            auto & images = resolveInfo.GetImages().at(imageToResolve.Name);
+            auto & images = resolveInfo.GetImages(imageToResolve.Name);
             size_t index = 0;
-            if (imageToResolve.SamplerHandle->GetNativeSampler())
+            if (imageToResolve.SamplerHandle != nullptr)
             {
                 for (const auto& image : images)
                 {
@@ -137,7 +199,7 @@ namespace RHI::Vulkan
 
         for (const auto& bufferToResolve : mBufferToResolve)
         {
-            auto& buffers = resolveInfo.GetBuffers().at(bufferToResolve.Name);
+            auto& buffers = resolveInfo.GetBuffers(bufferToResolve.Name);
             size_t index = 0;
             for (const auto& buffer : buffers)
             {
@@ -162,61 +224,282 @@ namespace RHI::Vulkan
                 1
             });
         }
+
+        this->UpdateWriteVersions();
     }
 
-    void DescriptorBinding::Write(const vk::DescriptorSet &descriptorSet)
+    void DescriptorBinding::Write(const vk::DescriptorSet &descriptorSet, vk::DescriptorSetLayout layout, uint64_t generation)
     {
+        mLastWriteCount = 0;
         if (mOptions == ResolveOptions::ALREADY_RESOLVED) { return; }
         if (mOptions == ResolveOptions::RESOLVE_ONCE) { mOptions = ResolveOptions::ALREADY_RESOLVED; }
 
-        std::vector<vk::WriteDescriptorSet> writeDescSets;
-        std::vector<vk::DescriptorBufferInfo> descBufferInfos;
-        std::vector<vk::DescriptorImageInfo> descImageInfos;
-        writeDescSets.reserve(mDescWrites.size());
-        descBufferInfos.reserve(mBufferWirteInfos.size());
-        descImageInfos.reserve(mImageWriteInfos.size());
+        if (layout != mTemplateLayout || mbTemplateOutdated) { this->CreateUpdateTemplate(layout); }
 
-        for (const auto& bufferInfo : mBufferWirteInfos)
+        auto written = std::find_if(mWrittenSets.begin(), mWrittenSets.end(),
+            [&descriptorSet](const WrittenSet& entry) { return entry.Set == descriptorSet; });
+        if (written == mWrittenSets.end())
         {
-            descBufferInfos.push_back(vk::DescriptorBufferInfo{
-                bufferInfo.Handle->GetNativeBuffer(),
-                0,
-                bufferInfo.Handle->GetSize()
-            });
+            if (mWrittenSets.size() >= MaxTrackedDescriptorSets) { mWrittenSets.erase(mWrittenSets.begin()); }
+            mWrittenSets.push_back(WrittenSet{ descriptorSet, generation, { } });
+            written = mWrittenSets.end() - 1;
         }
-        for (const auto& imageInfo : mImageWriteInfos)
+
+        auto& versions = written->Versions;
+        // Pool重置后驱动可能返回相同的句柄，此时Set的内容是未定义的，需要全部重写
+        if (written->Generation != generation)
         {
-            descImageInfos.push_back(vk::DescriptorImageInfo{
-                imageInfo.SamplerHandle ? imageInfo.SamplerHandle->GetNativeSampler() : vk::Sampler{ },
-                imageInfo.Handle ? imageInfo.Handle->GetNativeView(imageInfo.View) : vk::ImageView{ },
-                ImageUsageToImageLayout(imageInfo.Usage)
-            });
+            written->Generation = generation;
+            versions.clear();
+        }
+        if (versions.size() != mDescWrites.size()) { versions.assign(mDescWrites.size(), 0); }
+
+        size_t dirtyCount = 0;
+        for (size_t i = 0; i < mDescWrites.size(); i++)
+        {
+            if (versions[i] != mDescWrites[i].Version) { dirtyCount++; }
+        }
+        if (dirtyCount == 0) { return; }
+
+        // 大部分Binding都发生变化时，使用UpdateTemplate一次性写入
+        if (mUpdateTemplate && dirtyCount * 2 >= mDescWrites.size())
+        {
+            this->WriteWithTemplate(descriptorSet);
         }
+        else
+        {
+            mWriteDescSets.clear();
+            mDescBufferInfos.clear();
+            mDescImageInfos.clear();
+            // 预留足够空间，保证WriteDescriptorSet中的指针不会失效
+            mDescBufferInfos.reserve(mBufferWirteInfos.size());
+            mDescImageInfos.reserve(mImageWriteInfos.size());
+
+            for (size_t i = 0; i < mDescWrites.size(); i++)
+            {
+                const auto& descWrite = mDescWrites[i];
+                if (versions[i] == descWrite.Version) { continue; }
+
+                auto& writeDescSet = mWriteDescSets.emplace_back();
+                writeDescSet.setDstSet(descriptorSet);
+                writeDescSet.setDstBinding(descWrite.Binding);
+                writeDescSet.setDescriptorType(ToNative(descWrite.Type));
+                writeDescSet.setDescriptorCount(descWrite.Count);
+
+                if (IsBufferType(descWrite.Type))
+                {
+                    size_t first = mDescBufferInfos.size();
+                    for (uint32_t j = 0; j < descWrite.Count; j++)
+                    {
+                        mDescBufferInfos.push_back(mBufferWirteInfos[descWrite.FirstIndex + j].Native);
+                    }
+                    writeDescSet.setPBufferInfo(mDescBufferInfos.data() + first);
+                }
+                else
+                {
+                    size_t first = mDescImageInfos.size();
+                    for (uint32_t j = 0; j < descWrite.Count; j++)
+                    {
+                        mDescImageInfos.push_back(mImageWriteInfos[descWrite.FirstIndex + j].Native);
+                    }
+                    writeDescSet.setPImageInfo(mDescImageInfos.data() + first);
+                }
+            }
+            if (!GetCurrentRenderer().IsNullBackend()) { GetCurrentRenderer().GetDevice().updateDescriptorSets(mWriteDescSets, { }); }
+            mLastWriteCount = uint32_t(mWriteDescSets.size());
+        }
+
+        for (size_t i = 0; i < mDescWrites.size(); i++)
+        {
+            versions[i] = mDescWrites[i].Version;
+        }
+    }
+
+    void DescriptorBinding::Write(const DescriptorBufferAllocation &allocation, vk::DescriptorSetLayout layout)
+    {
+        mLastWriteCount = 0;
+        if (!allocation.IsValid()) { return; }
+
+        const auto& descriptorBuffer = GetCurrentRenderer().GetDescriptorBuffer();
         for (const auto& descWrite : mDescWrites)
         {
-            auto& writeDescSet = writeDescSets.emplace_back();
-            writeDescSet.setDstSet(descriptorSet);
-            writeDescSet.setDstBinding(descWrite.Binding);
-            writeDescSet.setDescriptorType(ToNative(descWrite.Type));
-            writeDescSet.setDescriptorCount(descWrite.Count);
+            auto descriptorType = ToNative(descWrite.Type);
+            uint8_t* bindingData = allocation.Data + descriptorBuffer.GetBindingOffset(layout, descWrite.Binding);
+            size_t descriptorSize = descriptorBuffer.GetDescriptorSize(descriptorType);
 
-            if (IsBufferType(descWrite.Type))
+            for (uint32_t j = 0; j < descWrite.Count; j++)
             {
-                writeDescSet.setPBufferInfo(descBufferInfos.data() + descWrite.FirstIndex);
+                vk::DescriptorGetInfoEXT getInfo {};
+                vk::DescriptorDataEXT descriptorData {};
+                vk::DescriptorAddressInfoEXT addressInfo {};
+                vk::DescriptorImageInfo imageInfo {};
+
+                getInfo.setType(descriptorType);
+                if (IsBufferType(descWrite.Type))
+                {
+                    const auto& buffer = *mBufferWirteInfos[descWrite.FirstIndex + j].Handle;
+                    addressInfo.setAddress(buffer.GetDeviceAddress());
+                    addressInfo.setRange(buffer.GetSize());
+                    addressInfo.setFormat(vk::Format::eUndefined);
+                    if (descriptorType == vk::DescriptorType::eUniformBuffer) { descriptorData.setPUniformBuffer(&addressInfo); }
+                    else { descriptorData.setPStorageBuffer(&addressInfo); }
+                }
+                else
+                {
+                    const auto& image = mImageWriteInfos[descWrite.FirstIndex + j];
+                    imageInfo = image.Native;
+                    switch (descriptorType)
+                    {
+                    case vk::DescriptorType::eSampler:
+                        descriptorData.setPSampler(&imageInfo.sampler);
+                        break;
+                    case vk::DescriptorType::eCombinedImageSampler:
+                        descriptorData.setPCombinedImageSampler(&imageInfo);
+                        break;
+                    case vk::DescriptorType::eSampledImage:
+                        descriptorData.setPSampledImage(&imageInfo);
+                        break;
+                    case vk::DescriptorType::eStorageImage:
+                        descriptorData.setPStorageImage(&imageInfo);
+                        break;
+                    case vk::DescriptorType::eInputAttachment:
+                        descriptorData.setPInputAttachmentImage(&imageInfo);
+                        break;
+                    default:
+                        assert(false);
+                        break;
+                    }
+                }
+                getInfo.setData(descriptorData);
+                descriptorBuffer.WriteDescriptor(getInfo, bindingData + j * descriptorSize);
             }
-            else
+        }
+        mLastWriteCount = uint32_t(mDescWrites.size());
+    }
+
+    void DescriptorBinding::CreateUpdateTemplate(vk::DescriptorSetLayout layout)
+    {
+        this->DestroyUpdateTemplate();
+        mTemplateLayout = layout;
+        mbTemplateOutdated = false;
+        if (mDescWrites.empty()) { return; }
+
+        std::vector<vk::DescriptorUpdateTemplateEntry> entries;
+        entries.reserve(mDescWrites.size());
+
+        size_t offset = 0;
+        for (const auto& descWrite : mDescWrites)
+        {
+            size_t stride = IsBufferType(descWrite.Type) ? sizeof(vk::DescriptorBufferInfo) : sizeof(vk::DescriptorImageInfo);
+            entries.push_back(vk::DescriptorUpdateTemplateEntry{
+                descWrite.Binding,
+                0,
+                descWrite.Count,
+                ToNative(descWrite.Type),
+                offset,
+                stride
+            });
+            offset += stride * descWrite.Count;
+        }
+        mTemplateData.resize(offset);
+
+        vk::DescriptorUpdateTemplateCreateInfo templateCI {};
+        templateCI.setDescriptorUpdateEntries(entries);
+        templateCI.setTemplateType(vk::DescriptorUpdateTemplateType::eDescriptorSet);
+        templateCI.setDescriptorSetLayout(layout);
+
+        auto& renderer = GetCurrentRenderer();
+        mUpdateTemplate = renderer.IsNullBackend() ? CreateNullHandle<vk::DescriptorUpdateTemplate>() : renderer.GetDevice().createDescriptorUpdateTemplate(templateCI);
+    }
+
+    void DescriptorBinding::DestroyUpdateTemplate()
+    {
+        if (mUpdateTemplate)
+        {
+            if (!GetCurrentRenderer().IsNullBackend()) { GetCurrentRenderer().GetDevice().destroyDescriptorUpdateTemplate(mUpdateTemplate); }
+            mUpdateTemplate = vk::DescriptorUpdateTemplate();
+        }
+    }
+
+    void DescriptorBinding::Invalidate(const vk::DescriptorSet &descriptorSet)
+    {
+        mWrittenSets.erase(std::remove_if(mWrittenSets.begin(), mWrittenSets.end(),
+            [&descriptorSet](const WrittenSet& entry) { return entry.Set == descriptorSet; }),
+            mWrittenSets.end());
+    }
+
+    void DescriptorBinding::UpdateWriteVersions()
+    {
+        bool bLayoutChanged = mDescWrites.size() != mPrevDescWrites.size();
+
+        for (size_t i = 0; i < mDescWrites.size(); i++)
+        {
+            auto& descWrite = mDescWrites[i];
+            if (!bLayoutChanged)
+            {
+                const auto& prevWrite = mPrevDescWrites[i];
+                bLayoutChanged = prevWrite.Type != descWrite.Type || prevWrite.Binding != descWrite.Binding || prevWrite.Count != descWrite.Count;
+            }
+            if (bLayoutChanged)
+            {
+                descWrite.Version = ++mVersionCounter;
+                continue;
+            }
+
+            const auto& prevWrite = mPrevDescWrites[i];
+            bool bEqual = IsBufferType(descWrite.Type)
+                ? std::equal(
+                    mBufferWirteInfos.begin() + descWrite.FirstIndex,
+                    mBufferWirteInfos.begin() + descWrite.FirstIndex + descWrite.Count,
+                    mPrevBufferWriteInfos.begin() + prevWrite.FirstIndex)
+                : std::equal(
+                    mImageWriteInfos.begin() + descWrite.FirstIndex,
+                    mImageWriteInfos.begin() + descWrite.FirstIndex + descWrite.Count,
+                    mPrevImageWriteInfos.begin() + prevWrite.FirstIndex);
+
+            descWrite.Version = bEqual ? prevWrite.Version : ++mVersionCounter;
+        }
+
+        if (bLayoutChanged)
+        {
+            mWrittenSets.clear();
+            mbTemplateOutdated = true;
+        }
+    }
+
+    void DescriptorBinding::WriteWithTemplate(const vk::DescriptorSet &descriptorSet)
+    {
+        if (mbTemplateOutdated) { this->CreateUpdateTemplate(mTemplateLayout); }
+
+        uint8_t* data = mTemplateData.data();
+        for (const auto& descWrite : mDescWrites)
+        {
+            for (uint32_t j = 0; j < descWrite.Count; j++)
             {
-                writeDescSet.setPImageInfo(descImageInfos.data() + descWrite.FirstIndex);
+                if (IsBufferType(descWrite.Type))
+                {
+                    const auto& bufferInfo = mBufferWirteInfos[descWrite.FirstIndex + j].Native;
+                    std::memcpy(data, &bufferInfo, sizeof(bufferInfo));
+                    data += sizeof(bufferInfo);
+                }
+                else
+                {
+                    const auto& descImageInfo = mImageWriteInfos[descWrite.FirstIndex + j].Native;
+                    std::memcpy(data, &descImageInfo, sizeof(descImageInfo));
+                    data += sizeof(descImageInfo);
+                }
             }
         }
-        GetCurrentRenderer().GetDevice().updateDescriptorSets(writeDescSets, { });
+        if (!GetCurrentRenderer().IsNullBackend()) { GetCurrentRenderer().GetDevice().updateDescriptorSetWithTemplate(descriptorSet, mUpdateTemplate, mTemplateData.data()); }
+        mLastWriteCount = uint32_t(mDescWrites.size());
     }
 
     size_t DescriptorBinding::AllocateBinding(const BufferVK &buffer, UniformType type)
     {
         mBufferWirteInfos.push_back(BufferWriteInfo(
             std::addressof(buffer),
-            UniformTypeToBufferUsage(type)
+            UniformTypeToBufferUsage(type),
+            ToDescriptorBufferInfo(buffer)
         ));
         return mBufferWirteInfos.size() - 1;
     }
@@ -227,7 +510,8 @@ namespace RHI::Vulkan
             std::addressof(image),
             UniformTypeToImageUsage(type),
             view,
-            {}
+            {},
+            ToDescriptorImageInfo(&image, view, UniformTypeToImageUsage(type), nullptr)
         ));
         return mImageWriteInfos.size() - 1;
     }
@@ -238,7 +522,8 @@ namespace RHI::Vulkan
             std::addressof(image),
             UniformTypeToImageUsage(type),
             view,
-            std::addressof(sampler)
+            std::addressof(sampler),
+            ToDescriptorImageInfo(&image, view, UniformTypeToImageUsage(type), &sampler)
         ));
         return mImageWriteInfos.size() - 1;
     }
@@ -249,39 +534,246 @@ namespace RHI::Vulkan
             {},
             ImageUsage::UNKNOWN,
             {},
-            std::addressof(sampler)
+            std::addressof(sampler),
+            ToDescriptorImageInfo(nullptr, {}, ImageUsage::UNKNOWN, &sampler)
         ));
         return mImageWriteInfos.size() - 1;
     }
 
+    // 每个Set平均所需的各类型描述符数量，乘以Pool的Set数量得到Pool大小
+    // 覆盖DescriptorSetLayout可能用到的所有UniformType，内联Uniform块和加速结构需要的扩展没有启用
+    constexpr std::array<std::pair<vk::DescriptorType, float>, 11> DescriptorPoolRatios = {{
+        { vk::DescriptorType::eSampler, 0.5f },
+        { vk::DescriptorType::eCombinedImageSampler, 4.0f },
+        { vk::DescriptorType::eSampledImage, 4.0f },
+        { vk::DescriptorType::eStorageImage, 1.0f },
+        { vk::DescriptorType::eUniformTexelBuffer, 0.25f },
+        { vk::DescriptorType::eStorageTexelBuffer, 0.25f },
+        { vk::DescriptorType::eUniformBuffer, 2.0f },
+        { vk::DescriptorType::eStorageBuffer, 2.0f },
+        { vk::DescriptorType::eUniformBufferDynamic, 0.5f },
+        { vk::DescriptorType::eStorageBufferDynamic, 0.5f },
+        { vk::DescriptorType::eInputAttachment, 0.5f },
+    }};
+
+    void DescriptorAllocatorVK::Init(uint32_t setsPerPool)
+    {
+        mSetsPerPool = setsPerPool;
+        mGeneration = ++sGenerationCounter;
+        mbNullBackend = GetCurrentRenderer().IsNullBackend();
+        if (!mbNullBackend) { mPools.push_back(CreatePool(mSetsPerPool)); }
+        mCurrentPool = 0;
+    }
+
+    void DescriptorAllocatorVK::Destroy()
+    {
+        auto& device = GetCurrentRenderer().GetDevice();
+        for (auto& pool : mPools)
+        {
+            device.destroyDescriptorPool(pool);
+        }
+        mPools.clear();
+        mCurrentPool = 0;
+        mAllocatedSets = 0;
+    }
+
+    void DescriptorAllocatorVK::Reset()
+    {
+        auto& device = GetCurrentRenderer().GetDevice();
+        mPeakAllocatedSets = std::max(mPeakAllocatedSets, mAllocatedSets);
+
+        // 上一帧需要多个Pool时，合并为一个按峰值用量分配的Pool，稳定后每帧只需要重置一个Pool
+        if (mPools.size() > 1)
+        {
+            for (auto& pool : mPools)
+            {
+                device.destroyDescriptorPool(pool);
+            }
+            mPools.clear();
+            mSetsPerPool = std::max(mSetsPerPool, mPeakAllocatedSets + mPeakAllocatedSets / 2);
+            mPools.push_back(CreatePool(mSetsPerPool));
+        }
+        else
+        {
+            for (auto& pool : mPools)
+            {
+                device.resetDescriptorPool(pool);
+            }
+        }
+        mCurrentPool = 0;
+        mAllocatedSets = 0;
+        mGeneration = ++sGenerationCounter;
+    }
+
+    vk::DescriptorSet DescriptorAllocatorVK::Allocate(vk::DescriptorSetLayout layout)
+    {
+        if (mbNullBackend)
+        {
+            mAllocatedSets++;
+            return CreateNullHandle<vk::DescriptorSet>();
+        }
+
+        auto& device = GetCurrentRenderer().GetDevice();
+
+        vk::DescriptorSetAllocateInfo setAI {};
+        setAI.setDescriptorSetCount(1);
+        setAI.setPSetLayouts(&layout);
+
+        while (true)
+        {
+            bool bNewPool = mCurrentPool == mPools.size();
+            if (bNewPool) { mPools.push_back(CreatePool(mSetsPerPool)); }
+
+            vk::DescriptorSet descriptorSet;
+            setAI.setDescriptorPool(mPools[mCurrentPool]);
+            auto result = device.allocateDescriptorSets(&setAI, &descriptorSet);
+            if (result == vk::Result::eSuccess)
+            {
+                mAllocatedSets++;
+                return descriptorSet;
+            }
+            if (result != vk::Result::eErrorOutOfPoolMemory && result != vk::Result::eErrorFragmentedPool)
+            {
+                GDebugInfoCallback("Descriptor", "Failed to allocate descriptor set: " + vk::to_string(result));
+                return vk::DescriptorSet();
+            }
+            // 空Pool也放不下时说明布局超出了Pool的容量，继续创建Pool不会成功
+            if (bNewPool)
+            {
+                GDebugInfoCallback("Descriptor", "Descriptor set layout does not fit in an empty pool: " + vk::to_string(result));
+                return vk::DescriptorSet();
+            }
+            // 当前Pool已满，链接下一个Pool
+            mCurrentPool++;
+        }
+    }
+
+    vk::DescriptorPool DescriptorAllocatorVK::CreatePool(uint32_t maxSets)
+    {
+        std::array<vk::DescriptorPoolSize, DescriptorPoolRatios.size()> poolSizes {};
+        for (size_t i = 0; i < DescriptorPoolRatios.size(); i++)
+        {
+            poolSizes[i].setType(DescriptorPoolRatios[i].first);
+            poolSizes[i].setDescriptorCount(std::max(1u, uint32_t(DescriptorPoolRatios[i].second * (float)maxSets)));
+        }
+
+        vk::DescriptorPoolCreateInfo poolCI {};
+        poolCI.setMaxSets(maxSets);
+        poolCI.setPoolSizes(poolSizes);
+        return GetCurrentRenderer().GetDevice().createDescriptorPool(poolCI);
+    }
+
     void DescriptorCacheVK::Init()
     {
+        mbUseDescriptorBuffer = GetCurrentRenderer().IsDescriptorBufferEnabled();
+        mbNullBackend = GetCurrentRenderer().IsNullBackend();
+        // 描述符缓冲后端不需要DescriptorPool和DescriptorSet对象
+        if (mbUseDescriptorBuffer || mbNullBackend) { return; }
+
+        std::array<vk::DescriptorPoolSize, DescriptorPoolRatios.size()> poolSizes {};
+        for (size_t i = 0; i < DescriptorPoolRatios.size(); i++)
+        {
+            poolSizes[i].setType(DescriptorPoolRatios[i].first);
+            poolSizes[i].setDescriptorCount(uint32_t(DescriptorPoolRatios[i].second * (float)MaxCachedSets));
+        }
+
+        vk::DescriptorPoolCreateInfo poolCI {};
+        poolCI.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet);
+        poolCI.setMaxSets(MaxCachedSets);
+        poolCI.setPoolSizes(poolSizes);
+        mDescPool = GetCurrentRenderer().GetDevice().createDescriptorPool(poolCI);
     }
 
     void DescriptorCacheVK::Destroy()
     {
+        for (auto& layout : mLayouts)
+        {
+            this->DestroyDescriptorSetLayout(layout);
+        }
+        // 销毁Pool时会一并释放其中的所有DescriptorSet
+        if (mDescPool) { GetCurrentRenderer().GetDevice().destroyDescriptorPool(mDescPool); }
+
+        mDescPool = vk::DescriptorPool();
+        mDescriptor.clear();
+        mSpecifications.clear();
+        mLayouts.clear();
     }
 
     Descriptor DescriptorCacheVK::GetDescriptor(ArrayView<const ShaderUniforms> specification)
     {
-        return Descriptor();
+        vk::DescriptorSetLayout layout;
+        for (size_t i = 0; i < mSpecifications.size(); i++)
+        {
+            const auto& cached = mSpecifications[i];
+            if (std::equal(cached.begin(), cached.end(), specification.begin(), specification.end()))
+            {
+                layout = mLayouts[i];
+                break;
+            }
+        }
+        if (!layout)
+        {
+            layout = this->CreateDescriptorSetLayout(specification);
+            mSpecifications.emplace_back(specification.begin(), specification.end());
+            mLayouts.push_back(layout);
+        }
+
+        Descriptor descriptor {};
+        descriptor.DescSetLayout = layout;
+        descriptor.DescSet = mbUseDescriptorBuffer ? vk::DescriptorSet() : this->AllocateDescriptorSet(layout);
+        mDescriptor.push_back(descriptor);
+        return descriptor;
     }
 
     vk::DescriptorSetLayout DescriptorCacheVK::CreateDescriptorSetLayout(ArrayView<const ShaderUniforms> specification)
     {
-        return vk::DescriptorSetLayout();
+        std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        for (const auto& shaderUniforms : specification)
+        {
+            for (const auto& uniform : shaderUniforms.Uniforms)
+            {
+                auto it = std::find_if(bindings.begin(), bindings.end(),
+                    [&uniform](const vk::DescriptorSetLayoutBinding& binding) { return binding.binding == uniform.Binding; });
+                if (it != bindings.end())
+                {
+                    it->stageFlags |= ToNative(shaderUniforms.ShaderStage);
+                    continue;
+                }
+                bindings.push_back(vk::DescriptorSetLayoutBinding{
+                    uniform.Binding,
+                    ToNative(uniform.Type),
+                    uniform.Count,
+                    ToNative(shaderUniforms.ShaderStage)
+                });
+            }
+        }
+
+        vk::DescriptorSetLayoutCreateInfo layoutCI {};
+        layoutCI.setBindings(bindings);
+        if (mbUseDescriptorBuffer) { layoutCI.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eDescriptorBufferEXT); }
+        if (mbNullBackend) { return CreateNullHandle<vk::DescriptorSetLayout>(); }
+        return GetCurrentRenderer().GetDevice().createDescriptorSetLayout(layoutCI);
     }
 
     vk::DescriptorSet DescriptorCacheVK::AllocateDescriptorSet(vk::DescriptorSetLayout layout)
     {
-        return vk::DescriptorSet();
+        if (mbNullBackend) { return CreateNullHandle<vk::DescriptorSet>(); }
+
+        vk::DescriptorSetAllocateInfo setAI {};
+        setAI.setDescriptorPool(mDescPool);
+        setAI.setSetLayouts(layout);
+        return GetCurrentRenderer().GetDevice().allocateDescriptorSets(setAI).front();
     }
 
     void DescriptorCacheVK::DestroyDescriptorSetLayout(vk::DescriptorSetLayout layout)
     {
+        if (mbNullBackend) { return; }
+        GetCurrentRenderer().GetDevice().destroyDescriptorSetLayout(layout);
     }
 
     void DescriptorCacheVK::FreeDescriptorSet(vk::DescriptorSet set)
     {
+        if (mbNullBackend) { return; }
+        GetCurrentRenderer().GetDevice().freeDescriptorSets(mDescPool, set);
     }
-}
\ No newline at end of file
+}
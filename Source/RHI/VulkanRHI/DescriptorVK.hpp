@@ -5,42 +5,54 @@
 #include "BufferVK.hpp"
 #include "ImageVK.hpp"
 #include "SamplerVK.hpp"
+#include "DescriptorBufferVK.hpp"
 #include "ShaderReflection.hpp"
+#include "Utilities/NameID.hpp"
 
+#include <atomic>
 #include <vector>
 #include <string>
-#include <unordered_map>
 
 namespace RHI::Vulkan
 {
+    using Utilities::NameID;
+
+    // 以NameID索引的扁平资源表，Resolve时只需要数组寻址
+    // NameID只能显式构造，调用处保存static const NameID，避免每帧加锁查找注册表
     class ResolveInfo
     {
     public:
-        void Resolve(const std::string &name, const BufferVK &buffer);
-        void Resolve(const std::string &name, ArrayView<const BufferVK> buffers);
-        void Resolve(const std::string &name, ArrayView<const BufferVKReference> buffers);
+        void Resolve(NameID name, const BufferVK &buffer);
+        void Resolve(NameID name, ArrayView<const BufferVK> buffers);
+        void Resolve(NameID name, ArrayView<const BufferVKReference> buffers);
+
+        void Resolve(NameID name, const ImageVK &image);
+        void Resolve(NameID name, ArrayView<const ImageVK> images);
+        void Resolve(NameID name, ArrayView<const ImageVKReference> images);
 
-        void Resolve(const std::string &name, const ImageVK &image);
-        void Resolve(const std::string &name, ArrayView<const ImageVK> images);
-        void Resolve(const std::string &name, ArrayView<const ImageVKReference> images);
+        void Clear();
 
-        const auto & GetBuffers() const { return this->mBufferResolves; }
-        const auto & GetImages() const { return this->mImageResolves; }
+        const std::vector<BufferVKReference>& GetBuffers(NameID name) const;
+        const std::vector<ImageVKReference>& GetImages(NameID name) const;
+
+    private:
+        std::vector<BufferVKReference>& AcquireBufferSlot(NameID name);
+        std::vector<ImageVKReference>& AcquireImageSlot(NameID name);
 
     private:
-        std::unordered_map<std::string, std::vector<BufferVKReference>> mBufferResolves;
-        std::unordered_map<std::string, std::vector<ImageVKReference>> mImageResolves;
+        std::vector<std::vector<BufferVKReference>> mBufferResolves;
+        std::vector<std::vector<ImageVKReference>> mImageResolves;
     };
 
     class DescriptorBinding
     {
     public:
         // 绑定Buffer
-        DescriptorBinding& Bind(uint32_t binding, const std::string &name, UniformType type);
+        DescriptorBinding& Bind(uint32_t binding, NameID name, UniformType type);
         // 绑定Image
-        DescriptorBinding& Bind(uint32_t binding, const std::string &name, UniformType type, ImageView view);
-        DescriptorBinding& Bind(uint32_t binding, const std::string &name, const SamplerVK &sampler, UniformType type);
-        DescriptorBinding& Bind(uint32_t binding, const std::string &name, const SamplerVK &sampler, UniformType type, ImageView view);
+        DescriptorBinding& Bind(uint32_t binding, NameID name, UniformType type, ImageView view);
+        DescriptorBinding& Bind(uint32_t binding, NameID name, const SamplerVK &sampler, UniformType type);
+        DescriptorBinding& Bind(uint32_t binding, NameID name, const SamplerVK &sampler, UniformType type, ImageView view);
 
         DescriptorBinding& Bind(uint32_t binding, const SamplerVK &sampler, UniformType type);
 
@@ -48,10 +60,18 @@ namespace RHI::Vulkan
 
         // 根据Resolve信息生成WriteDesc
         void Resolve(const ResolveInfo &resolveInfo);
-        // 上传已经写入WriteDesc的信息
-        void Write(const vk::DescriptorSet &descriptorSet);
+        // 上传已经写入WriteDesc的信息，只写入相对该DescriptorSet发生变化的Binding
+        // generation为分配该Set的DescriptorAllocatorVK的代数，Pool重置后同一个句柄会被当作新的Set完整写入，长期存在的Set传0
+        void Write(const vk::DescriptorSet &descriptorSet, vk::DescriptorSetLayout layout, uint64_t generation = 0);
+        // 描述符缓冲后端：直接把描述符写入本帧分配的映射内存
+        void Write(const DescriptorBufferAllocation &allocation, vk::DescriptorSetLayout layout);
+        void DestroyUpdateTemplate();
+        // DescriptorSet被重置或重新分配后，需要完整重写
+        void Invalidate(const vk::DescriptorSet &descriptorSet);
+        void InvalidateAll() { this->mWrittenSets.clear(); }
         const auto& GetBoundBuffers() const { return this->mBufferToResolve; }
         const auto& GetBoundImages() const { return this->mImageToResolve; }
+        uint32_t GetLastWriteCount() const { return this->mLastWriteCount; }
 
     private:
         // 向对应的Resolve信息数组中加入信息，并返回索引
@@ -59,6 +79,11 @@ namespace RHI::Vulkan
         size_t AllocateBinding(const ImageVK &image, ImageView view, UniformType type);
         size_t AllocateBinding(const ImageVK &image, const SamplerVK &sampler, ImageView view, UniformType type);
         size_t AllocateBinding(const SamplerVK &sampler);
+        // 与上一次Resolve的结果比较，为变化的Binding分配新版本号
+        void UpdateWriteVersions();
+        // 为指定布局创建UpdateTemplate，之后大量Binding变化时用单次调用写入
+        void CreateUpdateTemplate(vk::DescriptorSetLayout layout);
+        void WriteWithTemplate(const vk::DescriptorSet &descriptorSet);
 
     private:
         struct DescriptorWriteInfo
@@ -67,12 +92,17 @@ namespace RHI::Vulkan
             uint32_t Binding;
             uint32_t FirstIndex;
             uint32_t Count;
+            uint32_t Version = 0;
         };
 
+        // 比较Resolve时取得的原生句柄，对象重新Init后地址不变但句柄已经变化
         struct BufferWriteInfo
         {
             const BufferVK *Handle;
             BufferUsage::Bits Usage;
+            vk::DescriptorBufferInfo Native;
+
+            bool operator==(const BufferWriteInfo& other) const { return Native == other.Native && Usage == other.Usage; }
         };
 
         struct ImageWriteInfo
@@ -81,11 +111,21 @@ namespace RHI::Vulkan
             ImageUsage::Bits Usage;
             ImageView View;
             const SamplerVK *SamplerHandle;
+            vk::DescriptorImageInfo Native;
+
+            bool operator==(const ImageWriteInfo& other) const { return Native == other.Native; }
+        };
+
+        struct WrittenSet
+        {
+            vk::DescriptorSet Set;
+            uint64_t Generation;
+            std::vector<uint32_t> Versions;
         };
 
         struct ImageToResolve
         {
-            std::string Name;
+            NameID Name;
             uint32_t Binding;
             UniformType Type;
             ImageUsage::Bits Usage;
@@ -95,7 +135,7 @@ namespace RHI::Vulkan
 
         struct BufferToResolve
         {
-            std::string Name;
+            NameID Name;
             uint32_t Binding;
             UniformType Type;
             BufferUsage::Bits Usage;
@@ -115,6 +155,23 @@ namespace RHI::Vulkan
         std::vector<ImageToResolve> mImageToResolve;
         std::vector<SamplerToResolve> mSamplerToResolve;
 
+        std::vector<DescriptorWriteInfo> mPrevDescWrites;
+        std::vector<BufferWriteInfo> mPrevBufferWriteInfos;
+        std::vector<ImageWriteInfo> mPrevImageWriteInfos;
+        std::vector<WrittenSet> mWrittenSets;
+        uint32_t mVersionCounter = 0;
+        uint32_t mLastWriteCount = 0;
+
+        // 写入时复用的临时数组，避免每帧重新分配
+        std::vector<vk::WriteDescriptorSet> mWriteDescSets;
+        std::vector<vk::DescriptorBufferInfo> mDescBufferInfos;
+        std::vector<vk::DescriptorImageInfo> mDescImageInfos;
+
+        vk::DescriptorUpdateTemplate mUpdateTemplate;
+        vk::DescriptorSetLayout mTemplateLayout;
+        std::vector<uint8_t> mTemplateData;
+        bool mbTemplateOutdated = false;
+
         ResolveOptions mOptions = ResolveOptions::RESOLVE_EACH_FRAME;
     };
 
@@ -124,6 +181,38 @@ namespace RHI::Vulkan
         vk::DescriptorSet DescSet;
     };
 
+    // 每个虚拟帧一个的临时DescriptorSet分配器，帧复用时整体重置所有Pool
+    class DescriptorAllocatorVK
+    {
+    public:
+        constexpr static uint32_t DefaultSetsPerPool = 256;
+
+        void Init(uint32_t setsPerPool = DefaultSetsPerPool);
+        void Destroy();
+        // 帧的Fence触发后调用，每个Pool只调用一次vkResetDescriptorPool
+        void Reset();
+        vk::DescriptorSet Allocate(vk::DescriptorSetLayout layout);
+
+        // 每次重置后变化，并且在所有分配器之间唯一，用于判断DescriptorBinding记录的写入是否仍然有效
+        uint64_t GetGeneration() const { return mGeneration; }
+        uint32_t GetAllocatedSetCount() const { return mAllocatedSets; }
+        size_t GetPoolCount() const { return mPools.size(); }
+
+    private:
+        vk::DescriptorPool CreatePool(uint32_t maxSets);
+
+    private:
+        std::vector<vk::DescriptorPool> mPools;
+        size_t mCurrentPool = 0;
+        uint32_t mSetsPerPool = DefaultSetsPerPool;
+        uint32_t mAllocatedSets = 0;
+        uint32_t mPeakAllocatedSets = 0;
+        uint64_t mGeneration = 0;
+        bool mbNullBackend = false;
+
+        inline static std::atomic<uint64_t> sGenerationCounter { 0 };
+    };
+
     class DescriptorCacheVK
     {
     public:
@@ -132,6 +221,8 @@ namespace RHI::Vulkan
         const auto& GetDescriptorPool() const { return mDescPool; }
         Descriptor GetDescriptor(ArrayView<const ShaderUniforms> specification);
 
+        bool IsUsingDescriptorBuffer() const { return mbUseDescriptorBuffer; }
+
     private:
         vk::DescriptorSetLayout CreateDescriptorSetLayout(ArrayView<const ShaderUniforms> specification);
         vk::DescriptorSet AllocateDescriptorSet(vk::DescriptorSetLayout layout);
@@ -139,7 +230,13 @@ namespace RHI::Vulkan
         void FreeDescriptorSet(vk::DescriptorSet set);
 
     private:
+        constexpr static uint32_t MaxCachedSets = 1024;
+
         vk::DescriptorPool mDescPool;
         std::vector<Descriptor> mDescriptor;
+        std::vector<std::vector<ShaderUniforms>> mSpecifications;
+        std::vector<vk::DescriptorSetLayout> mLayouts;
+        bool mbUseDescriptorBuffer = false;
+        bool mbNullBackend = false;
     };
 }
\ No newline at end of file
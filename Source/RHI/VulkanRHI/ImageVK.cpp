@@ -0,0 +1,360 @@
+#include "ImageVK.hpp"
+#include "CommonVK.hpp"
+#include "ShaderReflection.hpp"
+#include "NullBackendVK.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+
+namespace RHI::Vulkan
+{
+    ImageVK::ImageVK(uint32_t width, uint32_t height, Format format, ImageUsage::Value usage, MemoryUsage memoryUsage, ImageOptions::Value options)
+    {
+        this->Init(width, height, format, usage, memoryUsage, options);
+    }
+
+    ImageVK::ImageVK(vk::Image image, uint32_t width, uint32_t height, Format format)
+    {
+        this->mImage = image;
+        this->mExtent = vk::Extent2D{ width, height };
+        this->mFormat = format;
+        this->InitViews(image, format);
+        this->ResetSubresourceUsage();
+    }
+
+    ImageVK::ImageVK(ImageVK &&other) noexcept
+    {
+        this->mImage = other.mImage;
+        this->mImageViews = other.mImageViews;
+        this->mCubeImageViews = std::move(other.mCubeImageViews);
+        this->mMipViews = std::move(other.mMipViews);
+        this->mExtent = other.mExtent;
+        this->mMipLevelCount = other.mMipLevelCount;
+        this->mLayerCount = other.mLayerCount;
+        this->mFormat = other.mFormat;
+        this->mAllocation = other.mAllocation;
+        this->mUsage = other.mUsage;
+        this->mbAliased = other.mbAliased;
+        this->mSampledIndex = other.mSampledIndex;
+        this->mStorageIndex = other.mStorageIndex;
+        this->mSubresourceUsages = std::move(other.mSubresourceUsages);
+
+        other.mImage = vk::Image();
+        other.mImageViews = { };
+        other.mExtent = vk::Extent2D{ 0u, 0u };
+        other.mMipLevelCount = 1;
+        other.mLayerCount = 1;
+        other.mFormat = Format::UNDEFINED;
+        other.mAllocation = { };
+        other.mUsage = ImageUsage::UNKNOWN;
+        other.mbAliased = false;
+        other.mSampledIndex = InvalidBindlessIndex;
+        other.mStorageIndex = InvalidBindlessIndex;
+    }
+
+    ImageVK &ImageVK::operator=(ImageVK &&other) noexcept
+    {
+        this->Destroy();
+
+        this->mImage = other.mImage;
+        this->mImageViews = other.mImageViews;
+        this->mCubeImageViews = std::move(other.mCubeImageViews);
+        this->mMipViews = std::move(other.mMipViews);
+        this->mExtent = other.mExtent;
+        this->mMipLevelCount = other.mMipLevelCount;
+        this->mLayerCount = other.mLayerCount;
+        this->mFormat = other.mFormat;
+        this->mAllocation = other.mAllocation;
+        this->mUsage = other.mUsage;
+        this->mbAliased = other.mbAliased;
+        this->mSampledIndex = other.mSampledIndex;
+        this->mStorageIndex = other.mStorageIndex;
+        this->mSubresourceUsages = std::move(other.mSubresourceUsages);
+
+        other.mImage = vk::Image();
+        other.mImageViews = { };
+        other.mExtent = vk::Extent2D{ 0u, 0u };
+        other.mMipLevelCount = 1;
+        other.mLayerCount = 1;
+        other.mFormat = Format::UNDEFINED;
+        other.mAllocation = { };
+        other.mUsage = ImageUsage::UNKNOWN;
+        other.mbAliased = false;
+        other.mSampledIndex = InvalidBindlessIndex;
+        other.mStorageIndex = InvalidBindlessIndex;
+
+        return *this;
+    }
+
+    ImageVK::~ImageVK()
+    {
+        this->Destroy();
+    }
+
+    void ImageVK::Init(uint32_t width, uint32_t height, Format format, ImageUsage::Value usage, MemoryUsage memoryUsage, ImageOptions::Value options)
+    {
+        this->Destroy();
+
+        auto imageCI = this->SetupImage(width, height, format, usage, options);
+        this->mAllocation = AllocateImage(imageCI, memoryUsage, &this->mImage);
+        this->InitViews(this->mImage, format);
+        this->ResetSubresourceUsage();
+        this->RegisterBindless();
+    }
+
+    vk::MemoryRequirements ImageVK::InitUnbound(uint32_t width, uint32_t height, Format format, ImageUsage::Value usage, ImageOptions::Value options)
+    {
+        this->Destroy();
+
+        auto imageCI = this->SetupImage(width, height, format, usage, options);
+        this->mbAliased = true;
+
+        auto& renderer = GetCurrentRenderer();
+        if (renderer.IsNullBackend())
+        {
+            // 空后端没有真实的内存需求，按每像素16字节估算，只用于别名规划的统计
+            this->mImage = CreateNullHandle<vk::Image>();
+            vk::MemoryRequirements requirements {};
+            requirements.setSize((vk::DeviceSize)width * height * this->mLayerCount * 16);
+            requirements.setAlignment(64 * 1024);
+            requirements.setMemoryTypeBits(~0u);
+            return requirements;
+        }
+
+        this->mImage = renderer.GetDevice().createImage(imageCI);
+        return renderer.GetDevice().getImageMemoryRequirements(this->mImage);
+    }
+
+    void ImageVK::BindMemory(VmaAllocation memory, uint64_t offset)
+    {
+        assert(this->mbAliased && !this->mImageViews.NativeView);
+        BindImageMemory(this->mImage, memory, offset);
+        this->InitViews(this->mImage, this->mFormat);
+        this->ResetSubresourceUsage();
+        this->RegisterBindless();
+    }
+
+    vk::ImageCreateInfo ImageVK::SetupImage(uint32_t width, uint32_t height, Format format, ImageUsage::Value usage, ImageOptions::Value options)
+    {
+        this->mExtent = vk::Extent2D{ width, height };
+        this->mFormat = format;
+        this->mUsage = usage;
+        this->mMipLevelCount = CalculateImageMipLevelCount(options, width, height);
+        this->mLayerCount = CalculateImageLayerCount(options);
+
+        vk::ImageCreateInfo imageCI {};
+        imageCI.setImageType(vk::ImageType::e2D);
+        imageCI.setFormat(ToNative(format));
+        imageCI.setExtent(vk::Extent3D{ width, height, 1 });
+        imageCI.setSamples(vk::SampleCountFlagBits::e1);
+        imageCI.setMipLevels(this->mMipLevelCount);
+        imageCI.setArrayLayers(this->mLayerCount);
+        imageCI.setTiling(vk::ImageTiling::eOptimal);
+        imageCI.setUsage((vk::ImageUsageFlags)usage);
+        imageCI.setSharingMode(vk::SharingMode::eExclusive);
+        imageCI.setInitialLayout(vk::ImageLayout::eUndefined);
+        if (options & ImageOptions::CUBEMAP) { imageCI.setFlags(vk::ImageCreateFlagBits::eCubeCompatible); }
+        return imageCI;
+    }
+
+    void ImageVK::RegisterBindless()
+    {
+        auto& bindlessHeap = GetCurrentRenderer().GetBindlessHeap();
+        // 采样描述符只能有一个aspect，深度和深度模板格式只采样深度
+        ImageView sampledView = (ImageFormatToImageAspect(this->mFormat) & vk::ImageAspectFlagBits::eDepth) ? ImageView::DEPTH_ONLY : ImageView::NATIVE;
+        if (this->mUsage & ImageUsage::SHADER_READ) { this->mSampledIndex = bindlessHeap.RegisterSampledImage(*this, sampledView); }
+        if (this->mUsage & ImageUsage::STORAGE) { this->mStorageIndex = bindlessHeap.RegisterStorageImage(*this); }
+    }
+
+    ImageUsage::Bits ImageVK::GetSubresourceUsage(uint32_t mipLevel, uint32_t layer) const
+    {
+        assert(mipLevel < this->mMipLevelCount && layer < this->mLayerCount);
+        return this->mSubresourceUsages[layer * this->mMipLevelCount + mipLevel];
+    }
+
+    void ImageVK::SetSubresourceUsage(ImageUsage::Bits usage, uint32_t baseMipLevel, uint32_t mipLevelCount, uint32_t baseLayer, uint32_t layerCount) const
+    {
+        assert(baseMipLevel + mipLevelCount <= this->mMipLevelCount && baseLayer + layerCount <= this->mLayerCount);
+        for (uint32_t layer = baseLayer; layer < baseLayer + layerCount; layer++)
+        {
+            auto first = this->mSubresourceUsages.begin() + layer * this->mMipLevelCount + baseMipLevel;
+            std::fill(first, first + mipLevelCount, usage);
+        }
+    }
+
+    void ImageVK::ResetSubresourceUsage(ImageUsage::Bits usage) const
+    {
+        this->mSubresourceUsages.assign(this->mMipLevelCount * this->mLayerCount, usage);
+    }
+
+    vk::ImageView ImageVK::GetNativeView(ImageView view) const
+    {
+        switch (view)
+        {
+        case ImageView::NATIVE:
+            return this->mImageViews.NativeView;
+        case ImageView::DEPTH_ONLY:
+            return this->mImageViews.DepthOnlyView;
+        case ImageView::STENCIL_ONLY:
+            return this->mImageViews.StencilOnlyView;
+        default:
+            assert(false);
+            return this->mImageViews.NativeView;
+        }
+    }
+
+    vk::ImageView ImageVK::GetNativeView(ImageView view, uint32_t layer) const
+    {
+        if (this->mCubeImageViews.empty()) { return this->GetNativeView(view); }
+
+        assert(layer < this->mCubeImageViews.size());
+        const auto& views = this->mCubeImageViews[layer];
+        switch (view)
+        {
+        case ImageView::NATIVE:
+            return views.NativeView;
+        case ImageView::DEPTH_ONLY:
+            return views.DepthOnlyView;
+        case ImageView::STENCIL_ONLY:
+            return views.StencilOnlyView;
+        default:
+            assert(false);
+            return views.NativeView;
+        }
+    }
+
+    vk::ImageView ImageVK::GetMipView(uint32_t mipLevel) const
+    {
+        assert(mipLevel < this->mMipViews.size());
+        return this->mMipViews[mipLevel];
+    }
+
+    uint32_t ImageVK::GetMipLevelWidth(uint32_t mipLevel) const
+    {
+        return std::max(this->mExtent.width >> mipLevel, 1u);
+    }
+
+    uint32_t ImageVK::GetMipLevelHeight(uint32_t mipLevel) const
+    {
+        return std::max(this->mExtent.height >> mipLevel, 1u);
+    }
+
+    void ImageVK::Destroy()
+    {
+        if (!this->mImage) { return; }
+
+        auto& renderer = GetCurrentRenderer();
+        auto& device = renderer.GetDevice();
+        bool nullBackend = renderer.IsNullBackend();
+
+        renderer.GetBindlessHeap().Release(BindlessHeapVK::Table::SAMPLED_IMAGE, this->mSampledIndex);
+        renderer.GetBindlessHeap().Release(BindlessHeapVK::Table::STORAGE_IMAGE, this->mStorageIndex);
+        this->mSampledIndex = InvalidBindlessIndex;
+        this->mStorageIndex = InvalidBindlessIndex;
+
+        auto destroyView = [&device, nullBackend](vk::ImageView view)
+        {
+            if (view && !nullBackend) { device.destroyImageView(view); }
+        };
+        auto destroyViews = [&destroyView](ImageViews& views)
+        {
+            destroyView(views.NativeView);
+            destroyView(views.DepthOnlyView);
+            destroyView(views.StencilOnlyView);
+            views = { };
+        };
+
+        destroyViews(this->mImageViews);
+        for (auto& views : this->mCubeImageViews) { destroyViews(views); }
+        this->mCubeImageViews.clear();
+        for (auto& view : this->mMipViews) { destroyView(view); }
+        this->mMipViews.clear();
+
+        // 交换链图像没有分配信息，由交换链负责销毁；别名图像只销毁图像本身，共享内存由分配者释放
+        if (this->mbAliased)
+        {
+            if (!nullBackend) { device.destroyImage(this->mImage); }
+        }
+        else if (this->mAllocation != VK_NULL_HANDLE)
+        {
+            DeallocateImage(this->mImage, this->mAllocation);
+        }
+        this->mImage = vk::Image();
+        this->mAllocation = { };
+        this->mUsage = ImageUsage::UNKNOWN;
+        this->mbAliased = false;
+    }
+
+    void ImageVK::InitViews(const vk::Image &image, Format format)
+    {
+        auto& device = GetCurrentRenderer().GetDevice();
+        bool nullBackend = GetCurrentRenderer().IsNullBackend();
+        auto createView = [&device, nullBackend](const vk::ImageViewCreateInfo& viewCI)
+        {
+            return nullBackend ? CreateNullHandle<vk::ImageView>() : device.createImageView(viewCI);
+        };
+
+        auto subresourceRange = GetDefaultImageSubresourceRange(*this);
+        auto nativeAspect = subresourceRange.aspectMask;
+
+        vk::ImageViewCreateInfo viewCI {};
+        viewCI.setImage(image);
+        viewCI.setViewType(GetImageViewType(*this));
+        viewCI.setFormat(ToNative(format));
+        viewCI.setComponents(vk::ComponentMapping{
+            vk::ComponentSwizzle::eIdentity,
+            vk::ComponentSwizzle::eIdentity,
+            vk::ComponentSwizzle::eIdentity,
+            vk::ComponentSwizzle::eIdentity
+        });
+
+        auto createViews = [&](ImageViews& views, vk::ImageSubresourceRange range)
+        {
+            viewCI.setSubresourceRange(range);
+            views.NativeView = createView(viewCI);
+
+            if (nativeAspect & vk::ImageAspectFlagBits::eDepth)
+            {
+                range.setAspectMask(vk::ImageAspectFlagBits::eDepth);
+                viewCI.setSubresourceRange(range);
+                views.DepthOnlyView = createView(viewCI);
+            }
+            if (nativeAspect & vk::ImageAspectFlagBits::eStencil)
+            {
+                range.setAspectMask(vk::ImageAspectFlagBits::eStencil);
+                viewCI.setSubresourceRange(range);
+                views.StencilOnlyView = createView(viewCI);
+            }
+        };
+
+        createViews(this->mImageViews, subresourceRange);
+
+        if (this->mLayerCount > 1)
+        {
+            viewCI.setViewType(vk::ImageViewType::e2D);
+            this->mCubeImageViews.resize(this->mLayerCount);
+            for (uint32_t layer = 0; layer < this->mLayerCount; layer++)
+            {
+                auto layerRange = subresourceRange;
+                layerRange.setBaseArrayLayer(layer);
+                layerRange.setLayerCount(1);
+                createViews(this->mCubeImageViews[layer], layerRange);
+            }
+        }
+
+        // 单mip视图统一为2D数组，深度模板图像只能包含一个aspect
+        auto mipRange = subresourceRange;
+        if (nativeAspect & vk::ImageAspectFlagBits::eDepth) { mipRange.setAspectMask(vk::ImageAspectFlagBits::eDepth); }
+        mipRange.setLevelCount(1);
+
+        viewCI.setViewType(vk::ImageViewType::e2DArray);
+        this->mMipViews.resize(this->mMipLevelCount);
+        for (uint32_t mip = 0; mip < this->mMipLevelCount; mip++)
+        {
+            mipRange.setBaseMipLevel(mip);
+            viewCI.setSubresourceRange(mipRange);
+            this->mMipViews[mip] = createView(viewCI);
+        }
+    }
+}
@@ -2,6 +2,7 @@
 
 #include "RHI/RHICommon.hpp"
 #include "MemoryAllocatorVK.hpp"
+#include "BindlessVK.hpp"
 
 #include <cstdint>
 #include <string>
@@ -21,22 +22,38 @@ namespace RHI::Vulkan
         virtual ~ImageVK();
 
         void Init(uint32_t width, uint32_t height, Format format, ImageUsage::Value usage, MemoryUsage memoryUsage, ImageOptions::Value options);
+        // 只创建图像不分配内存，返回内存需求，之后通过BindMemory绑定到共享内存的某个偏移
+        // 生命周期不重叠的图像可以绑定到同一段内存上，内存的释放由分配者负责
+        vk::MemoryRequirements InitUnbound(uint32_t width, uint32_t height, Format format, ImageUsage::Value usage, ImageOptions::Value options);
+        void BindMemory(VmaAllocation memory, uint64_t offset);
 
         vk::ImageView GetNativeView(ImageView view) const;
         vk::ImageView GetNativeView(ImageView view, uint32_t layer) const;
+        // 只包含单个mip、覆盖全部layer的2D数组视图，供逐mip读写的计算着色器使用
+        vk::ImageView GetMipView(uint32_t mipLevel) const;
         uint32_t GetMipLevelWidth(uint32_t mipLevel) const;
         uint32_t GetMipLevelHeight(uint32_t mipLevel) const;
 
         vk::Image GetNativeImage() const { return mImage; }
+        bool IsAliased() const { return mbAliased; }
         Format GetFormat() const { return mFormat; }
         uint32_t GetWidth() const { return mExtent.width; }
         uint32_t GetHeight() const { return mExtent.height; }
         uint32_t GetMipLevelCount() const { return mMipLevelCount; }
         uint32_t GetLayerCount() const { return mLayerCount; }
+        BindlessIndex GetSampledIndex() const { return mSampledIndex; }
+        BindlessIndex GetStorageIndex() const { return mStorageIndex; }
+
+        // 每个(mip, layer)子资源当前的用途，按录制顺序由CommandBufferVK维护
+        ImageUsage::Bits GetSubresourceUsage(uint32_t mipLevel, uint32_t layer) const;
+        void SetSubresourceUsage(ImageUsage::Bits usage, uint32_t baseMipLevel, uint32_t mipLevelCount, uint32_t baseLayer, uint32_t layerCount) const;
+        void ResetSubresourceUsage(ImageUsage::Bits usage = ImageUsage::UNKNOWN) const;
 
     private:
         void Destroy();
+        vk::ImageCreateInfo SetupImage(uint32_t width, uint32_t height, Format format, ImageUsage::Value usage, ImageOptions::Value options);
         void InitViews(const vk::Image& image, Format format);
+        void RegisterBindless();
 
     private:
         struct ImageViews
@@ -49,11 +66,17 @@ namespace RHI::Vulkan
         vk::Image mImage;
         ImageViews mImageViews;
         std::vector<ImageViews> mCubeImageViews;
+        std::vector<vk::ImageView> mMipViews;
         vk::Extent2D mExtent = {0u, 0u};
         uint32_t mMipLevelCount = 1;
         uint32_t mLayerCount = 1;
         Format mFormat = Format::UNDEFINED;
         VmaAllocation mAllocation = VK_NULL_HANDLE;
+        ImageUsage::Value mUsage = ImageUsage::UNKNOWN;
+        bool mbAliased = false;
+        BindlessIndex mSampledIndex = InvalidBindlessIndex;
+        BindlessIndex mStorageIndex = InvalidBindlessIndex;
+        mutable std::vector<ImageUsage::Bits> mSubresourceUsages;
     };
 
     using ImageVKReference = std::reference_wrapper<const ImageVK>;
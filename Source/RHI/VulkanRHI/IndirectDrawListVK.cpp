@@ -0,0 +1,65 @@
+#include "IndirectDrawListVK.hpp"
+
+namespace RHI::Vulkan
+{
+    void IndirectDrawListVK::Init(uint32_t maxDrawCount)
+    {
+        mMaxDrawCount = maxDrawCount;
+        size_t byteSize = this->GetDrawOffset() + maxDrawCount * sizeof(vk::DrawIndirectCommand);
+        // STORAGE_BUFFER用途允许之后由计算着色器直接生成或剔除绘制参数
+        mBuffer.Init(byteSize, BufferUsage::INDIRECT_BUFFER | BufferUsage::TRANSFER_DESTINATION | BufferUsage::STORAGE_BUFFER, MemoryUsage::GPUOnly);
+        mDraws.reserve(maxDrawCount);
+        mIndexedDraws.reserve(maxDrawCount);
+    }
+
+    void IndirectDrawListVK::Destroy()
+    {
+        mBuffer = BufferVK();
+        mDraws.clear();
+        mIndexedDraws.clear();
+        mMaxDrawCount = 0;
+    }
+
+    void IndirectDrawListVK::Clear()
+    {
+        mDraws.clear();
+        mIndexedDraws.clear();
+    }
+
+    void IndirectDrawListVK::AddDraw(const vk::DrawIndirectCommand &draw)
+    {
+        assert(mDraws.size() < mMaxDrawCount);
+        mDraws.push_back(draw);
+    }
+
+    void IndirectDrawListVK::AddIndexedDraw(const vk::DrawIndexedIndirectCommand &draw)
+    {
+        assert(mIndexedDraws.size() < mMaxDrawCount);
+        mIndexedDraws.push_back(draw);
+    }
+
+    void IndirectDrawListVK::Upload(CommandBufferVK &commands, StageBufferVK &stageBuffer)
+    {
+        if (!mIndexedDraws.empty())
+        {
+            auto allocation = stageBuffer.Submit(ArrayView<const vk::DrawIndexedIndirectCommand>(mIndexedDraws));
+            commands.CopyBuffer(BufferInfo{ stageBuffer.GetBuffer(), allocation.Offset }, BufferInfo{ mBuffer, 0 }, allocation.Size);
+        }
+        if (!mDraws.empty())
+        {
+            auto allocation = stageBuffer.Submit(ArrayView<const vk::DrawIndirectCommand>(mDraws));
+            commands.CopyBuffer(BufferInfo{ stageBuffer.GetBuffer(), allocation.Offset }, BufferInfo{ mBuffer, (uint32_t)this->GetDrawOffset() }, allocation.Size);
+        }
+        commands.TransitionBuffer(mBuffer, BufferUsage::INDIRECT_BUFFER);
+    }
+
+    void IndirectDrawListVK::Draw(CommandBufferVK &commands) const
+    {
+        commands.DrawIndirect(mBuffer, this->GetDrawOffset(), this->GetDrawCount());
+    }
+
+    void IndirectDrawListVK::DrawIndexed(CommandBufferVK &commands) const
+    {
+        commands.DrawIndexedIndirect(mBuffer, 0, this->GetIndexedDrawCount());
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+#include "BufferVK.hpp"
+#include "CommandBufferVK.hpp"
+
+#include <vector>
+
+namespace RHI::Vulkan
+{
+    // CPU生成的绘制列表，每帧通过暂存缓冲上传到GPU上的间接参数缓冲，再用一次间接调用提交
+    // 缓冲中先存放带索引的绘制，之后是不带索引的绘制
+    class IndirectDrawListVK
+    {
+    public:
+        void Init(uint32_t maxDrawCount);
+        void Destroy();
+
+        void Clear();
+        // firstInstance可以作为绘制索引在着色器中读取每个绘制的数据
+        void AddDraw(const vk::DrawIndirectCommand& draw);
+        void AddIndexedDraw(const vk::DrawIndexedIndirectCommand& draw);
+
+        // 需要在BeginPass之前调用，上传后缓冲转换到INDIRECT_BUFFER，Draw/DrawIndexed不再插入屏障
+        void Upload(CommandBufferVK& commands, StageBufferVK& stageBuffer);
+        void Draw(CommandBufferVK& commands) const;
+        void DrawIndexed(CommandBufferVK& commands) const;
+
+        const BufferVK& GetBuffer() const { return mBuffer; }
+        uint32_t GetDrawCount() const { return (uint32_t)mDraws.size(); }
+        uint32_t GetIndexedDrawCount() const { return (uint32_t)mIndexedDraws.size(); }
+        uint32_t GetMaxDrawCount() const { return mMaxDrawCount; }
+
+    private:
+        size_t GetDrawOffset() const { return mMaxDrawCount * sizeof(vk::DrawIndexedIndirectCommand); }
+
+    private:
+        BufferVK mBuffer;
+        std::vector<vk::DrawIndirectCommand> mDraws;
+        std::vector<vk::DrawIndexedIndirectCommand> mIndexedDraws;
+        uint32_t mMaxDrawCount = 0;
+    };
+}
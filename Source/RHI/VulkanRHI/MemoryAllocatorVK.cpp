@@ -3,6 +3,7 @@
 #define VMA_IMPLEMENTATION
 #include <vma/vk_mem_alloc.h>
 
+#include "NullBackendVK.hpp"
 #include "Renderer/RendererBase.hpp"
 
 namespace RHI::Vulkan
@@ -20,6 +21,13 @@ namespace RHI::Vulkan
         return mappingTable[(size_t)usage];
     }
 
+    // 空后端中CPU可见的内存用普通堆内存模拟，分配信息直接指向这块内存，GPU专用内存不分配
+    static VmaAllocation AllocateNullMemory(MemoryUsage usage, size_t byteSize)
+    {
+        if (usage == MemoryUsage::GPUOnly || usage == MemoryUsage::GPULazyAllocated) { return VK_NULL_HANDLE; }
+        return (VmaAllocation)new uint8_t[byteSize];
+    }
+
     VmaAllocator GetVulkanAllocator()
     {
         return GetCurrentRenderer().GetAllocator();
@@ -27,16 +35,33 @@ namespace RHI::Vulkan
 
     void DeallocateImage(const vk::Image& image, VmaAllocation allocation)
     {
+        if (IsNullBackend())
+        {
+            delete[] (uint8_t*)allocation;
+            return;
+        }
         vmaDestroyImage(GetVulkanAllocator(), image, allocation);
     }
 
     void DeallocateBuffer(const vk::Buffer& buffer, VmaAllocation allocation)
     {
+        if (IsNullBackend())
+        {
+            delete[] (uint8_t*)allocation;
+            return;
+        }
         vmaDestroyBuffer(GetVulkanAllocator(), buffer, allocation);
     }
 
     VmaAllocation AllocateImage(const vk::ImageCreateInfo& imageCreateInfo, MemoryUsage usage, vk::Image* image)
     {
+        if (IsNullBackend())
+        {
+            // 图像内存不会被CPU直接访问
+            *image = CreateNullHandle<vk::Image>();
+            return VK_NULL_HANDLE;
+        }
+
         VmaAllocation allocation = { };
         VmaAllocationCreateInfo allocationInfo = { };
         allocationInfo.usage = MemoryUsageToNative(usage);
@@ -46,6 +71,12 @@ namespace RHI::Vulkan
 
     VmaAllocation AllocateBuffer(const vk::BufferCreateInfo& bufferCreateInfo, MemoryUsage usage, vk::Buffer* buffer)
     {
+        if (IsNullBackend())
+        {
+            *buffer = CreateNullHandle<vk::Buffer>();
+            return AllocateNullMemory(usage, bufferCreateInfo.size);
+        }
+
         VmaAllocation allocation = { };
         VmaAllocationCreateInfo allocationInfo = { };
         allocationInfo.usage = MemoryUsageToNative(usage);
@@ -53,8 +84,49 @@ namespace RHI::Vulkan
         return allocation;
     }
 
+    VmaAllocation AllocateMemory(const vk::MemoryRequirements& requirements, MemoryUsage usage)
+    {
+        if (IsNullBackend()) { return AllocateNullMemory(usage, requirements.size); }
+
+        VmaAllocation allocation = { };
+        VmaAllocationCreateInfo allocationInfo = { };
+        allocationInfo.usage = MemoryUsageToNative(usage);
+        (void)vmaAllocateMemory(GetVulkanAllocator(), (const VkMemoryRequirements*)&requirements, &allocationInfo, &allocation, nullptr);
+        return allocation;
+    }
+
+    void DeallocateMemory(VmaAllocation allocation)
+    {
+        if (IsNullBackend())
+        {
+            delete[] (uint8_t*)allocation;
+            return;
+        }
+        if (allocation != VK_NULL_HANDLE) { vmaFreeMemory(GetVulkanAllocator(), allocation); }
+    }
+
+    void BindImageMemory(const vk::Image& image, VmaAllocation allocation, uint64_t offset)
+    {
+        if (IsNullBackend()) { return; }
+        (void)vmaBindImageMemory2(GetVulkanAllocator(), allocation, offset, image, nullptr);
+    }
+
+    bool IsLazilyAllocatedMemorySupported()
+    {
+        if (IsNullBackend()) { return false; }
+
+        auto properties = GetCurrentRenderer().GetPhysicalDevice().getMemoryProperties();
+        for (uint32_t typeIndex = 0; typeIndex < properties.memoryTypeCount; typeIndex++)
+        {
+            if (properties.memoryTypes[typeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated) { return true; }
+        }
+        return false;
+    }
+
     uint8_t* MapMemory(VmaAllocation allocation)
     {
+        if (IsNullBackend()) { return (uint8_t*)allocation; }
+
         void* memory = nullptr;
         vmaMapMemory(GetVulkanAllocator(), allocation, &memory);
         return (uint8_t*)memory;
@@ -62,11 +134,13 @@ namespace RHI::Vulkan
 
     void UnmapMemory(VmaAllocation allocation)
     {
+        if (IsNullBackend()) { return; }
         vmaUnmapMemory(GetVulkanAllocator(), allocation);
     }
 
     void FlushMemory(VmaAllocation allocation, size_t byteSize, size_t offset)
     {
+        if (IsNullBackend()) { return; }
         vmaFlushAllocation(GetVulkanAllocator(), allocation, offset, byteSize);
     }
 }
\ No newline at end of file
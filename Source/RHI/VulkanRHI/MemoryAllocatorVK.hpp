@@ -16,6 +16,7 @@ namespace vk
     class Buffer;
     struct ImageCreateInfo;
     struct BufferCreateInfo;
+    struct MemoryRequirements;
 }
 
 namespace Renderer
@@ -30,6 +31,12 @@ namespace RHI::Vulkan
     void DeallocateBuffer(const vk::Buffer& buffer, VmaAllocation allocation);
     VmaAllocation AllocateImage(const vk::ImageCreateInfo& imageCreateInfo, MemoryUsage usage, vk::Image* image);
     VmaAllocation AllocateBuffer(const vk::BufferCreateInfo& bufferCreateInfo, MemoryUsage usage, vk::Buffer* buffer);
+    // 不绑定任何资源的内存块，资源通过BindImageMemory绑定到其中的偏移，用于RenderGraph的瞬态资源别名
+    VmaAllocation AllocateMemory(const vk::MemoryRequirements& requirements, MemoryUsage usage);
+    void DeallocateMemory(VmaAllocation allocation);
+    void BindImageMemory(const vk::Image& image, VmaAllocation allocation, uint64_t offset);
+    // 存在惰性分配的内存类型时(通常是移动端的tile-based GPU)，只在渲染通道内使用的附件可以不占用实际内存
+    bool IsLazilyAllocatedMemorySupported();
     uint8_t* MapMemory(VmaAllocation allocation);
     void UnmapMemory(VmaAllocation allocation);
     void FlushMemory(VmaAllocation allocation, size_t byteSize, size_t offset);
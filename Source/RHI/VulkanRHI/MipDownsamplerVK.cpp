@@ -0,0 +1,166 @@
+#include "MipDownsamplerVK.hpp"
+
+#include "NullBackendVK.hpp"
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+
+namespace RHI::Vulkan
+{
+    void MipDownsamplerVK::Init(const ComputeShaderVK &shader)
+    {
+        this->Destroy();
+
+        auto& renderer = GetCurrentRenderer();
+        auto& device = renderer.GetDevice();
+
+        // 着色器读写不带格式的存储图像，设备不支持时原地的平均值归约退回到逐级Blit
+        const auto& features = renderer.GetEnabledFeatures();
+        mbSupported = renderer.IsNullBackend() || (features.shaderStorageImageReadWithoutFormat && features.shaderStorageImageWriteWithoutFormat);
+        if (!mbSupported)
+        {
+            GDebugInfoCallback("MipDownsampler", "Storage images without format are not supported, falling back to blit");
+            return;
+        }
+
+        std::array<vk::DescriptorSetLayoutBinding, 4> bindings {};
+        bindings[0].setBinding(0).setDescriptorType(vk::DescriptorType::eCombinedImageSampler).setDescriptorCount(1).setStageFlags(vk::ShaderStageFlagBits::eCompute);
+        bindings[1].setBinding(1).setDescriptorType(vk::DescriptorType::eStorageImage).setDescriptorCount(MaxOutputMips).setStageFlags(vk::ShaderStageFlagBits::eCompute);
+        bindings[2].setBinding(2).setDescriptorType(vk::DescriptorType::eStorageImage).setDescriptorCount(1).setStageFlags(vk::ShaderStageFlagBits::eCompute);
+        bindings[3].setBinding(3).setDescriptorType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(1).setStageFlags(vk::ShaderStageFlagBits::eCompute);
+
+        vk::DescriptorSetLayoutCreateInfo setLayoutCI {};
+        setLayoutCI.setBindings(bindings);
+        mSetLayout = CreateDeviceObject<vk::DescriptorSetLayout>([&]() { return device.createDescriptorSetLayout(setLayoutCI); });
+
+        vk::PushConstantRange pushConstantRange {};
+        pushConstantRange.setStageFlags(vk::ShaderStageFlagBits::eCompute);
+        pushConstantRange.setOffset(0);
+        pushConstantRange.setSize(sizeof(PushConstants));
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutCI {};
+        pipelineLayoutCI.setSetLayouts(mSetLayout);
+        pipelineLayoutCI.setPushConstantRanges(pushConstantRange);
+        mPipelineLayout = CreateDeviceObject<vk::PipelineLayout>([&]() { return device.createPipelineLayout(pipelineLayoutCI); });
+
+        // 归约方式作为特化常量，每种方式一条管线，由PipelineCacheVK持有
+        for (uint32_t i = 0; i < (uint32_t)Reduction::Count; i++)
+        {
+            ComputePipelineDesc pipelineDesc {};
+            pipelineDesc.ComputeShader = shader.GetNativeShaderModule();
+            pipelineDesc.Layout = mPipelineLayout;
+            pipelineDesc.SpecializationConstants = { i };
+            mPipelines[i] = renderer.GetPipelineCache().Acquire(pipelineDesc);
+        }
+
+        mCounterBuffer.Init(MaxLayers * sizeof(uint32_t), BufferUsage::STORAGE_BUFFER | BufferUsage::TRANSFER_DESTINATION, MemoryUsage::GPUOnly);
+        mbCountersCleared = false;
+
+        SamplerVK::Desc samplerDesc {};
+        samplerDesc.Min = SamplerVK::Filter::NEAREST;
+        samplerDesc.Mag = SamplerVK::Filter::NEAREST;
+        samplerDesc.Mip = SamplerVK::Filter::NEAREST;
+        samplerDesc.AddressU = SamplerVK::AddressMode::CLAMP_TO_EDGE;
+        samplerDesc.AddressV = SamplerVK::AddressMode::CLAMP_TO_EDGE;
+        samplerDesc.AddressW = SamplerVK::AddressMode::CLAMP_TO_EDGE;
+        mSampler = renderer.GetSamplerCache().Acquire(samplerDesc);
+    }
+
+    void MipDownsamplerVK::Destroy()
+    {
+        if (!mPipelineLayout) { return; }
+
+        auto& device = GetCurrentRenderer().GetDevice();
+        for (auto& pipeline : mPipelines) { pipeline = vk::Pipeline(); }
+        GetCurrentRenderer().GetPipelineCache().EvictLayout(mPipelineLayout);
+        CallDevice([&]()
+        {
+            device.destroyPipelineLayout(mPipelineLayout);
+            device.destroyDescriptorSetLayout(mSetLayout);
+        });
+        mPipelineLayout = vk::PipelineLayout();
+        mSetLayout = vk::DescriptorSetLayout();
+        mCounterBuffer = BufferVK();
+        mSampler.reset();
+    }
+
+    void MipDownsamplerVK::Downsample(CommandBufferVK &commands, const ImageVK &image, Reduction reduction)
+    {
+        if (image.GetMipLevelCount() < 2) { return; }
+        if (!mbSupported && reduction == Reduction::AVERAGE)
+        {
+            commands.GenerateMipLevels(image, BlitFilter::LINEAR);
+            return;
+        }
+        this->Downsample(commands, image, 0, image, 1, image.GetMipLevelCount() - 1, reduction);
+    }
+
+    void MipDownsamplerVK::Downsample(CommandBufferVK &commands, const ImageVK &source, uint32_t sourceMip,
+        const ImageVK &destination, uint32_t destinationBaseMip, uint32_t mipCount, Reduction reduction)
+    {
+        mipCount = std::min(mipCount, MaxOutputMips);
+        if (mipCount == 0) { return; }
+        // 没有可用的回退，Init时已经输出原因
+        assert(mbSupported);
+        if (!mbSupported) { return; }
+
+        uint32_t sourceWidth = source.GetMipLevelWidth(sourceMip);
+        uint32_t sourceHeight = source.GetMipLevelHeight(sourceMip);
+        uint32_t layerCount = destination.GetLayerCount();
+        // 最后一个工作组只处理64x64的mip 6
+        assert(mipCount <= 6 || std::max(sourceWidth, sourceHeight) <= TileSize << 6);
+        assert(layerCount <= MaxLayers && layerCount == source.GetLayerCount());
+
+        auto& renderer = GetCurrentRenderer();
+        auto& device = renderer.GetDevice();
+
+        if (!mbCountersCleared)
+        {
+            commands.FillBuffer(mCounterBuffer, 0);
+            mbCountersCleared = true;
+        }
+
+        commands.TransitionImage(source, ImageUsage::SHADER_READ, sourceMip, 1);
+        commands.TransitionImage(destination, ImageUsage::STORAGE, destinationBaseMip, mipCount);
+        commands.TransitionBuffer(mCounterBuffer, BufferUsage::STORAGE_BUFFER);
+
+        auto descriptorSet = renderer.GetCurrentDescriptorAllocator().Allocate(mSetLayout);
+
+        vk::DescriptorImageInfo sourceInfo {};
+        sourceInfo.setSampler(mSampler->GetNativeSampler());
+        sourceInfo.setImageView(source.GetMipView(sourceMip));
+        sourceInfo.setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+        // 未使用的数组元素也必须是有效描述符，重复填最后一级
+        std::array<vk::DescriptorImageInfo, MaxOutputMips> outputInfos {};
+        for (uint32_t i = 0; i < MaxOutputMips; i++)
+        {
+            outputInfos[i].setImageView(destination.GetMipView(destinationBaseMip + std::min(i, mipCount - 1)));
+            outputInfos[i].setImageLayout(vk::ImageLayout::eGeneral);
+        }
+
+        vk::DescriptorBufferInfo counterInfo {};
+        counterInfo.setBuffer(mCounterBuffer.GetNativeBuffer());
+        counterInfo.setOffset(0);
+        counterInfo.setRange(VK_WHOLE_SIZE);
+
+        std::array<vk::WriteDescriptorSet, 4> writes {};
+        writes[0].setDstSet(descriptorSet).setDstBinding(0).setDescriptorType(vk::DescriptorType::eCombinedImageSampler).setImageInfo(sourceInfo);
+        writes[1].setDstSet(descriptorSet).setDstBinding(1).setDescriptorType(vk::DescriptorType::eStorageImage).setImageInfo(outputInfos);
+        writes[2].setDstSet(descriptorSet).setDstBinding(2).setDescriptorType(vk::DescriptorType::eStorageImage).setImageInfo(outputInfos[std::min(5u, mipCount - 1)]);
+        writes[3].setDstSet(descriptorSet).setDstBinding(3).setDescriptorType(vk::DescriptorType::eStorageBuffer).setBufferInfo(counterInfo);
+        CallDevice([&]() { device.updateDescriptorSets(writes, {}); });
+
+        uint32_t groupCountX = (sourceWidth + TileSize - 1) / TileSize;
+        uint32_t groupCountY = (sourceHeight + TileSize - 1) / TileSize;
+
+        PushConstants pushConstants {};
+        pushConstants.OutputMipCount = mipCount;
+        pushConstants.WorkGroupCount = groupCountX * groupCountY;
+
+        commands.BindPipeline(vk::PipelineBindPoint::eCompute, mPipelines[(size_t)reduction]);
+        commands.BindDescriptorSet(vk::PipelineBindPoint::eCompute, mPipelineLayout, 0, descriptorSet);
+        commands.PushConstants(mPipelineLayout, vk::ShaderStageFlagBits::eCompute, &pushConstants);
+        commands.Dispatch(groupCountX, groupCountY, layerCount);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+#include "BufferVK.hpp"
+#include "CommandBufferVK.hpp"
+#include "ImageVK.hpp"
+#include "SamplerVK.hpp"
+#include "ShaderVK.hpp"
+
+#include <array>
+
+namespace RHI::Vulkan
+{
+    // 单次派发生成最多12级mip，对应Assets/Shaders/GLSL/MipDownsample.comp
+    class MipDownsamplerVK
+    {
+    public:
+        enum class Reduction : uint32_t
+        {
+            AVERAGE = 0,
+            MIN,
+            MAX,
+            Count
+        };
+
+        constexpr static uint32_t MaxOutputMips = 12;
+        constexpr static uint32_t TileSize = 64;
+        constexpr static uint32_t MaxLayers = 64;
+
+        void Init(const ComputeShaderVK& shader);
+        void Destroy();
+
+        // 原地从mip 0生成其余mip，图像需要SHADER_READ和STORAGE用途
+        // 设备不支持不带格式的存储图像时，平均值归约退回到GenerateMipLevels，图像还需要TRANSFER用途
+        void Downsample(CommandBufferVK& commands, const ImageVK& image, Reduction reduction = Reduction::AVERAGE);
+        // 把source的sourceMip归约到destination从destinationBaseMip开始的mipCount级，例如深度生成Hi-Z
+        void Downsample(CommandBufferVK& commands, const ImageVK& source, uint32_t sourceMip,
+            const ImageVK& destination, uint32_t destinationBaseMip, uint32_t mipCount, Reduction reduction);
+
+    private:
+        struct PushConstants
+        {
+            uint32_t OutputMipCount;
+            uint32_t WorkGroupCount;
+        };
+
+        vk::DescriptorSetLayout mSetLayout;
+        vk::PipelineLayout mPipelineLayout;
+        std::array<vk::Pipeline, (size_t)Reduction::Count> mPipelines;
+        BufferVK mCounterBuffer;
+        SamplerVKHandle mSampler;
+        bool mbCountersCleared = false;
+        bool mbSupported = false;
+    };
+}
@@ -0,0 +1,11 @@
+#include "NullBackendVK.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+namespace RHI::Vulkan
+{
+    bool IsNullBackend()
+    {
+        return GetCurrentRenderer().IsNullBackend();
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+
+#include <atomic>
+
+namespace RHI::Vulkan
+{
+    // 空后端没有设备，用递增的占位句柄区分不同对象，使状态跟踪和冗余消除的行为与真实后端一致
+    // 占位句柄不能传给驱动
+    template<typename T>
+    T CreateNullHandle()
+    {
+        static std::atomic<uint64_t> sNextHandle { 0 };
+        return T((typename T::CType)(++sNextHandle));
+    }
+
+    bool IsNullBackend();
+
+    // 设备调用统一经过这两个函数：空后端创建时返回占位句柄，其余调用直接跳过
+    template<typename T, typename CreateFunction>
+    T CreateDeviceObject(CreateFunction&& create)
+    {
+        return IsNullBackend() ? CreateNullHandle<T>() : create();
+    }
+
+    template<typename DeviceFunction>
+    void CallDevice(DeviceFunction&& call)
+    {
+        if (!IsNullBackend()) { call(); }
+    }
+}
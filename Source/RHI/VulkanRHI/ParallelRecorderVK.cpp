@@ -0,0 +1,122 @@
+#include "ParallelRecorderVK.hpp"
+#include "RenderPassVK.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+
+namespace RHI::Vulkan
+{
+    void ParallelRecorderVK::Init(uint32_t threadCount, uint32_t virtualFrameCount)
+    {
+        this->Destroy();
+
+        auto& renderer = GetCurrentRenderer();
+
+        threadCount = std::max(threadCount, 1u);
+        mThreadPool.SetThreadCount(threadCount);
+        mThreadContexts.resize(threadCount);
+
+        for (auto& context : mThreadContexts)
+        {
+            context.Frames.resize(virtualFrameCount);
+            for (auto& frame : context.Frames) { frame.Init(renderer.GetQueueFamilyIndex()); }
+        }
+        mCurrentFrame = 0;
+    }
+
+    void ParallelRecorderVK::Destroy()
+    {
+        if (mThreadContexts.empty()) { return; }
+
+        mThreadPool.Wait();
+        mThreadPool.SetThreadCount(0);
+
+        // 命令池随线程上下文一起销毁
+        mThreadContexts.clear();
+        mRecordedBuffers.clear();
+        mRecordedStats.clear();
+    }
+
+    void ParallelRecorderVK::StartFrame(size_t frameIndex)
+    {
+        mCurrentFrame = frameIndex;
+        for (auto& context : mThreadContexts) { context.Frames[frameIndex].Reset(); }
+    }
+
+    static void SetupInheritance(const NativeRenderPass *renderPass, vk::CommandBufferInheritanceInfo &inheritance, vk::CommandBufferInheritanceRenderingInfo &renderingInheritance)
+    {
+        if (renderPass != nullptr && renderPass->RenderPassHandle)
+        {
+            inheritance.setRenderPass(renderPass->RenderPassHandle);
+            inheritance.setSubpass(renderPass->Subpass);
+            inheritance.setFramebuffer(renderPass->Framebuffer);
+        }
+        else if (renderPass != nullptr && renderPass->DynamicRendering.IsEnabled())
+        {
+            const auto& rendering = renderPass->DynamicRendering;
+            renderingInheritance.setColorAttachmentFormats(rendering.ColorFormats);
+            renderingInheritance.setDepthAttachmentFormat(rendering.DepthFormat);
+            renderingInheritance.setStencilAttachmentFormat(rendering.StencilFormat);
+            renderingInheritance.setRasterizationSamples(vk::SampleCountFlagBits::e1);
+            inheritance.setPNext(&renderingInheritance);
+        }
+    }
+
+    void ParallelRecorderVK::Record(CommandBufferVK &primary, const NativeRenderPass *renderPass, uint32_t jobCount, const RecordFunction &record)
+    {
+        if (jobCount == 0) { return; }
+
+        vk::CommandBufferInheritanceInfo inheritance {};
+        vk::CommandBufferInheritanceRenderingInfo renderingInheritance {};
+        SetupInheritance(renderPass, inheritance, renderingInheritance);
+
+        this->RecordJobs(jobCount, [renderPass, &inheritance, &record](CommandBufferVK& commands, uint32_t jobIndex)
+        {
+            commands.Begin(inheritance);
+            if (renderPass != nullptr) { commands.BindPassState(*renderPass); }
+            record(commands, jobIndex);
+        });
+
+        primary.ExecuteCommands(mRecordedBuffers, mRecordedStats);
+    }
+
+    void ParallelRecorderVK::RecordSecondaries(ArrayView<const NativeRenderPass* const> inheritedPasses, const RecordFunction &record)
+    {
+        this->RecordJobs((uint32_t)inheritedPasses.size(), [inheritedPasses, &record](CommandBufferVK& commands, uint32_t jobIndex)
+        {
+            // 继承信息只在Begin期间使用，每个任务在自己的栈上构造
+            vk::CommandBufferInheritanceInfo inheritance {};
+            vk::CommandBufferInheritanceRenderingInfo renderingInheritance {};
+            SetupInheritance(inheritedPasses[jobIndex], inheritance, renderingInheritance);
+
+            commands.Begin(inheritance);
+            record(commands, jobIndex);
+        });
+    }
+
+    void ParallelRecorderVK::RecordJobs(uint32_t jobCount, const RecordFunction &record)
+    {
+        mRecordedBuffers.assign(jobCount, vk::CommandBuffer {});
+        mRecordedStats.assign(jobCount, CommandBufferStats {});
+        if (jobCount == 0) { return; }
+
+        uint32_t threadCount = std::min(this->GetThreadCount(), jobCount);
+        for (uint32_t threadIndex = 0; threadIndex < threadCount; threadIndex++)
+        {
+            mThreadPool.GetThread(threadIndex).AddJob([this, threadIndex, threadCount, jobCount, &record]()
+            {
+                auto& pool = mThreadContexts[threadIndex].Frames[mCurrentFrame];
+                for (uint32_t jobIndex = threadIndex; jobIndex < jobCount; jobIndex += threadCount)
+                {
+                    CommandBufferVK commands { pool.Acquire(vk::CommandBufferLevel::eSecondary) };
+                    record(commands, jobIndex);
+                    commands.End();
+                    mRecordedBuffers[jobIndex] = commands.GetNativeCmdBuffer();
+                    mRecordedStats[jobIndex] = commands.GetStats();
+                }
+            });
+        }
+        mThreadPool.Wait();
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+#include "Utilities/ThreadPool.hpp"
+#include "CommandBufferVK.hpp"
+#include "CommandPoolVK.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace RHI::Vulkan
+{
+    struct NativeRenderPass;
+
+    // 每个工作线程在每个虚拟帧拥有独立的命令池，并行录制secondary命令缓冲后由主命令缓冲按顺序执行
+    // 资源状态跟踪不是线程安全的，布局转换需要在主命令缓冲上完成，任务内只录制绑定和绘制
+    class ParallelRecorderVK
+    {
+    public:
+        using RecordFunction = std::function<void(CommandBufferVK& commands, uint32_t jobIndex)>;
+
+        void Init(uint32_t threadCount, uint32_t virtualFrameCount);
+        void Destroy();
+
+        // 该虚拟帧的Fence触发后调用，整体重置本帧所有线程的命令池
+        void StartFrame(size_t frameIndex);
+        // jobCount个任务按jobIndex % threadCount分配到各线程，secondary命令缓冲按jobIndex顺序执行
+        // renderPass非空时primary需要以vk::SubpassContents::eSecondaryCommandBuffers调用BeginPass，动态渲染同样适用
+        void Record(CommandBufferVK& primary, const NativeRenderPass* renderPass, uint32_t jobCount, const RecordFunction& record);
+        // 每个任务录制一个独立的secondary命令缓冲，inheritedPasses[jobIndex]非空时继承该渲染通道
+        // 录制结果不会自动执行，调用者在主命令缓冲上穿插屏障后按顺序执行GetRecordedBuffers中的命令缓冲
+        void RecordSecondaries(ArrayView<const NativeRenderPass* const> inheritedPasses, const RecordFunction& record);
+        const std::vector<vk::CommandBuffer>& GetRecordedBuffers() const { return mRecordedBuffers; }
+        // 与GetRecordedBuffers一一对应，执行时一并传给ExecuteCommands计入主命令缓冲的统计
+        const std::vector<CommandBufferStats>& GetRecordedStats() const { return mRecordedStats; }
+
+        uint32_t GetThreadCount() const { return (uint32_t)mThreadContexts.size(); }
+
+    private:
+        void RecordJobs(uint32_t jobCount, const RecordFunction& record);
+
+    private:
+        struct ThreadContext
+        {
+            std::vector<CommandPoolVK> Frames;
+        };
+
+    private:
+        Utilities::ThreadPool mThreadPool;
+        std::vector<ThreadContext> mThreadContexts;
+        std::vector<vk::CommandBuffer> mRecordedBuffers;
+        std::vector<CommandBufferStats> mRecordedStats;
+        size_t mCurrentFrame = 0;
+    };
+}
@@ -0,0 +1,447 @@
+#include "PipelineCacheVK.hpp"
+#include "CommonVK.hpp"
+#include "NullBackendVK.hpp"
+#include "ShaderReflection.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace RHI::Vulkan
+{
+    GraphicsPipelineDesc GraphicsPipelineDesc::FromPipeline(const PipelineVK &pipeline, vk::PipelineLayout layout)
+    {
+        GraphicsPipelineDesc desc {};
+        desc.Layout = layout;
+        desc.bDescriptorBuffer = GetCurrentRenderer().GetDescriptorCache().IsUsingDescriptorBuffer();
+
+        auto shader = dynamic_cast<const GraphicShaderVK*>(pipeline.mShader.get());
+        assert(shader != nullptr);
+        desc.VertexShader = shader->GetNativeVertexModule();
+        desc.FragmentShader = shader->GetNativeFragmentModule();
+
+        // 每个绑定依次占用BindingRange个顶点属性，多分量的属性（如矩阵）按列占用多个location
+        auto attributes = shader->GetInputAttributes();
+        uint32_t attributeIndex = 0;
+        uint32_t location = 0;
+        for (uint32_t binding = 0; binding < (uint32_t)pipeline.mVertexBindings.size(); binding++)
+        {
+            const auto& vertexBinding = pipeline.mVertexBindings[binding];
+            uint32_t bindingRange = vertexBinding.BindingRange == VertexBinding::BindingRangeAll ? (uint32_t)attributes.size() - attributeIndex : vertexBinding.BindingRange;
+            uint32_t stride = 0;
+            for (uint32_t i = 0; i < bindingRange; i++, attributeIndex++)
+            {
+                const auto& attribute = attributes[attributeIndex];
+                uint32_t locationCount = (uint32_t)attribute.ComponentCount;
+                for (uint32_t j = 0; j < locationCount; j++, location++)
+                {
+                    desc.VertexAttributes.push_back(vk::VertexInputAttributeDescription{ location, binding, ToNative(attribute.LayoutFormat), stride });
+                    stride += (uint32_t)attribute.ByteSize / locationCount;
+                }
+            }
+            desc.VertexBindings.push_back(vk::VertexInputBindingDescription{ binding, stride, VertexBindingRateToVertexInputRate(vertexBinding.InputRate) });
+        }
+        return desc;
+    }
+
+    size_t PipelineDescHasher::operator()(const GraphicsPipelineDesc &desc) const
+    {
+        size_t hash = 0;
+        Utilities::HashCombine(hash, static_cast<VkShaderModule>(desc.VertexShader));
+        Utilities::HashCombine(hash, static_cast<VkShaderModule>(desc.FragmentShader));
+        Utilities::HashCombine(hash, static_cast<VkPipelineLayout>(desc.Layout));
+        for (const auto& binding : desc.VertexBindings)
+        {
+            Utilities::HashCombine(hash, binding.binding);
+            Utilities::HashCombine(hash, binding.stride);
+            Utilities::HashCombine(hash, binding.inputRate);
+        }
+        for (const auto& attribute : desc.VertexAttributes)
+        {
+            Utilities::HashCombine(hash, attribute.location);
+            Utilities::HashCombine(hash, attribute.binding);
+            Utilities::HashCombine(hash, attribute.format);
+            Utilities::HashCombine(hash, attribute.offset);
+        }
+        for (auto format : desc.ColorFormats) { Utilities::HashCombine(hash, format); }
+        Utilities::HashCombine(hash, desc.DepthStencilFormat);
+        Utilities::HashCombine(hash, static_cast<VkRenderPass>(desc.RenderPass));
+        Utilities::HashCombine(hash, desc.Subpass);
+
+        // 固定功能状态都很小，打包成一个值再合并
+        uint64_t packed =
+            (uint64_t)desc.Topology |
+            (uint64_t)desc.Polygon << 4 |
+            (uint64_t)static_cast<VkCullModeFlags>(desc.Cull) << 8 |
+            (uint64_t)desc.Front << 12 |
+            (uint64_t)desc.Samples << 16 |
+            (uint64_t)desc.bDepthTest << 24 |
+            (uint64_t)desc.bDepthWrite << 25 |
+            (uint64_t)desc.bBlend << 26 |
+            (uint64_t)desc.bDescriptorBuffer << 27 |
+            (uint64_t)desc.DepthCompare << 28;
+        Utilities::HashCombine(hash, packed);
+        return hash;
+    }
+
+    size_t PipelineDescHasher::operator()(const ComputePipelineDesc &desc) const
+    {
+        size_t hash = 0;
+        Utilities::HashCombine(hash, static_cast<VkShaderModule>(desc.ComputeShader));
+        Utilities::HashCombine(hash, static_cast<VkPipelineLayout>(desc.Layout));
+        for (auto constant : desc.SpecializationConstants) { Utilities::HashCombine(hash, constant); }
+        Utilities::HashCombine(hash, desc.bDescriptorBuffer);
+        return hash;
+    }
+
+    void PipelineCacheVK::Init(uint32_t virtualFrameCount, const std::string &cacheFile, uint32_t saveInterval)
+    {
+        mVirtualFrameCount = std::max(virtualFrameCount, 1u);
+        mFrameCounter = 0;
+        mHitCount = 0;
+        mMissCount = 0;
+        mCacheFile = cacheFile;
+        mSaveInterval = saveInterval;
+        mFramesSinceSave = 0;
+        mMissCountAtSave = 0;
+        mbLoadedFromDisk = false;
+
+        auto& renderer = GetCurrentRenderer();
+        if (renderer.IsNullBackend()) { return; }
+
+        auto data = this->LoadCacheData();
+        if (!data.empty() && !this->IsCacheDataCompatible(data))
+        {
+            GDebugInfoCallback("PipelineCache", "Ignored pipeline cache " + mCacheFile + " created by another device or driver");
+            data.clear();
+        }
+
+        vk::PipelineCacheCreateInfo pipelineCacheCI {};
+        pipelineCacheCI.setInitialDataSize(data.size());
+        pipelineCacheCI.setPInitialData(data.data());
+        mNativeCache = renderer.GetDevice().createPipelineCache(pipelineCacheCI);
+        mbLoadedFromDisk = !data.empty();
+        if (mbLoadedFromDisk) { GDebugInfoCallback("PipelineCache", "Loaded " + std::to_string(data.size()) + " bytes from " + mCacheFile); }
+    }
+
+    void PipelineCacheVK::Destroy()
+    {
+        auto& renderer = GetCurrentRenderer();
+        {
+            std::unique_lock lock(mMutex);
+            if (!renderer.IsNullBackend())
+            {
+                for (const auto& [desc, pipeline] : mGraphicsPipelines) { renderer.GetDevice().destroyPipeline(pipeline); }
+                for (const auto& [desc, pipeline] : mComputePipelines) { renderer.GetDevice().destroyPipeline(pipeline); }
+                for (const auto& retired : mRetiredPipelines) { renderer.GetDevice().destroyPipeline(retired.Pipeline); }
+            }
+            mGraphicsPipelines.clear();
+            mComputePipelines.clear();
+            mRetiredPipelines.clear();
+        }
+
+        if (mNativeCache)
+        {
+            this->Save();
+            renderer.GetDevice().destroyPipelineCache(mNativeCache);
+            mNativeCache = vk::PipelineCache();
+        }
+    }
+
+    void PipelineCacheVK::AdvanceFrame()
+    {
+        {
+            std::unique_lock lock(mMutex);
+            mFrameCounter++;
+            auto& renderer = GetCurrentRenderer();
+            auto retired = std::remove_if(mRetiredPipelines.begin(), mRetiredPipelines.end(),
+                [this, &renderer](const RetiredPipeline& entry)
+                {
+                    if (entry.RetiredFrame + mVirtualFrameCount >= mFrameCounter) { return false; }
+                    if (!renderer.IsNullBackend()) { renderer.GetDevice().destroyPipeline(entry.Pipeline); }
+                    return true;
+                });
+            mRetiredPipelines.erase(retired, mRetiredPipelines.end());
+        }
+
+        if (mSaveInterval == 0) { return; }
+
+        mFramesSinceSave++;
+        // 没有创建新管线时驱动缓存不会变化，不需要重复写盘
+        if (mFramesSinceSave >= mSaveInterval && this->GetMissCount() != mMissCountAtSave) { this->Save(); }
+    }
+
+    void PipelineCacheVK::Save()
+    {
+        mFramesSinceSave = 0;
+        mMissCountAtSave = this->GetMissCount();
+        if (!mNativeCache || mCacheFile.empty()) { return; }
+
+        auto data = GetCurrentRenderer().GetDevice().getPipelineCacheData(mNativeCache);
+        if (data.empty()) { return; }
+
+        // 先写临时文件再替换，进程在写入中途退出时不会留下损坏的缓存
+        std::string tempFile = mCacheFile + ".tmp";
+        {
+            std::ofstream file(tempFile, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                GDebugInfoCallback("PipelineCache", "Failed to write " + tempFile);
+                return;
+            }
+            file.write((const char*)data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempFile, mCacheFile, error);
+        if (error) { GDebugInfoCallback("PipelineCache", "Failed to replace " + mCacheFile + ": " + error.message()); }
+    }
+
+    std::vector<uint8_t> PipelineCacheVK::LoadCacheData() const
+    {
+        std::vector<uint8_t> data;
+        if (mCacheFile.empty()) { return data; }
+
+        // 第一次运行时还没有缓存文件，不算错误
+        std::ifstream file(mCacheFile, std::ios::ate | std::ios::binary);
+        if (!file.is_open()) { return data; }
+
+        size_t fileSize = file.tellg();
+        data.resize(fileSize);
+        file.seekg(0);
+        file.read((char*)data.data(), static_cast<std::streamsize>(fileSize));
+        if (!file) { data.clear(); }
+        return data;
+    }
+
+    bool PipelineCacheVK::IsCacheDataCompatible(const std::vector<uint8_t> &data) const
+    {
+        // 驱动也会校验头部，但部分驱动遇到别的设备生成的数据会出错，这里先自己检查一遍
+        VkPipelineCacheHeaderVersionOne header {};
+        if (data.size() < sizeof(header)) { return false; }
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        const auto& properties = GetCurrentRenderer().GetPhysicalDeviceProperties();
+        return header.headerSize >= sizeof(header) &&
+            header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+            header.vendorID == properties.vendorID &&
+            header.deviceID == properties.deviceID &&
+            std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+    }
+
+    size_t PipelineCacheVK::GetPipelineCount() const
+    {
+        std::shared_lock lock(mMutex);
+        return mGraphicsPipelines.size() + mComputePipelines.size();
+    }
+
+    vk::Pipeline PipelineCacheVK::Acquire(const GraphicsPipelineDesc &desc)
+    {
+        {
+            std::shared_lock lock(mMutex);
+            auto it = mGraphicsPipelines.find(desc);
+            if (it != mGraphicsPipelines.end())
+            {
+                mHitCount.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+        }
+
+        // 释放共享锁后其他线程可能已经创建了同样的管线
+        std::unique_lock lock(mMutex);
+        auto it = mGraphicsPipelines.find(desc);
+        if (it != mGraphicsPipelines.end())
+        {
+            mHitCount.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+
+        mMissCount.fetch_add(1, std::memory_order_relaxed);
+        auto pipeline = this->CreateGraphicsPipeline(desc);
+        mGraphicsPipelines.emplace(desc, pipeline);
+        return pipeline;
+    }
+
+    vk::Pipeline PipelineCacheVK::Acquire(const ComputePipelineDesc &desc)
+    {
+        {
+            std::shared_lock lock(mMutex);
+            auto it = mComputePipelines.find(desc);
+            if (it != mComputePipelines.end())
+            {
+                mHitCount.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+        }
+
+        std::unique_lock lock(mMutex);
+        auto it = mComputePipelines.find(desc);
+        if (it != mComputePipelines.end())
+        {
+            mHitCount.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+
+        mMissCount.fetch_add(1, std::memory_order_relaxed);
+        auto pipeline = this->CreateComputePipeline(desc);
+        mComputePipelines.emplace(desc, pipeline);
+        return pipeline;
+    }
+
+    template<typename Map, typename Predicate>
+    void PipelineCacheVK::Evict(Map &pipelines, Predicate predicate)
+    {
+        for (auto it = pipelines.begin(); it != pipelines.end();)
+        {
+            if (predicate(it->first))
+            {
+                mRetiredPipelines.push_back(RetiredPipeline{ it->second, mFrameCounter });
+                it = pipelines.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    void PipelineCacheVK::EvictShader(vk::ShaderModule shader)
+    {
+        std::unique_lock lock(mMutex);
+        this->Evict(mGraphicsPipelines, [shader](const GraphicsPipelineDesc& desc) { return desc.VertexShader == shader || desc.FragmentShader == shader; });
+        this->Evict(mComputePipelines, [shader](const ComputePipelineDesc& desc) { return desc.ComputeShader == shader; });
+    }
+
+    void PipelineCacheVK::EvictLayout(vk::PipelineLayout layout)
+    {
+        std::unique_lock lock(mMutex);
+        this->Evict(mGraphicsPipelines, [layout](const GraphicsPipelineDesc& desc) { return desc.Layout == layout; });
+        this->Evict(mComputePipelines, [layout](const ComputePipelineDesc& desc) { return desc.Layout == layout; });
+    }
+
+    void PipelineCacheVK::EvictRenderPass(vk::RenderPass renderPass)
+    {
+        std::unique_lock lock(mMutex);
+        this->Evict(mGraphicsPipelines, [renderPass](const GraphicsPipelineDesc& desc) { return desc.RenderPass == renderPass; });
+    }
+
+    vk::Pipeline PipelineCacheVK::CreateGraphicsPipeline(const GraphicsPipelineDesc &desc)
+    {
+        auto& renderer = GetCurrentRenderer();
+        if (renderer.IsNullBackend()) { return CreateNullHandle<vk::Pipeline>(); }
+
+        std::array shaderStages = {
+            vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eVertex, desc.VertexShader, "main" },
+            vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eFragment, desc.FragmentShader, "main" },
+        };
+
+        vk::PipelineVertexInputStateCreateInfo vertexInputStateCI {};
+        vertexInputStateCI.setVertexBindingDescriptions(desc.VertexBindings);
+        vertexInputStateCI.setVertexAttributeDescriptions(desc.VertexAttributes);
+
+        vk::PipelineInputAssemblyStateCreateInfo inputAssemblyStateCI {};
+        inputAssemblyStateCI.setTopology(desc.Topology);
+
+        // 视口和裁剪矩形在录制时设置，渲染分辨率变化不需要重建管线
+        vk::PipelineViewportStateCreateInfo viewportStateCI {};
+        viewportStateCI.setViewportCount(1);
+        viewportStateCI.setScissorCount(1);
+
+        vk::PipelineRasterizationStateCreateInfo rasterizationStateCI {};
+        rasterizationStateCI.setPolygonMode(desc.Polygon);
+        rasterizationStateCI.setCullMode(desc.Cull);
+        rasterizationStateCI.setFrontFace(desc.Front);
+        rasterizationStateCI.setLineWidth(1.0f);
+
+        vk::PipelineMultisampleStateCreateInfo multisampleStateCI {};
+        multisampleStateCI.setRasterizationSamples(desc.Samples);
+
+        vk::PipelineDepthStencilStateCreateInfo depthStencilStateCI {};
+        depthStencilStateCI.setDepthTestEnable(desc.bDepthTest);
+        depthStencilStateCI.setDepthWriteEnable(desc.bDepthWrite);
+        depthStencilStateCI.setDepthCompareOp(desc.DepthCompare);
+
+        vk::PipelineColorBlendAttachmentState blendAttachment {};
+        blendAttachment.setBlendEnable(desc.bBlend);
+        blendAttachment.setSrcColorBlendFactor(vk::BlendFactor::eSrcAlpha);
+        blendAttachment.setDstColorBlendFactor(vk::BlendFactor::eOneMinusSrcAlpha);
+        blendAttachment.setColorBlendOp(vk::BlendOp::eAdd);
+        blendAttachment.setSrcAlphaBlendFactor(vk::BlendFactor::eOne);
+        blendAttachment.setDstAlphaBlendFactor(vk::BlendFactor::eZero);
+        blendAttachment.setAlphaBlendOp(vk::BlendOp::eAdd);
+        blendAttachment.setColorWriteMask(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+        std::vector<vk::PipelineColorBlendAttachmentState> blendAttachments(desc.ColorFormats.size(), blendAttachment);
+
+        vk::PipelineColorBlendStateCreateInfo colorBlendStateCI {};
+        colorBlendStateCI.setAttachments(blendAttachments);
+
+        std::array dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+        vk::PipelineDynamicStateCreateInfo dynamicStateCI {};
+        dynamicStateCI.setDynamicStates(dynamicStates);
+
+        // 没有指定RenderPass时使用动态渲染，只需要附件格式
+        std::vector<vk::Format> colorFormats;
+        for (auto format : desc.ColorFormats) { colorFormats.push_back(ToNative(format)); }
+        vk::Format depthStencilFormat = ToNative(desc.DepthStencilFormat);
+        vk::ImageAspectFlags depthStencilAspect = ImageFormatToImageAspect(desc.DepthStencilFormat);
+
+        vk::PipelineRenderingCreateInfo renderingCI {};
+        renderingCI.setColorAttachmentFormats(colorFormats);
+        if (depthStencilAspect & vk::ImageAspectFlagBits::eDepth) { renderingCI.setDepthAttachmentFormat(depthStencilFormat); }
+        if (depthStencilAspect & vk::ImageAspectFlagBits::eStencil) { renderingCI.setStencilAttachmentFormat(depthStencilFormat); }
+
+        vk::GraphicsPipelineCreateInfo pipelineCI {};
+        pipelineCI.setStages(shaderStages);
+        pipelineCI.setPVertexInputState(&vertexInputStateCI);
+        pipelineCI.setPInputAssemblyState(&inputAssemblyStateCI);
+        pipelineCI.setPViewportState(&viewportStateCI);
+        pipelineCI.setPRasterizationState(&rasterizationStateCI);
+        pipelineCI.setPMultisampleState(&multisampleStateCI);
+        pipelineCI.setPDepthStencilState(&depthStencilStateCI);
+        pipelineCI.setPColorBlendState(&colorBlendStateCI);
+        pipelineCI.setPDynamicState(&dynamicStateCI);
+        pipelineCI.setLayout(desc.Layout);
+        if (desc.bDescriptorBuffer) { pipelineCI.setFlags(vk::PipelineCreateFlagBits::eDescriptorBufferEXT); }
+        if (desc.RenderPass)
+        {
+            pipelineCI.setRenderPass(desc.RenderPass);
+            pipelineCI.setSubpass(desc.Subpass);
+        }
+        else
+        {
+            pipelineCI.setPNext(&renderingCI);
+        }
+
+        return renderer.GetDevice().createGraphicsPipeline(mNativeCache, pipelineCI).value;
+    }
+
+    vk::Pipeline PipelineCacheVK::CreateComputePipeline(const ComputePipelineDesc &desc)
+    {
+        auto& renderer = GetCurrentRenderer();
+        if (renderer.IsNullBackend()) { return CreateNullHandle<vk::Pipeline>(); }
+
+        std::vector<vk::SpecializationMapEntry> mapEntries;
+        for (uint32_t i = 0; i < (uint32_t)desc.SpecializationConstants.size(); i++)
+        {
+            mapEntries.push_back(vk::SpecializationMapEntry{ i, i * (uint32_t)sizeof(uint32_t), sizeof(uint32_t) });
+        }
+        vk::SpecializationInfo specializationInfo {};
+        specializationInfo.setMapEntries(mapEntries);
+        specializationInfo.setData<uint32_t>(desc.SpecializationConstants);
+
+        vk::PipelineShaderStageCreateInfo stageCI { {}, vk::ShaderStageFlagBits::eCompute, desc.ComputeShader, "main" };
+        if (!mapEntries.empty()) { stageCI.setPSpecializationInfo(&specializationInfo); }
+
+        vk::ComputePipelineCreateInfo pipelineCI {};
+        pipelineCI.setStage(stageCI);
+        pipelineCI.setLayout(desc.Layout);
+        if (desc.bDescriptorBuffer) { pipelineCI.setFlags(vk::PipelineCreateFlagBits::eDescriptorBufferEXT); }
+
+        return renderer.GetDevice().createComputePipeline(mNativeCache, pipelineCI).value;
+    }
+}
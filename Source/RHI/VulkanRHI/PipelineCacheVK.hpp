@@ -0,0 +1,126 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+#include "PipelineVK.hpp"
+
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RHI::Vulkan
+{
+    // 创建图形管线需要的全部状态，作为PipelineCacheVK的键
+    struct GraphicsPipelineDesc
+    {
+        vk::ShaderModule VertexShader;
+        vk::ShaderModule FragmentShader;
+        vk::PipelineLayout Layout;
+        std::vector<vk::VertexInputBindingDescription> VertexBindings;
+        std::vector<vk::VertexInputAttributeDescription> VertexAttributes;
+        std::vector<Format> ColorFormats;
+        Format DepthStencilFormat = Format::UNDEFINED;
+        // 不为空时为RenderPass的Subpass创建管线，否则用附件格式创建动态渲染管线；ColorFormats仍决定混合状态的数量
+        vk::RenderPass RenderPass;
+        uint32_t Subpass = 0;
+        // Layout中的DescriptorSetLayout带有描述符缓冲标记时，管线也需要以描述符缓冲模式创建
+        bool bDescriptorBuffer = false;
+
+        vk::PrimitiveTopology Topology = vk::PrimitiveTopology::eTriangleList;
+        vk::PolygonMode Polygon = vk::PolygonMode::eFill;
+        vk::CullModeFlags Cull = vk::CullModeFlagBits::eBack;
+        vk::FrontFace Front = vk::FrontFace::eCounterClockwise;
+        vk::SampleCountFlagBits Samples = vk::SampleCountFlagBits::e1;
+        bool bDepthTest = true;
+        bool bDepthWrite = true;
+        vk::CompareOp DepthCompare = vk::CompareOp::eLessOrEqual;
+        bool bBlend = false;
+
+        // 着色器模块和顶点布局取自PipelineVK，layout来自DescriptorCacheVK，描述符模式与其一致，其余状态保持默认值
+        static GraphicsPipelineDesc FromPipeline(const PipelineVK& pipeline, vk::PipelineLayout layout);
+
+        bool operator==(const GraphicsPipelineDesc& other) const = default;
+    };
+
+    struct ComputePipelineDesc
+    {
+        vk::ShaderModule ComputeShader;
+        vk::PipelineLayout Layout;
+        // 第i个元素为constant_id = i的32位特化常量
+        std::vector<uint32_t> SpecializationConstants;
+        bool bDescriptorBuffer = false;
+
+        bool operator==(const ComputePipelineDesc& other) const = default;
+    };
+
+    struct PipelineDescHasher
+    {
+        size_t operator()(const GraphicsPipelineDesc& desc) const;
+        size_t operator()(const ComputePipelineDesc& desc) const;
+    };
+
+    // 相同状态的管线只创建一次，查找开销足够在每次绘制前调用
+    // 驱动的VkPipelineCache保存在磁盘上，下次启动时用来跳过着色器编译
+    // Acquire可以在录制线程中并发调用：命中时只持有共享锁，创建时持有独占锁，同一时间只编译一条管线
+    // 其余接口只在主线程调用，同样持有独占锁，不会与录制线程中的Acquire交错
+    class PipelineCacheVK
+    {
+    public:
+        // cacheFile为空时不读写磁盘，saveInterval为定期保存的帧间隔，0表示只在销毁时保存
+        void Init(uint32_t virtualFrameCount, const std::string& cacheFile, uint32_t saveInterval);
+        // 销毁前会把驱动缓存写回磁盘
+        void Destroy();
+
+        // 每帧调用，销毁已经不再被GPU使用的淘汰管线；距离上次保存超过saveInterval帧并且创建过新管线时写回磁盘
+        void AdvanceFrame();
+        void Save();
+
+        // 键中使用的句柄销毁前必须淘汰对应的管线，否则句柄值被复用后会返回旧的管线（例如着色器热重载）
+        // 管线在当前所有虚拟帧结束后才销毁
+        void EvictShader(vk::ShaderModule shader);
+        void EvictLayout(vk::PipelineLayout layout);
+        void EvictRenderPass(vk::RenderPass renderPass);
+
+        vk::Pipeline Acquire(const GraphicsPipelineDesc& desc);
+        vk::Pipeline Acquire(const ComputePipelineDesc& desc);
+
+        size_t GetPipelineCount() const;
+        uint64_t GetHitCount() const { return mHitCount.load(std::memory_order_relaxed); }
+        uint64_t GetMissCount() const { return mMissCount.load(std::memory_order_relaxed); }
+        // 是否用磁盘上的缓存初始化了驱动缓存
+        bool IsLoadedFromDisk() const { return mbLoadedFromDisk; }
+
+    private:
+        std::vector<uint8_t> LoadCacheData() const;
+        bool IsCacheDataCompatible(const std::vector<uint8_t>& data) const;
+
+        vk::Pipeline CreateGraphicsPipeline(const GraphicsPipelineDesc& desc);
+        vk::Pipeline CreateComputePipeline(const ComputePipelineDesc& desc);
+        template<typename Map, typename Predicate>
+        void Evict(Map& pipelines, Predicate predicate);
+
+    private:
+        std::unordered_map<GraphicsPipelineDesc, vk::Pipeline, PipelineDescHasher> mGraphicsPipelines;
+        std::unordered_map<ComputePipelineDesc, vk::Pipeline, PipelineDescHasher> mComputePipelines;
+        mutable std::shared_mutex mMutex;
+        std::atomic<uint64_t> mHitCount { 0 };
+        std::atomic<uint64_t> mMissCount { 0 };
+
+        struct RetiredPipeline
+        {
+            vk::Pipeline Pipeline;
+            uint64_t RetiredFrame = 0;
+        };
+        std::vector<RetiredPipeline> mRetiredPipelines;
+        uint64_t mFrameCounter = 0;
+        uint32_t mVirtualFrameCount = 1;
+
+        vk::PipelineCache mNativeCache;
+        std::string mCacheFile;
+        uint32_t mSaveInterval = 0;
+        uint32_t mFramesSinceSave = 0;
+        uint64_t mMissCountAtSave = 0;
+        bool mbLoadedFromDisk = false;
+    };
+}
@@ -0,0 +1,86 @@
+#include "RenderPassVK.hpp"
+#include "CommonVK.hpp"
+#include "ShaderReflection.hpp"
+
+#include "Renderer/RenderGraph.hpp"
+#include "Renderer/RendererBase.hpp"
+
+namespace RHI::Vulkan
+{
+    void SetupDynamicRendering(NativeRenderPass &renderPass, const PipelineVK &pipeline, const AttachmentResolver &getAttachment)
+    {
+        auto& rendering = renderPass.DynamicRendering;
+        rendering = DynamicRenderingInfo {};
+
+        bool renderAreaSet = false;
+        for (const auto& attachment : pipeline.GetOutputAttachments())
+        {
+            const auto& image = getAttachment(attachment.Name);
+            auto usage = AttachmentStateToImageUsage(attachment.OnLoad);
+            auto aspect = ImageFormatToImageAspect(image.GetFormat());
+            bool allLayers = attachment.Layer == PipelineVK::OutputAttachment::ALL_LAYERS;
+
+            vk::RenderingAttachmentInfo attachmentInfo {};
+            attachmentInfo.setImageView(allLayers ? image.GetNativeView(ImageView::NATIVE) : image.GetNativeView(ImageView::NATIVE, attachment.Layer));
+            attachmentInfo.setImageLayout(ImageUsageToImageLayout(usage));
+            attachmentInfo.setLoadOp(AttachmentStateToLoadOp(attachment.OnLoad));
+            attachmentInfo.setStoreOp(vk::AttachmentStoreOp::eStore);
+
+            if (usage == ImageUsage::DEPTH_STENCIL_ATTACHMENT)
+            {
+                const auto& clear = attachment.DepthSpencilClear;
+                attachmentInfo.setClearValue(vk::ClearDepthStencilValue { clear.Depth, clear.Stencil });
+
+                rendering.DepthAttachment = attachmentInfo;
+                rendering.DepthFormat = ToNative(image.GetFormat());
+                if (aspect & vk::ImageAspectFlagBits::eStencil)
+                {
+                    rendering.StencilAttachment = attachmentInfo;
+                    rendering.StencilFormat = rendering.DepthFormat;
+                }
+            }
+            else
+            {
+                const auto& clear = attachment.ColorClear;
+                attachmentInfo.setClearValue(vk::ClearColorValue { std::array { clear.R, clear.G, clear.B, clear.A } });
+
+                rendering.ColorAttachments.push_back(attachmentInfo);
+                rendering.ColorFormats.push_back(ToNative(image.GetFormat()));
+            }
+
+            // 所有附件尺寸一致，渲染区域取第一个附件
+            if (!renderAreaSet)
+            {
+                renderPass.RenderArea = vk::Rect2D { { 0, 0 }, { image.GetWidth(), image.GetHeight() } };
+                rendering.LayerCount = allLayers ? image.GetLayerCount() : 1;
+                renderAreaSet = true;
+            }
+        }
+    }
+
+    void SetupPassDescriptors(NativeRenderPass &renderPass, DescriptorBinding &binding, vk::DescriptorSetLayout layout)
+    {
+        auto& renderer = GetCurrentRenderer();
+        if (renderer.GetDescriptorCache().IsUsingDescriptorBuffer())
+        {
+            // 区域已满时Allocate返回无效分配并输出原因，BindPassState不会设置偏移
+            auto allocation = renderer.GetDescriptorBuffer().Allocate(layout);
+            binding.Write(allocation, layout);
+            renderPass.DescriptorSet = vk::DescriptorSet();
+            renderPass.DescriptorBufferOffset = allocation.Offset;
+        }
+        else
+        {
+            auto& allocator = renderer.GetCurrentDescriptorAllocator();
+            auto descriptorSet = allocator.Allocate(layout);
+            binding.Write(descriptorSet, layout, allocator.GetGeneration());
+            renderPass.DescriptorSet = descriptorSet;
+            renderPass.DescriptorBufferOffset = DescriptorBufferAllocation::InvalidOffset;
+        }
+    }
+
+    const ImageVK &RenderPassState::GetAttachment(const std::string &name)
+    {
+        return this->Graph.GetImage(name);
+    }
+}
\ No newline at end of file
@@ -5,9 +5,29 @@
 #include "PipelineVK.hpp"
 #include "DescriptorVK.hpp"
 
-namespace RHI::Vulkan
+#include <functional>
+
+namespace Renderer
 {
     class RenderGraph;
+}
+
+namespace RHI::Vulkan
+{
+    // Vulkan 1.3动态渲染使用的附件，不需要创建vk::RenderPass和vk::Framebuffer
+    struct DynamicRenderingInfo
+    {
+        std::vector<vk::RenderingAttachmentInfo> ColorAttachments;
+        vk::RenderingAttachmentInfo DepthAttachment;
+        vk::RenderingAttachmentInfo StencilAttachment;
+        // 管线创建和secondary命令缓冲继承时需要附件格式
+        std::vector<vk::Format> ColorFormats;
+        vk::Format DepthFormat = vk::Format::eUndefined;
+        vk::Format StencilFormat = vk::Format::eUndefined;
+        uint32_t LayerCount = 1;
+
+        bool IsEnabled() const { return !ColorAttachments.empty() || DepthFormat != vk::Format::eUndefined; }
+    };
 
     struct NativeRenderPass
     {
@@ -19,11 +39,24 @@ namespace RHI::Vulkan
         vk::PipelineBindPoint       PipelineType = { };
         vk::Rect2D                  RenderArea = { };
         std::vector<vk::ClearValue> ClearValues;
+        uint64_t                    DescriptorBufferOffset = DescriptorBufferAllocation::InvalidOffset;
+        // RenderPassHandle为空且启用时BeginPass使用vkCmdBeginRendering
+        DynamicRenderingInfo        DynamicRendering;
+        // 多个子通道的vk::RenderPass中该Pass对应的子通道，第一个子通道调用BeginPass，之后调用NextSubpass
+        uint32_t                    Subpass = 0;
     };
 
+    using AttachmentResolver = std::function<const ImageVK&(const std::string& name)>;
+    // 根据管线的输出附件填充动态渲染信息和渲染区域，附件需要提前转换到附件用途
+    void SetupDynamicRendering(NativeRenderPass& renderPass, const PipelineVK& pipeline, const AttachmentResolver& getAttachment);
+    // 每帧在BeginPass之前调用，把已经Resolve的binding写入本帧的描述符
+    // 启用描述符缓冲时写入本帧的环形区域并记录DescriptorBufferOffset，否则从本帧的分配器分配DescriptorSet
+    // layout需要来自DescriptorCacheVK，管线以相同的描述符模式创建
+    void SetupPassDescriptors(NativeRenderPass& renderPass, DescriptorBinding& binding, vk::DescriptorSetLayout layout);
+
     struct RenderPassState
     {
-        RenderGraph& Graph;
+        Renderer::RenderGraph& Graph;
         CommandBufferVK& CommandBuffer;
         const NativeRenderPass& RenderPass;
         const ImageVK& GetAttachment(const std::string& name);
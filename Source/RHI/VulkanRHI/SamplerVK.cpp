@@ -0,0 +1,272 @@
+#include "SamplerVK.hpp"
+#include "NullBackendVK.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace RHI::Vulkan
+{
+    static vk::Filter FilterToNative(SamplerVK::Filter filter)
+    {
+        switch (filter)
+        {
+        case SamplerVK::Filter::NEAREST:
+            return vk::Filter::eNearest;
+        case SamplerVK::Filter::LINEAR:
+            return vk::Filter::eLinear;
+        default:
+            assert(false);
+            return vk::Filter::eNearest;
+        }
+    }
+
+    static vk::SamplerMipmapMode MipFilterToNative(SamplerVK::Filter filter)
+    {
+        switch (filter)
+        {
+        case SamplerVK::Filter::NEAREST:
+            return vk::SamplerMipmapMode::eNearest;
+        case SamplerVK::Filter::LINEAR:
+            return vk::SamplerMipmapMode::eLinear;
+        default:
+            assert(false);
+            return vk::SamplerMipmapMode::eNearest;
+        }
+    }
+
+    static vk::SamplerAddressMode AddressModeToNative(SamplerVK::AddressMode mode)
+    {
+        switch (mode)
+        {
+        case SamplerVK::AddressMode::REPEAT:
+            return vk::SamplerAddressMode::eRepeat;
+        case SamplerVK::AddressMode::MIRRORED_REPEAT:
+            return vk::SamplerAddressMode::eMirroredRepeat;
+        case SamplerVK::AddressMode::CLAMP_TO_EDGE:
+            return vk::SamplerAddressMode::eClampToEdge;
+        case SamplerVK::AddressMode::CLAMP_TO_BORDER:
+            return vk::SamplerAddressMode::eClampToBorder;
+        default:
+            assert(false);
+            return vk::SamplerAddressMode::eRepeat;
+        }
+    }
+
+    static vk::CompareOp CompareOpToNative(SamplerVK::CompareOp op)
+    {
+        switch (op)
+        {
+        case SamplerVK::CompareOp::NONE:
+        case SamplerVK::CompareOp::NEVER:
+            return vk::CompareOp::eNever;
+        case SamplerVK::CompareOp::LESS:
+            return vk::CompareOp::eLess;
+        case SamplerVK::CompareOp::EQUAL:
+            return vk::CompareOp::eEqual;
+        case SamplerVK::CompareOp::LESS_OR_EQUAL:
+            return vk::CompareOp::eLessOrEqual;
+        case SamplerVK::CompareOp::GREATER:
+            return vk::CompareOp::eGreater;
+        case SamplerVK::CompareOp::NOT_EQUAL:
+            return vk::CompareOp::eNotEqual;
+        case SamplerVK::CompareOp::GREATER_OR_EQUAL:
+            return vk::CompareOp::eGreaterOrEqual;
+        case SamplerVK::CompareOp::ALWAYS:
+            return vk::CompareOp::eAlways;
+        default:
+            assert(false);
+            return vk::CompareOp::eNever;
+        }
+    }
+
+    static vk::BorderColor BorderColorToNative(SamplerVK::BorderColor color)
+    {
+        switch (color)
+        {
+        case SamplerVK::BorderColor::TRANSPARENT_BLACK:
+            return vk::BorderColor::eFloatTransparentBlack;
+        case SamplerVK::BorderColor::OPAQUE_BLACK:
+            return vk::BorderColor::eFloatOpaqueBlack;
+        case SamplerVK::BorderColor::OPAQUE_WHITE:
+            return vk::BorderColor::eFloatOpaqueWhite;
+        default:
+            assert(false);
+            return vk::BorderColor::eFloatOpaqueBlack;
+        }
+    }
+
+    size_t SamplerVK::DescHasher::operator()(const Desc &desc) const
+    {
+        uint64_t packed =
+            (uint64_t)desc.Min |
+            (uint64_t)desc.Mag << 4 |
+            (uint64_t)desc.Mip << 8 |
+            (uint64_t)desc.AddressU << 12 |
+            (uint64_t)desc.AddressV << 16 |
+            (uint64_t)desc.AddressW << 20 |
+            (uint64_t)desc.Compare << 24 |
+            (uint64_t)desc.Border << 32;
+
+        size_t hash = std::hash<uint64_t>{}(packed);
+        auto combine = [&hash](float value)
+        {
+            // -0.0f与0.0f比较相等，哈希也必须相同
+            if (value == 0.0f) { value = 0.0f; }
+            hash ^= std::hash<uint32_t>{}(std::bit_cast<uint32_t>(value)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        };
+        combine(desc.MaxAnisotropy);
+        combine(desc.MipLodBias);
+        combine(desc.MinLod);
+        combine(desc.MaxLod);
+        return hash;
+    }
+
+    SamplerVK::~SamplerVK()
+    {
+        this->Destroy();
+    }
+
+    SamplerVK::SamplerVK(SamplerVK &&other) noexcept
+    {
+        this->mSampler = other.mSampler;
+        this->mDesc = other.mDesc;
+        this->mBindlessIndex = other.mBindlessIndex;
+
+        other.mSampler = vk::Sampler();
+        other.mBindlessIndex = InvalidBindlessIndex;
+    }
+
+    SamplerVK &SamplerVK::operator=(SamplerVK &&other) noexcept
+    {
+        this->Destroy();
+
+        this->mSampler = other.mSampler;
+        this->mDesc = other.mDesc;
+        this->mBindlessIndex = other.mBindlessIndex;
+
+        other.mSampler = vk::Sampler();
+        other.mBindlessIndex = InvalidBindlessIndex;
+
+        return *this;
+    }
+
+    SamplerVK::SamplerVK(MinFilter minFilter, MagFilter magFilter, AddressMode uvwAddress, MipFilter mipFilter)
+    {
+        this->Init(minFilter, magFilter, uvwAddress, mipFilter);
+    }
+
+    SamplerVK::SamplerVK(const Desc &desc)
+    {
+        this->Init(desc);
+    }
+
+    void SamplerVK::Init(MinFilter minFilter, MagFilter magFilter, AddressMode uvwAddress, MipFilter mipFilter)
+    {
+        Desc desc {};
+        desc.Min = minFilter;
+        desc.Mag = magFilter;
+        desc.Mip = mipFilter;
+        desc.AddressU = uvwAddress;
+        desc.AddressV = uvwAddress;
+        desc.AddressW = uvwAddress;
+        this->Init(desc);
+    }
+
+    void SamplerVK::Init(const Desc &desc)
+    {
+        this->Destroy();
+
+        auto& renderer = GetCurrentRenderer();
+        bool nullBackend = renderer.IsNullBackend();
+        // 没有启用samplerAnisotropy特性时不能开启各向异性过滤
+        float maxAnisotropy = 1.0f;
+        if (nullBackend) { maxAnisotropy = desc.MaxAnisotropy; }
+        else if (renderer.GetEnabledFeatures().samplerAnisotropy) { maxAnisotropy = std::min(desc.MaxAnisotropy, renderer.GetPhysicalDeviceProperties().limits.maxSamplerAnisotropy); }
+
+        vk::SamplerCreateInfo samplerCI {};
+        samplerCI.setMinFilter(FilterToNative(desc.Min));
+        samplerCI.setMagFilter(FilterToNative(desc.Mag));
+        samplerCI.setMipmapMode(MipFilterToNative(desc.Mip));
+        samplerCI.setAddressModeU(AddressModeToNative(desc.AddressU));
+        samplerCI.setAddressModeV(AddressModeToNative(desc.AddressV));
+        samplerCI.setAddressModeW(AddressModeToNative(desc.AddressW));
+        samplerCI.setMipLodBias(desc.MipLodBias);
+        samplerCI.setAnisotropyEnable(maxAnisotropy > 1.0f);
+        samplerCI.setMaxAnisotropy(maxAnisotropy);
+        samplerCI.setCompareEnable(desc.Compare != CompareOp::NONE);
+        samplerCI.setCompareOp(CompareOpToNative(desc.Compare));
+        samplerCI.setMinLod(desc.MinLod);
+        samplerCI.setMaxLod(desc.MaxLod);
+        samplerCI.setBorderColor(BorderColorToNative(desc.Border));
+        samplerCI.setUnnormalizedCoordinates(false);
+
+        this->mDesc = desc;
+        this->mSampler = nullBackend ? CreateNullHandle<vk::Sampler>() : renderer.GetDevice().createSampler(samplerCI);
+        this->mBindlessIndex = renderer.GetBindlessHeap().RegisterSampler(*this);
+    }
+
+    void SamplerVK::Destroy()
+    {
+        if (this->mSampler)
+        {
+            auto& renderer = GetCurrentRenderer();
+            renderer.GetBindlessHeap().Release(BindlessHeapVK::Table::SAMPLER, this->mBindlessIndex);
+            if (!renderer.IsNullBackend()) { renderer.GetDevice().destroySampler(this->mSampler); }
+            this->mSampler = vk::Sampler();
+            this->mBindlessIndex = InvalidBindlessIndex;
+        }
+    }
+
+    void SamplerCacheVK::Init(uint32_t virtualFrameCount)
+    {
+        mVirtualFrameCount = std::max(virtualFrameCount, 1u);
+        mFrameCounter = 0;
+    }
+
+    void SamplerCacheVK::Destroy()
+    {
+        mSamplers.clear();
+    }
+
+    SamplerVKHandle SamplerCacheVK::Acquire(const SamplerVK::Desc &desc)
+    {
+        auto it = mSamplers.find(desc);
+        if (it != mSamplers.end())
+        {
+            mHitCount++;
+            it->second.LastUsedFrame = mFrameCounter;
+            return it->second.Sampler;
+        }
+
+        mMissCount++;
+        Entry entry {};
+        entry.Sampler = std::make_shared<SamplerVK>(desc);
+        entry.LastUsedFrame = mFrameCounter;
+        return mSamplers.emplace(desc, std::move(entry)).first->second.Sampler;
+    }
+
+    void SamplerCacheVK::CollectUnused()
+    {
+        mFrameCounter++;
+        for (auto it = mSamplers.begin(); it != mSamplers.end();)
+        {
+            auto& entry = it->second;
+            // 仍有外部引用的采样器视为本帧在用
+            if (entry.Sampler.use_count() > 1)
+            {
+                entry.LastUsedFrame = mFrameCounter;
+                it++;
+            }
+            else if (entry.LastUsedFrame + mVirtualFrameCount < mFrameCounter)
+            {
+                it = mSamplers.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+}
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "RHI/RHICommon.hpp"
+#include "BindlessVK.hpp"
+
+#include <memory>
+#include <unordered_map>
 
 namespace RHI::Vulkan
 {
@@ -25,22 +29,102 @@ namespace RHI::Vulkan
             CLAMP_TO_BORDER,
         };
 
+        enum class CompareOp : uint8_t
+        {
+            NONE = 0,
+            NEVER,
+            LESS,
+            EQUAL,
+            LESS_OR_EQUAL,
+            GREATER,
+            NOT_EQUAL,
+            GREATER_OR_EQUAL,
+            ALWAYS,
+        };
+
+        enum class BorderColor : uint8_t
+        {
+            TRANSPARENT_BLACK = 0,
+            OPAQUE_BLACK,
+            OPAQUE_WHITE,
+        };
+
+        // 完整的采样器状态，作为SamplerCacheVK的键
+        struct Desc
+        {
+            MinFilter Min = Filter::LINEAR;
+            MagFilter Mag = Filter::LINEAR;
+            MipFilter Mip = Filter::LINEAR;
+            AddressMode AddressU = AddressMode::REPEAT;
+            AddressMode AddressV = AddressMode::REPEAT;
+            AddressMode AddressW = AddressMode::REPEAT;
+            CompareOp Compare = CompareOp::NONE;
+            BorderColor Border = BorderColor::OPAQUE_BLACK;
+            float MaxAnisotropy = 1.0f;
+            float MipLodBias = 0.0f;
+            float MinLod = 0.0f;
+            float MaxLod = VK_LOD_CLAMP_NONE;
+
+            bool operator==(const Desc& other) const = default;
+        };
+
+        struct DescHasher
+        {
+            size_t operator()(const Desc& desc) const;
+        };
+
         SamplerVK() = default;
         ~SamplerVK();
         SamplerVK(SamplerVK&& other) noexcept;
         SamplerVK& operator=(SamplerVK&& other) noexcept;
         SamplerVK(MinFilter minFilter, MagFilter magFilter, AddressMode uvwAddress, MipFilter mipFilter);
+        SamplerVK(const Desc& desc);
 
         void Init(MinFilter minFilter, MagFilter magFilter, AddressMode uvwAddress, MipFilter mipFilter);
+        void Init(const Desc& desc);
 
         const vk::Sampler& GetNativeSampler() const { return mSampler; }
-    
+        const Desc& GetDesc() const { return mDesc; }
+        BindlessIndex GetBindlessIndex() const { return mBindlessIndex; }
+
     private:
         void Destroy();
 
     private:
         vk::Sampler mSampler;
+        Desc mDesc;
+        BindlessIndex mBindlessIndex = InvalidBindlessIndex;
     };
 
     using SamplerVKReference = std::reference_wrapper<const SamplerVK>;
-}
\ No newline at end of file
+    using SamplerVKHandle = std::shared_ptr<const SamplerVK>;
+
+    // 按采样器状态去重的缓存，相同状态共享同一个vk::Sampler
+    class SamplerCacheVK
+    {
+    public:
+        void Init(uint32_t virtualFrameCount);
+        void Destroy();
+
+        SamplerVKHandle Acquire(const SamplerVK::Desc& desc);
+        // 每帧调用，销毁已经没有外部引用并且不再被GPU使用的采样器
+        void CollectUnused();
+
+        size_t GetSamplerCount() const { return mSamplers.size(); }
+        uint64_t GetHitCount() const { return mHitCount; }
+        uint64_t GetMissCount() const { return mMissCount; }
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<SamplerVK> Sampler;
+            uint64_t LastUsedFrame = 0;
+        };
+
+        std::unordered_map<SamplerVK::Desc, Entry, SamplerVK::DescHasher> mSamplers;
+        uint64_t mFrameCounter = 0;
+        uint32_t mVirtualFrameCount = 1;
+        uint64_t mHitCount = 0;
+        uint64_t mMissCount = 0;
+    };
+}
@@ -0,0 +1,67 @@
+#include "ShaderVK.hpp"
+
+#include "NullBackendVK.hpp"
+#include "Renderer/RendererBase.hpp"
+
+namespace RHI::Vulkan
+{
+    static vk::ShaderModule CreateShaderModule(const ShaderData::ByteCodeSPIRV& byteCode)
+    {
+        vk::ShaderModuleCreateInfo shaderModuleCI {};
+        shaderModuleCI.setCode(byteCode);
+        return CreateDeviceObject<vk::ShaderModule>([&]() { return GetCurrentRenderer().GetDevice().createShaderModule(shaderModuleCI); });
+    }
+
+    ComputeShaderVK::~ComputeShaderVK()
+    {
+        this->Destroy();
+    }
+
+    void ComputeShaderVK::Init(const ShaderData &computeShader)
+    {
+        this->Destroy();
+
+        this->mComputeShader = CreateShaderModule(computeShader.ByteCode);
+        for (const auto& uniformBlock : computeShader.UniformDescSets)
+        {
+            this->mShaderUniforms.push_back(ShaderUniforms{ uniformBlock, ShaderType::COMPUTE });
+        }
+    }
+
+    ComputeShaderVK::ComputeShaderVK(ComputeShaderVK &&other) noexcept
+    {
+        this->mComputeShader = other.mComputeShader;
+        this->mShaderUniforms = std::move(other.mShaderUniforms);
+
+        other.mComputeShader = vk::ShaderModule();
+    }
+
+    ComputeShaderVK &ComputeShaderVK::operator=(ComputeShaderVK &&other) noexcept
+    {
+        this->Destroy();
+
+        this->mComputeShader = other.mComputeShader;
+        this->mShaderUniforms = std::move(other.mShaderUniforms);
+
+        other.mComputeShader = vk::ShaderModule();
+
+        return *this;
+    }
+
+    const vk::ShaderModule &ComputeShaderVK::GetNativeShaderModule() const
+    {
+        return this->mComputeShader;
+    }
+
+    void ComputeShaderVK::Destroy()
+    {
+        if (this->mComputeShader)
+        {
+            // 句柄值可能被新的着色器模块复用，先淘汰用到它的管线
+            GetCurrentRenderer().GetPipelineCache().EvictShader(this->mComputeShader);
+            CallDevice([&]() { GetCurrentRenderer().GetDevice().destroyShaderModule(this->mComputeShader); });
+            this->mComputeShader = vk::ShaderModule();
+        }
+        this->mShaderUniforms.clear();
+    }
+}
@@ -33,6 +33,8 @@ namespace RHI::Vulkan
         virtual ArrayView<const TypeSPIRV> GetInputAttributes() const override { return mInputAttributes; }
         virtual ArrayView<const ShaderUniforms> GetShaderUniforms() const override { return mShaderUniforms; }
         virtual const vk::ShaderModule& GetNativeShaderModule() const override;
+        const vk::ShaderModule& GetNativeVertexModule() const { return mVertexShader; }
+        const vk::ShaderModule& GetNativeFragmentModule() const { return mPixelShader; }
 
     private:
         void Destroy();
@@ -0,0 +1,76 @@
+#include "TimestampQueryVK.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+
+namespace RHI::Vulkan
+{
+    void TimestampQueryVK::Init(uint32_t queryCount, uint32_t virtualFrameCount)
+    {
+        this->Destroy();
+
+        auto& renderer = GetCurrentRenderer();
+        mQueryCount = queryCount;
+        mResults.assign((size_t)queryCount * 2, 0);
+        mTimestampPeriod = renderer.GetPhysicalDeviceProperties().limits.timestampPeriod;
+        // 空后端不创建查询池，所有查询都视为没有写入
+        if (renderer.IsNullBackend()) { return; }
+
+        // 图形队列族不支持时间戳时同样不创建查询池，否则按有效位数截断读回的值
+        uint32_t validBits = renderer.GetPhysicalDevice().getQueueFamilyProperties()[renderer.GetQueueFamilyIndex()].timestampValidBits;
+        if (validBits == 0)
+        {
+            GDebugInfoCallback("Timestamp", "Graphics queue family does not support timestamps, GPU timings are disabled");
+            return;
+        }
+        mTimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+        vk::QueryPoolCreateInfo queryPoolCI {};
+        queryPoolCI.setQueryType(vk::QueryType::eTimestamp);
+        queryPoolCI.setQueryCount(queryCount);
+        for (uint32_t frame = 0; frame < virtualFrameCount; frame++)
+        {
+            auto queryPool = renderer.GetDevice().createQueryPool(queryPoolCI);
+            // 从未写入的查询池读取结果前也需要重置
+            renderer.GetDevice().resetQueryPool(queryPool, 0, queryCount);
+            mQueryPools.push_back(queryPool);
+        }
+    }
+
+    void TimestampQueryVK::Destroy()
+    {
+        auto& device = GetCurrentRenderer().GetDevice();
+        for (auto queryPool : mQueryPools) { device.destroyQueryPool(queryPool); }
+        mQueryPools.clear();
+        mResults.clear();
+        mQueryCount = 0;
+    }
+
+    void TimestampQueryVK::StartFrame(CommandBufferVK &commands, size_t frameIndex)
+    {
+        mCurrentFrame = frameIndex;
+        std::fill(mResults.begin(), mResults.end(), 0);
+        if (mQueryPools.empty()) { return; }
+
+        auto queryPool = mQueryPools[frameIndex];
+        (void)GetCurrentRenderer().GetDevice().getQueryPoolResults(queryPool, 0, mQueryCount, mResults.size() * sizeof(uint64_t), mResults.data(),
+            2 * sizeof(uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+        commands.ResetQueries(queryPool, 0, mQueryCount);
+    }
+
+    void TimestampQueryVK::WriteTimestamp(CommandBufferVK &commands, uint32_t query)
+    {
+        if (mQueryPools.empty() || query >= mQueryCount) { return; }
+        commands.WriteTimestamp(mQueryPools[mCurrentFrame], query);
+    }
+
+    double TimestampQueryVK::GetElapsedMilliseconds(uint32_t beginQuery, uint32_t endQuery) const
+    {
+        if (beginQuery >= mQueryCount || endQuery >= mQueryCount) { return -1.0; }
+        if (mResults[beginQuery * 2 + 1] == 0 || mResults[endQuery * 2 + 1] == 0) { return -1.0; }
+
+        uint64_t ticks = ((mResults[endQuery * 2] & mTimestampMask) - (mResults[beginQuery * 2] & mTimestampMask)) & mTimestampMask;
+        return (double)ticks * mTimestampPeriod / 1000000.0;
+    }
+}
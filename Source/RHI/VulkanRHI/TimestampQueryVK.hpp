@@ -0,0 +1,36 @@
+#pragma once
+
+#include "RHI/RHICommon.hpp"
+#include "CommandBufferVK.hpp"
+
+#include <vector>
+
+namespace RHI::Vulkan
+{
+    // 每个虚拟帧一个时间戳查询池，该虚拟帧的Fence触发后读取上一轮写入的结果，不会阻塞等待GPU
+    class TimestampQueryVK
+    {
+    public:
+        void Init(uint32_t queryCount, uint32_t virtualFrameCount);
+        void Destroy();
+
+        // 在帧的第一个命令缓冲上、任何WriteTimestamp之前调用，读取上一轮的结果后重置本帧的查询
+        void StartFrame(CommandBufferVK& commands, size_t frameIndex);
+        // 只能写入图形队列族的命令缓冲，mTimestampMask取自该队列族的timestampValidBits
+        void WriteTimestamp(CommandBufferVK& commands, uint32_t query);
+        // 上一轮两个查询之间的GPU时间，任一查询没有写入时返回负数
+        double GetElapsedMilliseconds(uint32_t beginQuery, uint32_t endQuery) const;
+
+        uint32_t GetQueryCount() const { return mQueryCount; }
+
+    private:
+        std::vector<vk::QueryPool> mQueryPools;
+        // 每个查询的结果和可用性各占一个64位值
+        std::vector<uint64_t> mResults;
+        uint32_t mQueryCount = 0;
+        size_t mCurrentFrame = 0;
+        double mTimestampPeriod = 0.0;
+        // 队列族的timestampValidBits之外的位是未定义的
+        uint64_t mTimestampMask = ~0ull;
+    };
+}
@@ -0,0 +1,269 @@
+#include "VirtualFrameVk.hpp"
+
+#include "Renderer/RendererBase.hpp"
+
+#include <algorithm>
+
+namespace RHI::Vulkan
+{
+    void VirtualFrameProvider::Init(size_t frameCount, size_t stageBufferSize)
+    {
+        auto& renderer = GetCurrentRenderer();
+        auto& device = renderer.GetDevice();
+
+        mVirtualFrames.reserve(frameCount);
+        for (size_t i = 0; i < frameCount; i++)
+        {
+            auto fence = renderer.IsNullBackend() ? vk::Fence{ } : device.createFence(vk::FenceCreateInfo{ vk::FenceCreateFlagBits::eSignaled });
+            auto imageAvailable = renderer.IsNullBackend() ? vk::Semaphore{ } : device.createSemaphore({});
+            mVirtualFrames.push_back(VirtualFrame{ CommandBufferVK{ vk::CommandBuffer{ } }, StageBufferVK{ stageBufferSize }, fence, imageAvailable });
+
+            auto& frame = mVirtualFrames.back();
+            frame.Descriptors.Init();
+            frame.CommandPool.Init(renderer.GetQueueFamilyIndex());
+            frame.Commands = CommandBufferVK{ frame.CommandPool.Acquire() };
+            if (renderer.IsAsyncComputeEnabled()) { frame.ComputeCommandPool.Init(renderer.GetComputeQueueFamilyIndex()); }
+        }
+        mCurrentFrame = 0;
+
+        if (!renderer.IsNullBackend())
+        {
+            vk::SemaphoreTypeCreateInfo semaphoreTypeCI {};
+            semaphoreTypeCI.setSemaphoreType(vk::SemaphoreType::eTimeline);
+            semaphoreTypeCI.setInitialValue(0);
+
+            vk::SemaphoreCreateInfo semaphoreCI {};
+            semaphoreCI.setPNext(&semaphoreTypeCI);
+            mTimelineSemaphore = device.createSemaphore(semaphoreCI);
+        }
+        mTimelineValue = 0;
+        mPendingTimelineWait = 0;
+    }
+
+    void VirtualFrameProvider::Destroy()
+    {
+        auto& device = GetCurrentRenderer().GetDevice();
+        for (auto& frame : mVirtualFrames)
+        {
+            if (frame.CommandQueueFence) { device.destroyFence(frame.CommandQueueFence); }
+            if (frame.ImageAvailableSemaphore) { device.destroySemaphore(frame.ImageAvailableSemaphore); }
+            frame.Descriptors.Destroy();
+            frame.CommandPool.Destroy();
+            frame.ComputeCommandPool.Destroy();
+        }
+        mVirtualFrames.clear();
+
+        if (mTimelineSemaphore) { device.destroySemaphore(mTimelineSemaphore); }
+        mTimelineSemaphore = vk::Semaphore { };
+        for (auto semaphore : mPresentSemaphores) { device.destroySemaphore(semaphore); }
+        mPresentSemaphores.clear();
+    }
+
+    void VirtualFrameProvider::StartFrame()
+    {
+        auto& renderer = GetCurrentRenderer();
+        auto& device = renderer.GetDevice();
+        auto& frame = this->GetCurrentFrame();
+
+        // 空后端的提交立即完成，不需要等待和获取交换链图像
+        if (!renderer.IsNullBackend())
+        {
+            (void)device.waitForFences(frame.CommandQueueFence, true, UINT64_MAX);
+
+            auto acquireNextImage = device.acquireNextImageKHR(renderer.GetSwapchain(), UINT64_MAX, frame.ImageAvailableSemaphore, vk::Fence{ });
+            if (acquireNextImage.result != vk::Result::eSuccess && acquireNextImage.result != vk::Result::eSuboptimalKHR)
+            {
+                mbIsFrameRunning = false;
+                return;
+            }
+            mPresentImageIndex = acquireNextImage.value;
+
+            device.resetFences(frame.CommandQueueFence);
+        }
+
+        // 该帧的GPU工作已经全部完成，可以整体回收临时资源
+        frame.StagingBuffer.Reset();
+        frame.Descriptors.Reset();
+        // 重置后第一个分配的仍是上一轮的主命令缓冲
+        frame.CommandPool.Reset();
+        frame.ComputeCommandPool.Reset();
+        frame.Commands = CommandBufferVK{ frame.CommandPool.Acquire() };
+        frame.Commands.Begin();
+        mFrameStats = CommandBufferStats { };
+
+        mbIsFrameRunning = true;
+        mbImageAvailableWaited = false;
+    }
+
+    VirtualFrame &VirtualFrameProvider::GetCurrentFrame()
+    {
+        return mVirtualFrames[mCurrentFrame];
+    }
+
+    VirtualFrame &VirtualFrameProvider::GetNextFrame()
+    {
+        return mVirtualFrames[(mCurrentFrame + 1) % mVirtualFrames.size()];
+    }
+
+    const VirtualFrame &VirtualFrameProvider::GetCurrentFrame() const
+    {
+        return mVirtualFrames[mCurrentFrame];
+    }
+
+    const VirtualFrame &VirtualFrameProvider::GetNextFrame() const
+    {
+        return mVirtualFrames[(mCurrentFrame + 1) % mVirtualFrames.size()];
+    }
+
+    uint32_t VirtualFrameProvider::GetPresentImageIndex() const
+    {
+        return mPresentImageIndex;
+    }
+
+    bool VirtualFrameProvider::IsFrameRunning() const
+    {
+        return mbIsFrameRunning;
+    }
+
+    size_t VirtualFrameProvider::GetFrameCount() const
+    {
+        return mVirtualFrames.size();
+    }
+
+    void VirtualFrameProvider::EndFrame()
+    {
+        auto& frame = this->GetCurrentFrame();
+
+        frame.StagingBuffer.Flush();
+        this->SubmitGraphics(true);
+        mLastFrameStats = mFrameStats;
+
+        mCurrentFrame = (mCurrentFrame + 1) % mVirtualFrames.size();
+        mbIsFrameRunning = false;
+    }
+
+    uint64_t VirtualFrameProvider::SubmitCommands()
+    {
+        auto& frame = this->GetCurrentFrame();
+        this->SubmitGraphics(false);
+
+        frame.Commands = CommandBufferVK{ frame.CommandPool.Acquire() };
+        frame.Commands.Begin();
+        return mTimelineValue;
+    }
+
+    CommandBufferVK VirtualFrameProvider::AcquireComputeCommands()
+    {
+        CommandBufferVK commands { this->GetCurrentFrame().ComputeCommandPool.Acquire() };
+        // 专用计算队列只支持计算和传输阶段
+        commands.RestrictPipelineStages(vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eDrawIndirect |
+            vk::PipelineStageFlagBits2::eCopy | vk::PipelineStageFlagBits2::eClear);
+        return commands;
+    }
+
+    uint64_t VirtualFrameProvider::SubmitAsyncCompute(const CommandBufferVK &commands, uint64_t waitValue)
+    {
+        auto& renderer = GetCurrentRenderer();
+        mTimelineValue++;
+        if (renderer.IsNullBackend()) { return mTimelineValue; }
+
+        vk::SemaphoreSubmitInfo waitInfo {};
+        waitInfo.setSemaphore(mTimelineSemaphore);
+        waitInfo.setValue(waitValue);
+        waitInfo.setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+
+        vk::SemaphoreSubmitInfo signalInfo {};
+        signalInfo.setSemaphore(mTimelineSemaphore);
+        signalInfo.setValue(mTimelineValue);
+        signalInfo.setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+
+        vk::CommandBufferSubmitInfo cmdBufferInfo {};
+        cmdBufferInfo.setCommandBuffer(commands.GetNativeCmdBuffer());
+
+        vk::SubmitInfo2 submitInfo {};
+        submitInfo.setWaitSemaphoreInfos(waitInfo);
+        submitInfo.setCommandBufferInfos(cmdBufferInfo);
+        submitInfo.setSignalSemaphoreInfos(signalInfo);
+        renderer.GetComputeQueue().submit2(submitInfo);
+        return mTimelineValue;
+    }
+
+    void VirtualFrameProvider::WaitTimeline(uint64_t value)
+    {
+        mPendingTimelineWait = std::max(mPendingTimelineWait, value);
+    }
+
+    void VirtualFrameProvider::SubmitGraphics(bool endOfFrame)
+    {
+        auto& renderer = GetCurrentRenderer();
+        auto& frame = this->GetCurrentFrame();
+
+        frame.Commands.End();
+        mFrameStats += frame.Commands.GetStats();
+        mTimelineValue++;
+        if (renderer.IsNullBackend()) { return; }
+
+        std::vector<vk::SemaphoreSubmitInfo> waitInfos;
+        std::vector<vk::SemaphoreSubmitInfo> signalInfos;
+        if (mPendingTimelineWait != 0)
+        {
+            vk::SemaphoreSubmitInfo waitInfo {};
+            waitInfo.setSemaphore(mTimelineSemaphore);
+            waitInfo.setValue(mPendingTimelineWait);
+            waitInfo.setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+            waitInfos.push_back(waitInfo);
+            mPendingTimelineWait = 0;
+        }
+
+        vk::SemaphoreSubmitInfo timelineSignalInfo {};
+        timelineSignalInfo.setSemaphore(mTimelineSemaphore);
+        timelineSignalInfo.setValue(mTimelineValue);
+        timelineSignalInfo.setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+        signalInfos.push_back(timelineSignalInfo);
+
+        // 帧内提前提交的命令也可能写交换链图像（例如与异步计算重叠的Pass），因此由第一次提交等待acquire
+        // 只有写入交换链图像的阶段需要等待，之前的阶段可以提前执行
+        if (!mbImageAvailableWaited)
+        {
+            vk::SemaphoreSubmitInfo waitInfo {};
+            waitInfo.setSemaphore(frame.ImageAvailableSemaphore);
+            waitInfo.setStageMask(vk::PipelineStageFlagBits2::eColorAttachmentOutput | vk::PipelineStageFlagBits2::eCopy | vk::PipelineStageFlagBits2::eBlit);
+            waitInfos.push_back(waitInfo);
+            mbImageAvailableWaited = true;
+        }
+
+        vk::Semaphore presentSemaphore = endOfFrame ? this->GetPresentSemaphore(mPresentImageIndex) : vk::Semaphore{ };
+        if (endOfFrame)
+        {
+            vk::SemaphoreSubmitInfo signalInfo {};
+            signalInfo.setSemaphore(presentSemaphore);
+            signalInfo.setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+            signalInfos.push_back(signalInfo);
+        }
+
+        vk::CommandBufferSubmitInfo cmdBufferInfo {};
+        cmdBufferInfo.setCommandBuffer(frame.Commands.GetNativeCmdBuffer());
+
+        vk::SubmitInfo2 submitInfo {};
+        submitInfo.setWaitSemaphoreInfos(waitInfos);
+        submitInfo.setCommandBufferInfos(cmdBufferInfo);
+        submitInfo.setSignalSemaphoreInfos(signalInfos);
+        renderer.GetDeviceQueue().submit2(submitInfo, endOfFrame ? frame.CommandQueueFence : vk::Fence { });
+
+        if (endOfFrame)
+        {
+            vk::PresentInfoKHR presentInfo {};
+            presentInfo.setWaitSemaphores(presentSemaphore);
+            presentInfo.setSwapchains(renderer.GetSwapchain());
+            presentInfo.setImageIndices(mPresentImageIndex);
+            (void)renderer.GetDeviceQueue().presentKHR(presentInfo);
+        }
+    }
+
+    vk::Semaphore VirtualFrameProvider::GetPresentSemaphore(uint32_t imageIndex)
+    {
+        auto& device = GetCurrentRenderer().GetDevice();
+        while (mPresentSemaphores.size() <= imageIndex) { mPresentSemaphores.push_back(device.createSemaphore({})); }
+        return mPresentSemaphores[imageIndex];
+    }
+}
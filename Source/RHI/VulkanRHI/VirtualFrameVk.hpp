@@ -2,7 +2,9 @@
 
 #include "RHI/RHICommon.hpp"
 #include "CommandBufferVK.hpp"
+#include "CommandPoolVK.hpp"
 #include "BufferVK.hpp"
+#include "DescriptorVK.hpp"
 
 namespace RHI::Vulkan
 {
@@ -13,6 +15,13 @@ namespace RHI::Vulkan
         CommandBufferVK Commands{ vk::CommandBuffer{ } };
         StageBufferVK StagingBuffer;
         vk::Fence CommandQueueFence;
+        // 每帧独立的acquire信号量，Fence触发后上一轮对它的等待一定已经完成
+        vk::Semaphore ImageAvailableSemaphore;
+        DescriptorAllocatorVK Descriptors;
+        // Commands和本帧其余命令缓冲都从这里分配，Fence触发后整体重置
+        CommandPoolVK CommandPool;
+        // 异步计算的命令缓冲，只在存在独立计算队列族时初始化
+        CommandPoolVK ComputeCommandPool;
     };
 
     class VirtualFrameProvider
@@ -27,14 +36,38 @@ namespace RHI::Vulkan
         const VirtualFrame& GetCurrentFrame() const;
         const VirtualFrame& GetNextFrame() const;
         uint32_t GetPresentImageIndex() const;
+        size_t GetCurrentFrameIndex() const { return mCurrentFrame; }
         bool IsFrameRunning() const;
         size_t GetFrameCount() const;
+        // 上一帧所有图形命令缓冲的统计，例如实际提交的屏障数量
+        const CommandBufferStats& GetLastFrameStats() const { return mLastFrameStats; }
         void EndFrame();
 
+        // 提交本帧目前录制的图形命令，之后的命令录制到新的主命令缓冲上，返回这次提交完成时时间线信号量的值
+        // 本帧第一次图形提交等待交换链图像，只有写交换链图像的阶段会因此阻塞
+        uint64_t SubmitCommands();
+        CommandBufferVK AcquireComputeCommands();
+        // 在计算队列上等待时间线信号量到达waitValue后执行，返回完成时的值
+        uint64_t SubmitAsyncCompute(const CommandBufferVK& commands, uint64_t waitValue);
+        // 下一次图形提交等待时间线信号量到达value，帧末的Fence因此也覆盖异步计算
+        void WaitTimeline(uint64_t value);
+
+    private:
+        void SubmitGraphics(bool endOfFrame);
+        vk::Semaphore GetPresentSemaphore(uint32_t imageIndex);
+
     private:
         std::vector<VirtualFrame> mVirtualFrames;
         uint32_t mPresentImageIndex = 0;
         bool mbIsFrameRunning = false;
+        bool mbImageAvailableWaited = false;
         size_t mCurrentFrame = 0;
+        CommandBufferStats mLastFrameStats;
+        CommandBufferStats mFrameStats;
+        vk::Semaphore mTimelineSemaphore;
+        // present的等待没有Fence可以确认完成，按交换链图像分配，同一图像再次被acquire时上一次present已经结束
+        std::vector<vk::Semaphore> mPresentSemaphores;
+        uint64_t mTimelineValue = 0;
+        uint64_t mPendingTimelineWait = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,1759 @@
+#include "RenderGraph.hpp"
+#include "RendererBase.hpp"
+#include "RHI/VulkanRHI/CommonVK.hpp"
+#include "RHI/VulkanRHI/NullBackendVK.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <functional>
+#include <queue>
+
+namespace Renderer
+{
+    using namespace RHI;
+    using namespace RHI::Vulkan;
+
+    static bool IsLoadState(AttachmentState state)
+    {
+        return state == AttachmentState::LOAD_COLOR || state == AttachmentState::LOAD_DEPTH_STENCIL;
+    }
+
+    static bool IsAttachmentUsage(uint32_t usage)
+    {
+        return usage == ImageUsage::COLOR_ATTACHMENT || usage == ImageUsage::DEPTH_STENCIL_ATTACHMENT || usage == ImageUsage::INPUT_ATTACHMENT;
+    }
+
+    static void AddUnique(std::vector<uint32_t>& indices, uint32_t index)
+    {
+        if (std::find(indices.begin(), indices.end(), index) == indices.end()) { indices.push_back(index); }
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        this->Destroy();
+    }
+
+    void RenderGraph::Destroy()
+    {
+        this->Reset();
+        mCachedPasses.clear();
+        mCachedResources.clear();
+        mCachedResourceLookup.clear();
+        mbHasCompiledGraph = false;
+        mTimestamps.Destroy();
+        mTimedPasses.clear();
+        this->DestroyMergedRenderPasses();
+        this->ReleaseUnusedRenderPasses();
+        this->DestroyTransientImages();
+    }
+
+    void RenderGraph::Reset()
+    {
+        // 执行顺序、屏障等编译结果留在成员中，结构不变时下一帧直接使用
+        std::swap(mPasses, mCachedPasses);
+        std::swap(mResources, mCachedResources);
+        std::swap(mResourceLookup, mCachedResourceLookup);
+        mPasses.clear();
+        mResources.clear();
+        mResourceLookup.clear();
+        mbCompiled = false;
+    }
+
+    void RenderGraph::SetRenderExtent(uint32_t width, uint32_t height)
+    {
+        mRenderWidth = width;
+        mRenderHeight = height;
+        mbCompiled = false;
+    }
+
+    uint32_t RenderGraph::FindOrAddResource(const std::string &name, bool isBuffer)
+    {
+        auto it = mResourceLookup.find(name);
+        if (it != mResourceLookup.end())
+        {
+            assert(mResources[it->second].bIsBuffer == isBuffer);
+            return it->second;
+        }
+
+        uint32_t index = (uint32_t)mResources.size();
+        auto& resource = mResources.emplace_back();
+        resource.Name = name;
+        resource.bIsBuffer = isBuffer;
+        mResourceLookup.emplace(name, index);
+        return index;
+    }
+
+    void RenderGraph::ImportImage(const std::string &name, const ImageVK &image, ImageUsage::Bits finalUsage)
+    {
+        auto& resource = mResources[this->FindOrAddResource(name, false)];
+        resource.Image = &image;
+        resource.FinalUsage = finalUsage;
+        resource.bIsOutput |= finalUsage != ImageUsage::UNKNOWN;
+        mbCompiled = false;
+    }
+
+    void RenderGraph::ImportBuffer(const std::string &name, const BufferVK &buffer, BufferUsage::Bits finalUsage)
+    {
+        auto& resource = mResources[this->FindOrAddResource(name, true)];
+        resource.Buffer = &buffer;
+        resource.FinalUsage = finalUsage;
+        resource.bIsOutput |= finalUsage != BufferUsage::UNKNOWN;
+        mbCompiled = false;
+    }
+
+    void RenderGraph::MarkOutput(const std::string &name)
+    {
+        auto it = mResourceLookup.find(name);
+        assert(it != mResourceLookup.end());
+        mResources[it->second].bIsOutput = true;
+        mbCompiled = false;
+    }
+
+    uint32_t RenderGraph::AddPass(const std::string &name, const PipelineVK &pipeline, const NativeRenderPass &renderPass, RecordFunction record, PassFlags::Value flags)
+    {
+        auto& pass = mPasses.emplace_back();
+        pass.Name = name;
+        pass.Pipeline = &pipeline;
+        pass.RenderPass = renderPass;
+        pass.Record = std::move(record);
+        pass.Flags = flags;
+        mbCompiled = false;
+        return (uint32_t)mPasses.size() - 1;
+    }
+
+    void RenderGraph::SetPassPipelineResolver(uint32_t passIndex, PipelineResolver resolver)
+    {
+        mPasses[passIndex].ResolvePipeline = std::move(resolver);
+        mbCompiled = false;
+    }
+
+    void RenderGraph::Compile()
+    {
+        size_t hash = this->ComputeStructureHash();
+        if (mbHasCompiledGraph && hash == mCompiledHash && this->CanRestoreCompiledGraph())
+        {
+            this->RestoreCompiledGraph();
+            mStats.bFromCache = true;
+        }
+        else
+        {
+            mStats = RenderGraphStats {};
+            mStats.DeclaredPasses = (uint32_t)mPasses.size();
+
+            this->CollectAccesses();
+            this->BuildDependencies();
+            this->CullPasses();
+            this->SortPasses();
+            this->ScheduleQueues();
+            this->ComputeLifetimes();
+            this->MergeSubpasses();
+            this->CreateTransientImages();
+            this->ComputeBarriers();
+            this->BuildMergedRenderPasses();
+            this->CountBarriers();
+
+            mCompiledHash = hash;
+            mbHasCompiledGraph = true;
+        }
+
+        // 附件图像此时已经确定，动态渲染信息只需要在编译时填充一次
+        auto getAttachment = [this](const std::string& name) -> const ImageVK& { return this->GetImage(name); };
+        for (uint32_t passIndex : mExecutionOrder)
+        {
+            auto& pass = mPasses[passIndex];
+            if (!pass.Pipeline->GetOutputAttachments().empty() && !pass.RenderPass.RenderPassHandle && pass.MergedGroup == InvalidIndex)
+            {
+                SetupDynamicRendering(pass.RenderPass, *pass.Pipeline, getAttachment);
+            }
+        }
+        this->SetupMergedRenderPasses();
+        mbCompiled = true;
+    }
+
+    size_t RenderGraph::ComputeStructureHash() const
+    {
+        // 只包含影响编译结果的声明，导入资源的句柄和Pass的录制函数每帧都可以不同
+        // 导入图像的格式和尺寸决定屏障的子资源范围和子通道合并，需要一起哈希
+        size_t hash = 0;
+        Utilities::HashCombine(hash, mRenderWidth);
+        Utilities::HashCombine(hash, mRenderHeight);
+        Utilities::HashCombine(hash, GetCurrentRenderer().IsAsyncComputeEnabled());
+        Utilities::HashCombine(hash, mbSubpassMerging);
+
+        for (const auto& resource : mResources)
+        {
+            Utilities::HashCombine(hash, resource.Name);
+            Utilities::HashCombine(hash, resource.bIsBuffer);
+            Utilities::HashCombine(hash, resource.bIsOutput);
+            Utilities::HashCombine(hash, resource.FinalUsage);
+            if (resource.Image != nullptr && !resource.bTransient)
+            {
+                Utilities::HashCombine(hash, resource.Image->GetFormat());
+                Utilities::HashCombine(hash, resource.Image->GetWidth());
+                Utilities::HashCombine(hash, resource.Image->GetHeight());
+                Utilities::HashCombine(hash, resource.Image->GetMipLevelCount());
+                Utilities::HashCombine(hash, resource.Image->GetLayerCount());
+            }
+        }
+
+        for (const auto& pass : mPasses)
+        {
+            const auto& pipeline = *pass.Pipeline;
+            Utilities::HashCombine(hash, pass.Flags);
+            Utilities::HashCombine(hash, (bool)pass.RenderPass.RenderPassHandle);
+            Utilities::HashCombine(hash, (bool)pass.ResolvePipeline);
+            for (const auto& attachment : pipeline.GetOutputAttachments())
+            {
+                Utilities::HashCombine(hash, attachment.Name);
+                Utilities::HashCombine(hash, attachment.OnLoad);
+                Utilities::HashCombine(hash, attachment.Layer);
+            }
+            for (const auto& dependency : pipeline.GetImageDependencies())
+            {
+                Utilities::HashCombine(hash, dependency.Name);
+                Utilities::HashCombine(hash, dependency.Usage);
+            }
+            for (const auto& dependency : pipeline.GetBufferDependencies())
+            {
+                Utilities::HashCombine(hash, dependency.Name);
+                Utilities::HashCombine(hash, dependency.Usage);
+            }
+            for (const auto& declaration : pipeline.GetAttachmentDeclarations())
+            {
+                Utilities::HashCombine(hash, declaration.Name);
+                Utilities::HashCombine(hash, declaration.ImageFormat);
+                Utilities::HashCombine(hash, declaration.Width);
+                Utilities::HashCombine(hash, declaration.Height);
+                Utilities::HashCombine(hash, declaration.Options);
+            }
+            // 加入各类声明的数量，避免声明在相邻Pass之间移动时哈希不变
+            Utilities::HashCombine(hash, pipeline.GetOutputAttachments().size());
+            Utilities::HashCombine(hash, pipeline.GetImageDependencies().size());
+            Utilities::HashCombine(hash, pipeline.GetBufferDependencies().size());
+            Utilities::HashCombine(hash, pipeline.GetAttachmentDeclarations().size());
+        }
+        return hash;
+    }
+
+    bool RenderGraph::CanRestoreCompiledGraph() const
+    {
+        // 哈希碰撞时结构可能不同，恢复前确认缓存的表能按本帧的下标访问
+        if (mCachedPasses.size() != mPasses.size() || mCachedResources.size() < mResources.size()) { return false; }
+        for (uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mCachedResources.size(); resourceIndex++)
+        {
+            const auto& cached = mCachedResources[resourceIndex];
+            if (resourceIndex < (uint32_t)mResources.size())
+            {
+                const auto& resource = mResources[resourceIndex];
+                if (cached.Name != resource.Name || cached.bIsBuffer != resource.bIsBuffer) { return false; }
+            }
+            // 编译时才加入的资源只能是瞬态图像或未导入的资源，上一次导入而本帧没有导入的资源会留下失效的句柄
+            else if (!cached.bTransient && (cached.Image != nullptr || cached.Buffer != nullptr))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void RenderGraph::RestoreCompiledGraph()
+    {
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            auto& pass = mPasses[passIndex];
+            auto& cached = mCachedPasses[passIndex];
+            std::swap(pass.Accesses, cached.Accesses);
+            std::swap(pass.Barriers, cached.Barriers);
+            std::swap(pass.Dependencies, cached.Dependencies);
+            std::swap(pass.Producers, cached.Producers);
+            std::swap(pass.Acquires, cached.Acquires);
+            pass.bCulled = cached.bCulled;
+            pass.bAsyncCompute = cached.bAsyncCompute;
+            pass.MergedGroup = cached.MergedGroup;
+            pass.Subpass = cached.Subpass;
+        }
+
+        // 本帧的资源表只有导入资源，顺序与上一次相同，把新的句柄写回缓存的资源表后整体换入
+        for (uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mResources.size(); resourceIndex++)
+        {
+            auto& cached = mCachedResources[resourceIndex];
+            cached.Image = mResources[resourceIndex].Image;
+            cached.Buffer = mResources[resourceIndex].Buffer;
+        }
+        std::swap(mResources, mCachedResources);
+        std::swap(mResourceLookup, mCachedResourceLookup);
+    }
+
+    void RenderGraph::CollectAccesses()
+    {
+        for (auto& pass : mPasses)
+        {
+            pass.Accesses.clear();
+            const auto& pipeline = *pass.Pipeline;
+
+            for (const auto& declaration : pipeline.GetAttachmentDeclarations())
+            {
+                auto& resource = mResources[this->FindOrAddResource(declaration.Name, false)];
+                // 同名的导入图像优先，声明只对图内部创建的瞬态图像生效
+                if (resource.Image != nullptr && !resource.bTransient) { continue; }
+                resource.bTransient = true;
+                resource.Declaration = declaration;
+            }
+
+            for (const auto& attachment : pipeline.GetOutputAttachments())
+            {
+                ResourceAccess access {};
+                access.Resource = this->FindOrAddResource(attachment.Name, false);
+                access.Usage = AttachmentStateToImageUsage(attachment.OnLoad);
+                access.bRead = IsLoadState(attachment.OnLoad);
+                access.bWrite = true;
+                pass.Accesses.push_back(access);
+            }
+
+            for (const auto& dependency : pipeline.GetImageDependencies())
+            {
+                ResourceAccess access {};
+                access.Resource = this->FindOrAddResource(dependency.Name, false);
+                access.Usage = dependency.Usage;
+                access.bWrite = HasImageWriteDependency(dependency.Usage);
+                // 存储图像可能读写同时发生，保守地视为读
+                access.bRead = dependency.Usage != ImageUsage::TRANSFER_DESTINATION;
+                pass.Accesses.push_back(access);
+            }
+
+            for (const auto& dependency : pipeline.GetBufferDependencies())
+            {
+                ResourceAccess access {};
+                access.Resource = this->FindOrAddResource(dependency.Name, true);
+                access.Usage = dependency.Usage;
+                access.bWrite = HasBufferWriteDependency(dependency.Usage);
+                access.bRead = dependency.Usage != BufferUsage::TRANSFER_DESTINATION;
+                pass.Accesses.push_back(access);
+            }
+
+            for (const auto& access : pass.Accesses)
+            {
+                auto& resource = mResources[access.Resource];
+                if (!resource.bIsBuffer) { resource.UsageFlags |= access.Usage; }
+            }
+        }
+    }
+
+    void RenderGraph::BuildDependencies()
+    {
+        std::vector<uint32_t> lastWriters(mResources.size(), InvalidIndex);
+        std::vector<std::vector<uint32_t>> readers(mResources.size());
+
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            auto& pass = mPasses[passIndex];
+            pass.Dependencies.clear();
+            pass.Producers.clear();
+
+            // 先处理本Pass的全部读取，再更新写入，避免同一Pass内的读写被当成自身依赖
+            for (const auto& access : pass.Accesses)
+            {
+                uint32_t writer = lastWriters[access.Resource];
+                if (access.bRead && writer != InvalidIndex && writer != passIndex)
+                {
+                    AddUnique(pass.Dependencies, writer);
+                    AddUnique(pass.Producers, writer);
+                }
+                if (access.bWrite)
+                {
+                    if (writer != InvalidIndex && writer != passIndex) { AddUnique(pass.Dependencies, writer); }
+                    for (uint32_t reader : readers[access.Resource])
+                    {
+                        if (reader != passIndex) { AddUnique(pass.Dependencies, reader); }
+                    }
+                }
+            }
+
+            for (const auto& access : pass.Accesses)
+            {
+                if (access.bWrite)
+                {
+                    lastWriters[access.Resource] = passIndex;
+                    readers[access.Resource].clear();
+                }
+                else if (access.bRead)
+                {
+                    AddUnique(readers[access.Resource], passIndex);
+                }
+            }
+        }
+    }
+
+    void RenderGraph::CullPasses()
+    {
+        // 从图的输出资源的最后写入者和NEVER_CULL的Pass出发，沿RAW依赖反向标记存活的Pass
+        std::vector<uint32_t> lastWriters(mResources.size(), InvalidIndex);
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            for (const auto& access : mPasses[passIndex].Accesses)
+            {
+                if (access.bWrite) { lastWriters[access.Resource] = passIndex; }
+            }
+        }
+
+        std::vector<uint32_t> pending;
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            if (mPasses[passIndex].Flags & PassFlags::NEVER_CULL) { pending.push_back(passIndex); }
+        }
+        for (uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mResources.size(); resourceIndex++)
+        {
+            uint32_t writer = lastWriters[resourceIndex];
+            if (mResources[resourceIndex].bIsOutput && writer != InvalidIndex) { pending.push_back(writer); }
+        }
+
+        std::vector<bool> alive(mPasses.size(), false);
+        while (!pending.empty())
+        {
+            uint32_t passIndex = pending.back();
+            pending.pop_back();
+            if (alive[passIndex]) { continue; }
+            alive[passIndex] = true;
+            for (uint32_t producer : mPasses[passIndex].Producers) { pending.push_back(producer); }
+        }
+
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            mPasses[passIndex].bCulled = !alive[passIndex];
+            if (!alive[passIndex]) { mStats.CulledPasses++; }
+        }
+    }
+
+    void RenderGraph::SortPasses()
+    {
+        // Kahn拓扑排序，同时就绪的Pass按声明顺序执行，保证结果稳定
+        std::vector<uint32_t> inDegrees(mPasses.size(), 0);
+        std::vector<std::vector<uint32_t>> successors(mPasses.size());
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            const auto& pass = mPasses[passIndex];
+            if (pass.bCulled) { continue; }
+            for (uint32_t dependency : pass.Dependencies)
+            {
+                if (mPasses[dependency].bCulled) { continue; }
+                successors[dependency].push_back(passIndex);
+                inDegrees[passIndex]++;
+            }
+        }
+
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            if (!mPasses[passIndex].bCulled && inDegrees[passIndex] == 0) { ready.push(passIndex); }
+        }
+
+        mExecutionOrder.clear();
+        while (!ready.empty())
+        {
+            uint32_t passIndex = ready.top();
+            ready.pop();
+            mExecutionOrder.push_back(passIndex);
+            for (uint32_t successor : successors[passIndex])
+            {
+                if (--inDegrees[successor] == 0) { ready.push(successor); }
+            }
+        }
+        assert(mExecutionOrder.size() + mStats.CulledPasses == mPasses.size());
+    }
+
+    void RenderGraph::ScheduleQueues()
+    {
+        for (auto& pass : mPasses) { pass.bAsyncCompute = false; }
+        for (auto& resource : mResources) { resource.bAsyncAccess = false; }
+        mPreAsyncCount = 0;
+        mAsyncCount = 0;
+        mOverlapCount = 0;
+
+        // 没有独立计算队列时所有Pass按拓扑顺序在图形队列上执行
+        if (!GetCurrentRenderer().IsAsyncComputeEnabled()) { return; }
+
+        uint32_t passCount = (uint32_t)mPasses.size();
+        std::vector<std::vector<uint32_t>> successors(passCount);
+        for (uint32_t passIndex : mExecutionOrder)
+        {
+            for (uint32_t dependency : mPasses[passIndex].Dependencies) { successors[dependency].push_back(passIndex); }
+        }
+
+        // reachable[a][b]表示b直接或间接依赖a
+        std::vector<std::vector<bool>> reachable(passCount, std::vector<bool>(passCount, false));
+        for (auto it = mExecutionOrder.rbegin(); it != mExecutionOrder.rend(); ++it)
+        {
+            auto& reach = reachable[*it];
+            for (uint32_t successor : successors[*it])
+            {
+                reach[successor] = true;
+                for (uint32_t passIndex = 0; passIndex < passCount; passIndex++) { if (reachable[successor][passIndex]) { reach[passIndex] = true; } }
+            }
+        }
+
+        // 每帧只有一次计算队列提交：它等待所有上游图形Pass，下游图形Pass等待它
+        // 某个图形Pass既是异步Pass的上游又是下游时无法调度，后加入的候选Pass退回图形队列
+        std::vector<uint32_t> asyncPasses;
+        auto isSchedulable = [&]()
+        {
+            for (uint32_t graphics : mExecutionOrder)
+            {
+                if (mPasses[graphics].bAsyncCompute) { continue; }
+                bool upstream = std::any_of(asyncPasses.begin(), asyncPasses.end(), [&](uint32_t async) { return reachable[graphics][async]; });
+                bool downstream = std::any_of(asyncPasses.begin(), asyncPasses.end(), [&](uint32_t async) { return reachable[async][graphics]; });
+                if (upstream && downstream) { return false; }
+            }
+            return true;
+        };
+        for (uint32_t passIndex : mExecutionOrder)
+        {
+            auto& pass = mPasses[passIndex];
+            if (!(pass.Flags & PassFlags::ASYNC_COMPUTE) || !pass.Pipeline->GetOutputAttachments().empty()) { continue; }
+
+            pass.bAsyncCompute = true;
+            asyncPasses.push_back(passIndex);
+            if (!isSchedulable())
+            {
+                pass.bAsyncCompute = false;
+                asyncPasses.pop_back();
+            }
+        }
+        if (asyncPasses.empty()) { return; }
+
+        for (uint32_t passIndex : asyncPasses)
+        {
+            for (const auto& access : mPasses[passIndex].Accesses) { mResources[access.Resource].bAsyncAccess = true; }
+        }
+
+        // 上游图形Pass先执行；下游图形Pass以及与异步Pass访问相同资源的图形Pass等待计算完成；其余的与计算并行
+        std::vector<uint32_t> preAsync, overlap, postAsync;
+        std::vector<bool> waitsAsync(passCount, false);
+        for (uint32_t passIndex : mExecutionOrder)
+        {
+            const auto& pass = mPasses[passIndex];
+            if (pass.bAsyncCompute) { continue; }
+
+            bool upstream = std::any_of(asyncPasses.begin(), asyncPasses.end(), [&](uint32_t async) { return reachable[passIndex][async]; });
+            if (upstream)
+            {
+                preAsync.push_back(passIndex);
+                continue;
+            }
+
+            bool sharesResource = std::any_of(pass.Accesses.begin(), pass.Accesses.end(), [this](const ResourceAccess& access) { return mResources[access.Resource].bAsyncAccess; });
+            bool afterWaiting = std::any_of(pass.Dependencies.begin(), pass.Dependencies.end(), [&](uint32_t dependency) { return waitsAsync[dependency] || mPasses[dependency].bAsyncCompute; });
+            waitsAsync[passIndex] = sharesResource || afterWaiting;
+            (waitsAsync[passIndex] ? postAsync : overlap).push_back(passIndex);
+        }
+
+        mExecutionOrder = preAsync;
+        mExecutionOrder.insert(mExecutionOrder.end(), asyncPasses.begin(), asyncPasses.end());
+        mExecutionOrder.insert(mExecutionOrder.end(), overlap.begin(), overlap.end());
+        mExecutionOrder.insert(mExecutionOrder.end(), postAsync.begin(), postAsync.end());
+        mPreAsyncCount = (uint32_t)preAsync.size();
+        mAsyncCount = (uint32_t)asyncPasses.size();
+        mOverlapCount = (uint32_t)overlap.size();
+        mStats.AsyncComputePasses = mAsyncCount;
+    }
+
+    void RenderGraph::ComputeLifetimes()
+    {
+        for (auto& resource : mResources)
+        {
+            resource.FirstPass = InvalidIndex;
+            resource.LastPass = InvalidIndex;
+        }
+        for (uint32_t orderIndex = 0; orderIndex < (uint32_t)mExecutionOrder.size(); orderIndex++)
+        {
+            for (const auto& access : mPasses[mExecutionOrder[orderIndex]].Accesses)
+            {
+                auto& resource = mResources[access.Resource];
+                if (resource.FirstPass == InvalidIndex) { resource.FirstPass = orderIndex; }
+                resource.LastPass = orderIndex;
+            }
+        }
+    }
+
+    void RenderGraph::MergeSubpasses()
+    {
+        this->DestroyMergedRenderPasses();
+        for (auto& pass : mPasses)
+        {
+            pass.MergedGroup = InvalidIndex;
+            pass.Subpass = 0;
+        }
+        for (auto& resource : mResources) { resource.bMemoryless = false; }
+        if (!mbSubpassMerging) { return; }
+
+        // 异步计算前后的各段分别提交，合并的渲染通道不能跨越段的边界
+        uint32_t passCount = (uint32_t)mExecutionOrder.size();
+        std::vector<uint32_t> segmentEnds { passCount };
+        if (mAsyncCount != 0)
+        {
+            segmentEnds = { mPreAsyncCount, mPreAsyncCount + mAsyncCount, mPreAsyncCount + mAsyncCount + mOverlapCount, passCount };
+        }
+
+        uint32_t segmentBegin = 0;
+        for (uint32_t segmentEnd : segmentEnds)
+        {
+            uint32_t groupBegin = segmentBegin;
+            for (uint32_t orderIndex = segmentBegin + 1; orderIndex <= segmentEnd; orderIndex++)
+            {
+                if (orderIndex < segmentEnd && this->CanMergeSubpass(groupBegin, orderIndex)) { continue; }
+                if (orderIndex - groupBegin > 1) { this->AddMergedRenderPass(groupBegin, orderIndex); }
+                groupBegin = orderIndex;
+            }
+            segmentBegin = segmentEnd;
+        }
+    }
+
+    bool RenderGraph::GetAttachmentExtent(uint32_t resourceIndex, vk::Extent2D &extent) const
+    {
+        // 子通道的附件需要是单层单级的完整图像
+        const auto& resource = mResources[resourceIndex];
+        if (resource.bTransient)
+        {
+            const auto& declaration = resource.Declaration;
+            if (declaration.Options != ImageOptions::DEFAULT) { return false; }
+            extent = vk::Extent2D { declaration.Width != 0 ? declaration.Width : mRenderWidth, declaration.Height != 0 ? declaration.Height : mRenderHeight };
+            return true;
+        }
+
+        const auto* image = resource.Image;
+        if (image == nullptr || image->GetMipLevelCount() != 1 || image->GetLayerCount() != 1) { return false; }
+        extent = vk::Extent2D { image->GetWidth(), image->GetHeight() };
+        return true;
+    }
+
+    bool RenderGraph::IsMergeableGraphicsPass(const Pass &pass, vk::Extent2D &extent) const
+    {
+        // 计算Pass、异步计算Pass和自带vk::RenderPass的Pass不参与合并
+        // 动态渲染管线与子通道不兼容，没有解析函数重新创建管线的Pass也不参与合并
+        const auto& outputs = pass.Pipeline->GetOutputAttachments();
+        if (outputs.empty() || pass.bAsyncCompute || pass.RenderPass.RenderPassHandle || !pass.ResolvePipeline) { return false; }
+
+        bool extentSet = false;
+        for (const auto& attachment : outputs)
+        {
+            vk::Extent2D attachmentExtent {};
+            if (attachment.Layer != PipelineVK::OutputAttachment::ALL_LAYERS) { return false; }
+            if (!this->GetAttachmentExtent(mResourceLookup.at(attachment.Name), attachmentExtent)) { return false; }
+            if (extentSet && attachmentExtent != extent) { return false; }
+            extent = attachmentExtent;
+            extentSet = true;
+        }
+        return true;
+    }
+
+    bool RenderGraph::CanMergeSubpass(uint32_t groupBegin, uint32_t orderIndex) const
+    {
+        const auto& pass = mPasses[mExecutionOrder[orderIndex]];
+        vk::Extent2D groupExtent {};
+        vk::Extent2D passExtent {};
+        if (!this->IsMergeableGraphicsPass(mPasses[mExecutionOrder[groupBegin]], groupExtent)) { return false; }
+        if (!this->IsMergeableGraphicsPass(pass, passExtent) || passExtent != groupExtent) { return false; }
+
+        // 组内已经访问过的资源只能通过子通道依赖同步，渲染通道内不能录制其他屏障
+        uint32_t inputCount = 0;
+        for (const auto& access : pass.Accesses)
+        {
+            if (mResources[access.Resource].bAsyncAccess) { return false; }
+
+            bool accessedInGroup = false;
+            bool writtenAsAttachment = false;
+            bool onlyAttachments = true;
+            bool onlySameReads = true;
+            for (uint32_t groupOrder = groupBegin; groupOrder < orderIndex; groupOrder++)
+            {
+                for (const auto& previous : mPasses[mExecutionOrder[groupOrder]].Accesses)
+                {
+                    if (previous.Resource != access.Resource) { continue; }
+                    accessedInGroup = true;
+                    if (previous.bWrite && IsAttachmentUsage(previous.Usage)) { writtenAsAttachment = true; }
+                    if (!IsAttachmentUsage(previous.Usage)) { onlyAttachments = false; }
+                    if (previous.bWrite || previous.Usage != access.Usage) { onlySameReads = false; }
+                }
+            }
+
+            if (access.Usage == ImageUsage::INPUT_ATTACHMENT)
+            {
+                // 输入附件只能读取组内前面子通道的输出，同一子通道既读又写会形成反馈环
+                bool alsoOutput = std::any_of(pass.Accesses.begin(), pass.Accesses.end(), [&access](const ResourceAccess& other)
+                {
+                    return other.Resource == access.Resource && other.Usage != ImageUsage::INPUT_ATTACHMENT;
+                });
+                if (!writtenAsAttachment || alsoOutput) { return false; }
+                inputCount++;
+            }
+            else if (IsAttachmentUsage(access.Usage))
+            {
+                if (accessedInGroup && !onlyAttachments) { return false; }
+            }
+            else if (accessedInGroup && (access.bWrite || !onlySameReads)) { return false; }
+        }
+        return inputCount != 0;
+    }
+
+    void RenderGraph::AddMergedRenderPass(uint32_t groupBegin, uint32_t groupEnd)
+    {
+        uint32_t groupIndex = (uint32_t)mMergedPasses.size();
+        auto& group = mMergedPasses.emplace_back();
+        group.FirstOrder = groupBegin;
+        group.PassCount = groupEnd - groupBegin;
+
+        for (uint32_t orderIndex = groupBegin; orderIndex < groupEnd; orderIndex++)
+        {
+            auto& pass = mPasses[mExecutionOrder[orderIndex]];
+            pass.MergedGroup = groupIndex;
+            pass.Subpass = orderIndex - groupBegin;
+            for (const auto& access : pass.Accesses)
+            {
+                // 渲染通道内所有资源同时存活，生命周期扩展到整个组，组内不会出现别名屏障
+                auto& resource = mResources[access.Resource];
+                resource.FirstPass = std::min(resource.FirstPass, groupBegin);
+                resource.LastPass = std::max(resource.LastPass, groupEnd - 1);
+                if (IsAttachmentUsage(access.Usage)) { AddUnique(group.Attachments, access.Resource); }
+            }
+        }
+        mStats.MergedSubpasses += group.PassCount - 1;
+
+        constexpr ImageUsage::Value attachmentUsages = ImageUsage::COLOR_ATTACHMENT | ImageUsage::DEPTH_STENCIL_ATTACHMENT | ImageUsage::INPUT_ATTACHMENT;
+        for (uint32_t resourceIndex : group.Attachments)
+        {
+            auto& resource = mResources[resourceIndex];
+            bool insideGroup = resource.FirstPass == groupBegin && resource.LastPass == groupEnd - 1;
+            if (resource.bTransient && !resource.bIsOutput && insideGroup && (resource.UsageFlags & ~attachmentUsages) == 0)
+            {
+                resource.bMemoryless = true;
+                mStats.MemorylessImages++;
+            }
+        }
+    }
+
+    void RenderGraph::BuildMergedRenderPasses()
+    {
+        for (auto& group : mMergedPasses)
+        {
+            auto& first = mPasses[mExecutionOrder[group.FirstOrder]];
+            uint32_t attachmentCount = (uint32_t)group.Attachments.size();
+            auto findAttachment = [&group](uint32_t resourceIndex)
+            {
+                return (uint32_t)(std::find(group.Attachments.begin(), group.Attachments.end(), resourceIndex) - group.Attachments.begin());
+            };
+
+            // 附件在每个子通道的用途，InvalidIndex表示该子通道不使用
+            std::vector<std::vector<uint32_t>> usages(group.PassCount, std::vector<uint32_t>(attachmentCount, InvalidIndex));
+            for (uint32_t subpass = 0; subpass < group.PassCount; subpass++)
+            {
+                auto& pass = mPasses[mExecutionOrder[group.FirstOrder + subpass]];
+                if (subpass != 0)
+                {
+                    // 前面子通道已经使用的附件由子通道依赖和布局完成转换，其余资源的屏障提前到渲染通道开始之前
+                    for (const auto& barrier : pass.Barriers)
+                    {
+                        uint32_t attachment = findAttachment(barrier.Resource);
+                        bool usedBefore = attachment != attachmentCount && std::any_of(usages.begin(), usages.begin() + subpass, [attachment](const std::vector<uint32_t>& subpassUsages)
+                        {
+                            return subpassUsages[attachment] != InvalidIndex;
+                        });
+                        if (!usedBefore) { first.Barriers.push_back(barrier); }
+                    }
+                    pass.Barriers.clear();
+                }
+
+                for (const auto& access : pass.Accesses)
+                {
+                    if (IsAttachmentUsage(access.Usage)) { usages[subpass][findAttachment(access.Resource)] = access.Usage; }
+                }
+            }
+
+            std::vector<uint32_t> firstSubpasses(attachmentCount, InvalidIndex);
+            std::vector<uint32_t> lastSubpasses(attachmentCount, InvalidIndex);
+            for (uint32_t subpass = 0; subpass < group.PassCount; subpass++)
+            {
+                for (uint32_t attachment = 0; attachment < attachmentCount; attachment++)
+                {
+                    if (usages[subpass][attachment] == InvalidIndex) { continue; }
+                    if (firstSubpasses[attachment] == InvalidIndex) { firstSubpasses[attachment] = subpass; }
+                    lastSubpasses[attachment] = subpass;
+                }
+            }
+
+            // 附件在开始前已经由屏障转换到第一次使用的布局，结束时停留在最后一次使用的布局
+            MergedRenderPassLayout layout {};
+            auto& descriptions = layout.Attachments;
+            descriptions.resize(attachmentCount);
+            group.FinalUsages.clear();
+            uint32_t lastOrder = group.FirstOrder + group.PassCount - 1;
+            for (uint32_t attachment = 0; attachment < attachmentCount; attachment++)
+            {
+                const auto& resource = mResources[group.Attachments[attachment]];
+                auto firstUsage = (ImageUsage::Bits)usages[firstSubpasses[attachment]][attachment];
+                auto lastUsage = (ImageUsage::Bits)usages[lastSubpasses[attachment]][attachment];
+
+                // 输入附件只读取前面子通道的输出，第一次使用总是输出附件
+                const auto& firstPass = mPasses[mExecutionOrder[group.FirstOrder + firstSubpasses[attachment]]];
+                const auto& outputs = firstPass.Pipeline->GetOutputAttachments();
+                auto output = std::find_if(outputs.begin(), outputs.end(), [&resource](const PipelineVK::OutputAttachment& attachment) { return attachment.Name == resource.Name; });
+                assert(output != outputs.end());
+
+                // 之后不再读取的瞬态附件不需要写回内存
+                bool discard = resource.bTransient && !resource.bIsOutput && resource.LastPass == lastOrder;
+                auto loadOp = AttachmentStateToLoadOp(output->OnLoad);
+                auto storeOp = discard ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore;
+                bool hasStencil = (bool)(ImageFormatToImageAspect(resource.Image->GetFormat()) & vk::ImageAspectFlagBits::eStencil);
+
+                auto& description = descriptions[attachment];
+                description.setFormat(ToNative(resource.Image->GetFormat()));
+                description.setSamples(vk::SampleCountFlagBits::e1);
+                description.setLoadOp(loadOp);
+                description.setStoreOp(storeOp);
+                description.setStencilLoadOp(hasStencil ? loadOp : vk::AttachmentLoadOp::eDontCare);
+                description.setStencilStoreOp(hasStencil ? storeOp : vk::AttachmentStoreOp::eDontCare);
+                description.setInitialLayout(ImageUsageToImageLayout(firstUsage));
+                description.setFinalLayout(ImageUsageToImageLayout(lastUsage));
+                group.FinalUsages.push_back(lastUsage);
+            }
+
+            auto& colorReferences = layout.ColorReferences;
+            auto& inputReferences = layout.InputReferences;
+            auto& preserveReferences = layout.PreserveReferences;
+            auto& depthReferences = layout.DepthReferences;
+            auto& dependencies = layout.Dependencies;
+            colorReferences.resize(group.PassCount);
+            inputReferences.resize(group.PassCount);
+            preserveReferences.resize(group.PassCount);
+            depthReferences.resize(group.PassCount, vk::AttachmentReference { VK_ATTACHMENT_UNUSED, vk::ImageLayout::eUndefined });
+            for (uint32_t subpass = 0; subpass < group.PassCount; subpass++)
+            {
+                const auto& pass = mPasses[mExecutionOrder[group.FirstOrder + subpass]];
+                // 颜色附件的顺序与管线输出附件的顺序一致
+                for (const auto& output : pass.Pipeline->GetOutputAttachments())
+                {
+                    auto usage = AttachmentStateToImageUsage(output.OnLoad);
+                    vk::AttachmentReference reference { findAttachment(mResourceLookup.at(output.Name)), ImageUsageToImageLayout(usage) };
+                    if (usage == ImageUsage::DEPTH_STENCIL_ATTACHMENT) { depthReferences[subpass] = reference; }
+                    else { colorReferences[subpass].push_back(reference); }
+                }
+                for (const auto& dependency : pass.Pipeline->GetImageDependencies())
+                {
+                    if (dependency.Usage != ImageUsage::INPUT_ATTACHMENT) { continue; }
+                    inputReferences[subpass].push_back(vk::AttachmentReference { findAttachment(mResourceLookup.at(dependency.Name)), ImageUsageToImageLayout(ImageUsage::INPUT_ATTACHMENT) });
+                }
+                // 前后子通道都使用、本子通道不使用的附件需要保留内容
+                for (uint32_t attachment = 0; attachment < attachmentCount; attachment++)
+                {
+                    bool between = firstSubpasses[attachment] < subpass && subpass < lastSubpasses[attachment];
+                    if (between && usages[subpass][attachment] == InvalidIndex) { preserveReferences[subpass].push_back(attachment); }
+                }
+
+                // 共享附件的子通道之间都加入依赖，按像素区域同步即可
+                for (uint32_t previous = 0; previous < subpass; previous++)
+                {
+                    bool shared = false;
+                    for (uint32_t attachment = 0; attachment < attachmentCount; attachment++)
+                    {
+                        shared |= usages[previous][attachment] != InvalidIndex && usages[subpass][attachment] != InvalidIndex;
+                    }
+                    if (!shared) { continue; }
+
+                    constexpr vk::PipelineStageFlags attachmentStages = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                        vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eFragmentShader;
+                    vk::SubpassDependency dependency {};
+                    dependency.setSrcSubpass(previous);
+                    dependency.setDstSubpass(subpass);
+                    dependency.setSrcStageMask(attachmentStages);
+                    dependency.setDstStageMask(attachmentStages);
+                    dependency.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+                    dependency.setDstAccessMask(vk::AccessFlagBits::eInputAttachmentRead | vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite |
+                        vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+                    dependency.setDependencyFlags(vk::DependencyFlagBits::eByRegion);
+                    dependencies.push_back(dependency);
+                }
+            }
+
+            group.Handle = this->FindOrCreateRenderPass(layout);
+        }
+        this->ReleaseUnusedRenderPasses();
+    }
+
+    vk::RenderPass RenderGraph::FindOrCreateRenderPass(const MergedRenderPassLayout &layout)
+    {
+        auto cached = std::find_if(mRenderPassCache.begin(), mRenderPassCache.end(), [&layout](const auto& entry) { return entry.first == layout; });
+        if (cached != mRenderPassCache.end()) { return cached->second; }
+
+        uint32_t subpassCount = (uint32_t)layout.ColorReferences.size();
+        std::vector<vk::SubpassDescription> subpasses(subpassCount);
+        for (uint32_t subpass = 0; subpass < subpassCount; subpass++)
+        {
+            auto& description = subpasses[subpass];
+            description.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
+            description.setColorAttachments(layout.ColorReferences[subpass]);
+            description.setInputAttachments(layout.InputReferences[subpass]);
+            description.setPreserveAttachments(layout.PreserveReferences[subpass]);
+            if (layout.DepthReferences[subpass].attachment != VK_ATTACHMENT_UNUSED) { description.setPDepthStencilAttachment(&layout.DepthReferences[subpass]); }
+        }
+
+        vk::RenderPassCreateInfo renderPassCI {};
+        renderPassCI.setAttachments(layout.Attachments);
+        renderPassCI.setSubpasses(subpasses);
+        renderPassCI.setDependencies(layout.Dependencies);
+        auto& renderer = GetCurrentRenderer();
+        auto handle = renderer.IsNullBackend() ? CreateNullHandle<vk::RenderPass>() : renderer.GetDevice().createRenderPass(renderPassCI);
+        mRenderPassCache.emplace_back(layout, handle);
+        return handle;
+    }
+
+    void RenderGraph::ReleaseUnusedRenderPasses()
+    {
+        // 缓存中只有上一次编译的渲染通道，它们的帧缓冲已经在设备空闲后销毁
+        auto& renderer = GetCurrentRenderer();
+        auto unused = std::remove_if(mRenderPassCache.begin(), mRenderPassCache.end(), [this, &renderer](const auto& entry)
+        {
+            bool used = std::any_of(mMergedPasses.begin(), mMergedPasses.end(), [&entry](const MergedRenderPass& group) { return group.Handle == entry.second; });
+            if (used) { return false; }
+
+            // 句柄值可能被新的渲染通道复用，先淘汰为它创建的管线
+            renderer.GetPipelineCache().EvictRenderPass(entry.second);
+            if (!renderer.IsNullBackend()) { renderer.GetDevice().destroyRenderPass(entry.second); }
+            return true;
+        });
+        mRenderPassCache.erase(unused, mRenderPassCache.end());
+    }
+
+    void RenderGraph::SetupMergedRenderPasses()
+    {
+        auto& renderer = GetCurrentRenderer();
+        mFramebufferFrame++;
+        std::vector<vk::ImageView> views;
+        for (auto& group : mMergedPasses)
+        {
+            views.clear();
+            for (uint32_t resourceIndex : group.Attachments) { views.push_back(mResources[resourceIndex].Image->GetNativeView(ImageView::NATIVE)); }
+            const auto& image = *mResources[group.Attachments.front()].Image;
+            vk::Extent2D extent { image.GetWidth(), image.GetHeight() };
+
+            auto framebuffer = std::find_if(group.Framebuffers.begin(), group.Framebuffers.end(), [&views](const MergedFramebuffer& entry) { return entry.Views == views; });
+            if (framebuffer == group.Framebuffers.end())
+            {
+                vk::FramebufferCreateInfo framebufferCI {};
+                framebufferCI.setRenderPass(group.Handle);
+                framebufferCI.setAttachments(views);
+                framebufferCI.setWidth(extent.width);
+                framebufferCI.setHeight(extent.height);
+                framebufferCI.setLayers(1);
+                auto handle = renderer.IsNullBackend() ? CreateNullHandle<vk::Framebuffer>() : renderer.GetDevice().createFramebuffer(framebufferCI);
+                group.Framebuffers.push_back(MergedFramebuffer { views, handle });
+                framebuffer = group.Framebuffers.end() - 1;
+            }
+            framebuffer->LastUsedFrame = mFramebufferFrame;
+            vk::Framebuffer framebufferHandle = framebuffer->Handle;
+
+            // 每帧编译一次，超过虚拟帧数没有使用的帧缓冲不会再被执行中的命令引用，附件视图也可能已经随图像销毁
+            uint64_t frameCount = renderer.GetVirtualFrameCount();
+            auto stale = std::remove_if(group.Framebuffers.begin(), group.Framebuffers.end(), [this, &renderer, frameCount](const MergedFramebuffer& entry)
+            {
+                if (entry.LastUsedFrame + frameCount >= mFramebufferFrame) { return false; }
+                if (!renderer.IsNullBackend()) { renderer.GetDevice().destroyFramebuffer(entry.Handle); }
+                return true;
+            });
+            group.Framebuffers.erase(stale, group.Framebuffers.end());
+
+            // 清除值按附件顺序排列，取自第一个输出该附件的Pass
+            std::vector<vk::ClearValue> clearValues(group.Attachments.size());
+            std::vector<bool> assigned(group.Attachments.size(), false);
+            for (uint32_t subpass = 0; subpass < group.PassCount; subpass++)
+            {
+                const auto& pass = mPasses[mExecutionOrder[group.FirstOrder + subpass]];
+                for (const auto& output : pass.Pipeline->GetOutputAttachments())
+                {
+                    uint32_t attachment = (uint32_t)(std::find(group.Attachments.begin(), group.Attachments.end(), mResourceLookup.at(output.Name)) - group.Attachments.begin());
+                    if (assigned[attachment]) { continue; }
+                    assigned[attachment] = true;
+
+                    if (AttachmentStateToImageUsage(output.OnLoad) == ImageUsage::DEPTH_STENCIL_ATTACHMENT)
+                    {
+                        clearValues[attachment] = vk::ClearDepthStencilValue { output.DepthSpencilClear.Depth, output.DepthSpencilClear.Stencil };
+                    }
+                    else
+                    {
+                        const auto& clear = output.ColorClear;
+                        clearValues[attachment] = vk::ClearColorValue { std::array { clear.R, clear.G, clear.B, clear.A } };
+                    }
+                }
+            }
+
+            for (uint32_t subpass = 0; subpass < group.PassCount; subpass++)
+            {
+                auto& pass = mPasses[mExecutionOrder[group.FirstOrder + subpass]];
+                auto& renderPass = pass.RenderPass;
+                renderPass.RenderPassHandle = group.Handle;
+                renderPass.Framebuffer = framebufferHandle;
+                renderPass.RenderArea = vk::Rect2D { { 0, 0 }, extent };
+                renderPass.ClearValues = clearValues;
+                renderPass.Subpass = subpass;
+                // AddPass传入的管线为动态渲染创建，与子通道不兼容
+                renderPass.Pipeline = pass.ResolvePipeline(group.Handle, subpass);
+            }
+        }
+    }
+
+    void RenderGraph::DestroyMergedRenderPasses()
+    {
+        if (mMergedPasses.empty()) { return; }
+
+        // 与瞬态图像相同，只在图结构变化时重建，直接等待设备空闲
+        auto& renderer = GetCurrentRenderer();
+        if (!renderer.IsNullBackend())
+        {
+            auto& device = renderer.GetDevice();
+            device.waitIdle();
+            for (const auto& group : mMergedPasses)
+            {
+                for (const auto& framebuffer : group.Framebuffers) { device.destroyFramebuffer(framebuffer.Handle); }
+            }
+        }
+        // 渲染通道留在mRenderPassCache中，结构相同的下一次编译继续使用
+        mMergedPasses.clear();
+    }
+
+    vk::RenderPass RenderGraph::GetMergedRenderPass(uint32_t passIndex) const
+    {
+        uint32_t group = mPasses[passIndex].MergedGroup;
+        return group != InvalidIndex ? mMergedPasses[group].Handle : vk::RenderPass { };
+    }
+
+    void RenderGraph::CreateTransientImages()
+    {
+        bool lazyMemorySupported = IsLazilyAllocatedMemorySupported();
+        std::vector<TransientDesc> layout;
+        for (auto& resource : mResources)
+        {
+            resource.TransientSlot = InvalidIndex;
+            if (resource.bIsBuffer || resource.FirstPass == InvalidIndex) { continue; }
+            if (!resource.bTransient)
+            {
+                if (resource.Image == nullptr) { GDebugInfoCallback("RenderGraph", "image " + resource.Name + " is neither imported nor declared"); }
+                assert(resource.Image != nullptr);
+                continue;
+            }
+
+            const auto& declaration = resource.Declaration;
+            TransientDesc desc {};
+            desc.Name = resource.Name;
+            desc.ImageFormat = declaration.ImageFormat;
+            desc.Width = declaration.Width != 0 ? declaration.Width : mRenderWidth;
+            desc.Height = declaration.Height != 0 ? declaration.Height : mRenderHeight;
+            desc.Options = declaration.Options;
+            desc.UsageFlags = resource.UsageFlags;
+            desc.bLazy = resource.bMemoryless && lazyMemorySupported;
+            if (desc.bLazy) { desc.UsageFlags |= ImageUsage::TRANSIENT_ATTACHMENT; }
+            desc.FirstPass = resource.FirstPass;
+            // 图的输出在执行结束后仍会被读取，不能让后续资源复用它的内存
+            desc.LastPass = resource.bIsOutput ? (uint32_t)mExecutionOrder.size() : resource.LastPass;
+            // 异步计算与图形队列并行，执行顺序不能代表真实的生命周期
+            if (resource.bAsyncAccess)
+            {
+                desc.FirstPass = 0;
+                desc.LastPass = (uint32_t)mExecutionOrder.size();
+            }
+
+            resource.TransientSlot = (uint32_t)layout.size();
+            layout.push_back(std::move(desc));
+        }
+
+        // 布局不变时复用上一帧的图像和内存，避免每帧重新分配
+        if (layout != mTransientLayout) { this->BuildAliasingPlan(layout); }
+
+        for (auto& resource : mResources)
+        {
+            if (resource.TransientSlot != InvalidIndex) { resource.Image = &mTransientImages[resource.TransientSlot]; }
+        }
+        mStats.TransientImages = (uint32_t)layout.size();
+    }
+
+    void RenderGraph::BuildAliasingPlan(const std::vector<TransientDesc> &layout)
+    {
+        // 旧图像可能仍被在途的帧使用，布局只在分辨率或图结构变化时改变，直接等待设备空闲
+        auto& renderer = GetCurrentRenderer();
+        if (!mTransientImages.empty() && !renderer.IsNullBackend()) { renderer.GetDevice().waitIdle(); }
+        this->DestroyTransientImages();
+
+        mTransientLayout = layout;
+        mTransientImages.resize(layout.size());
+        mAliasingPlan.Placements.resize(layout.size());
+
+        std::vector<vk::MemoryRequirements> requirements(layout.size());
+        for (uint32_t slot = 0; slot < (uint32_t)layout.size(); slot++)
+        {
+            const auto& desc = layout[slot];
+            requirements[slot] = mTransientImages[slot].InitUnbound(desc.Width, desc.Height, desc.ImageFormat, desc.UsageFlags, desc.Options);
+
+            auto& placement = mAliasingPlan.Placements[slot];
+            placement.Resource = desc.Name;
+            placement.Size = requirements[slot].size;
+            placement.FirstPass = desc.FirstPass;
+            placement.LastPass = desc.LastPass;
+            mAliasingPlan.UnaliasedBytes += placement.Size;
+        }
+
+        struct Heap
+        {
+            uint32_t MemoryTypeBits = 0;
+            bool bLazy = false;
+            uint64_t Size = 0;
+            uint64_t Alignment = 1;
+            std::vector<uint32_t> Members;
+        };
+        std::vector<Heap> heaps;
+
+        // 大的资源先放置，每个资源首次适配到与其生命周期重叠的已放置资源之间的空隙
+        std::vector<uint32_t> order(layout.size());
+        for (uint32_t slot = 0; slot < (uint32_t)order.size(); slot++) { order[slot] = slot; }
+        std::stable_sort(order.begin(), order.end(), [&requirements](uint32_t a, uint32_t b) { return requirements[a].size > requirements[b].size; });
+
+        auto alignUp = [](uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; };
+        auto lifetimesOverlap = [](const AliasingPlan::Placement& a, const AliasingPlan::Placement& b)
+        {
+            return a.FirstPass <= b.LastPass && b.FirstPass <= a.LastPass;
+        };
+
+        std::vector<std::pair<uint64_t, uint64_t>> occupied;
+        for (uint32_t slot : order)
+        {
+            const auto& requirement = requirements[slot];
+            auto& placement = mAliasingPlan.Placements[slot];
+
+            bool isLazy = layout[slot].bLazy;
+            auto heap = std::find_if(heaps.begin(), heaps.end(), [&requirement, isLazy](const Heap& heap)
+            {
+                return (heap.MemoryTypeBits & requirement.memoryTypeBits) != 0 && heap.bLazy == isLazy;
+            });
+            if (heap == heaps.end())
+            {
+                heaps.push_back(Heap { requirement.memoryTypeBits, isLazy });
+                heap = heaps.end() - 1;
+            }
+
+            occupied.clear();
+            for (uint32_t member : heap->Members)
+            {
+                const auto& other = mAliasingPlan.Placements[member];
+                if (lifetimesOverlap(placement, other)) { occupied.emplace_back(other.Offset, other.Offset + other.Size); }
+            }
+            std::sort(occupied.begin(), occupied.end());
+
+            uint64_t offset = 0;
+            for (const auto& [begin, end] : occupied)
+            {
+                if (alignUp(offset, requirement.alignment) + requirement.size <= begin) { break; }
+                offset = std::max(offset, end);
+            }
+
+            placement.Heap = (uint32_t)(heap - heaps.begin());
+            placement.Offset = alignUp(offset, requirement.alignment);
+            heap->MemoryTypeBits &= requirement.memoryTypeBits;
+            heap->Size = std::max(heap->Size, placement.Offset + placement.Size);
+            heap->Alignment = std::max(heap->Alignment, (uint64_t)requirement.alignment);
+            heap->Members.push_back(slot);
+        }
+
+        for (const auto& heap : heaps)
+        {
+            for (uint32_t member : heap.Members)
+            {
+                auto& placement = mAliasingPlan.Placements[member];
+                for (uint32_t other : heap.Members)
+                {
+                    const auto& otherPlacement = mAliasingPlan.Placements[other];
+                    bool memoryOverlaps = placement.Offset < otherPlacement.Offset + otherPlacement.Size && otherPlacement.Offset < placement.Offset + placement.Size;
+                    if (other != member && memoryOverlaps) { placement.Aliases.push_back(other); }
+                }
+            }
+
+            vk::MemoryRequirements heapRequirements {};
+            heapRequirements.setSize(heap.Size);
+            heapRequirements.setAlignment(heap.Alignment);
+            heapRequirements.setMemoryTypeBits(heap.MemoryTypeBits);
+            mTransientHeaps.push_back(AllocateMemory(heapRequirements, heap.bLazy ? MemoryUsage::GPULazyAllocated : MemoryUsage::GPUOnly));
+            mAliasingPlan.HeapSizes.push_back(heap.Size);
+            mAliasingPlan.AliasedBytes += heap.Size;
+        }
+
+        for (uint32_t slot = 0; slot < (uint32_t)layout.size(); slot++)
+        {
+            const auto& placement = mAliasingPlan.Placements[slot];
+            mTransientImages[slot].BindMemory(mTransientHeaps[placement.Heap], placement.Offset);
+        }
+
+        GDebugInfoCallback("RenderGraph", std::to_string(layout.size()) + " transient images use " + std::to_string(mAliasingPlan.AliasedBytes >> 20) +
+            " MB in " + std::to_string(heaps.size()) + " heaps, " + std::to_string(mAliasingPlan.UnaliasedBytes >> 20) + " MB without aliasing");
+    }
+
+    void RenderGraph::DestroyTransientImages()
+    {
+        // 先销毁图像，再释放它们共享的内存
+        mTransientImages.clear();
+        for (auto heap : mTransientHeaps) { DeallocateMemory(heap); }
+        mTransientHeaps.clear();
+        mTransientLayout.clear();
+        mAliasingPlan = AliasingPlan {};
+    }
+
+    void RenderGraph::ComputeBarriers()
+    {
+        // 资源在图开始时的用途未知，第一次访问总是交给命令缓冲的状态跟踪决定是否需要屏障
+        std::vector<uint32_t> lastUsages(mResources.size(), InvalidIndex);
+        // 图执行前后所有资源都属于图形队列族
+        std::vector<bool> onAsyncCompute(mResources.size(), false);
+        mGraphicsReleases.clear();
+        mComputeReleases.clear();
+        mFinalAcquires.clear();
+
+        for (uint32_t passIndex : mExecutionOrder)
+        {
+            auto& pass = mPasses[passIndex];
+            pass.Barriers.clear();
+            pass.Acquires.clear();
+            for (const auto& access : pass.Accesses)
+            {
+                // 相同用途的连续读取不需要屏障，写入后无论用途是否变化都需要
+                auto& lastUsage = lastUsages[access.Resource];
+
+                // 跨队列使用时由所有权转移完成布局转换，release在源队列上一段命令的末尾录制
+                if (onAsyncCompute[access.Resource] != pass.bAsyncCompute)
+                {
+                    OwnershipTransfer transfer { access.Resource, access.Usage };
+                    (pass.bAsyncCompute ? mGraphicsReleases : mComputeReleases).push_back(transfer);
+                    pass.Acquires.push_back(transfer);
+                    onAsyncCompute[access.Resource] = pass.bAsyncCompute;
+                    lastUsage = access.Usage;
+                    mStats.OwnershipTransfers++;
+                    continue;
+                }
+                if (lastUsage == access.Usage && !access.bWrite) { continue; }
+
+                bool duplicated = std::any_of(pass.Barriers.begin(), pass.Barriers.end(), [&access](const ResourceAccess& barrier)
+                {
+                    return barrier.Resource == access.Resource && barrier.Usage == access.Usage;
+                });
+                if (duplicated) { continue; }
+
+                // 共享内存的瞬态图像在本帧的首次访问改为别名屏障
+                const auto& resource = mResources[access.Resource];
+                auto& barrier = pass.Barriers.emplace_back(access);
+                if (lastUsage == InvalidIndex && resource.TransientSlot != InvalidIndex && !mAliasingPlan.Placements[resource.TransientSlot].Aliases.empty())
+                {
+                    barrier.bAliasing = true;
+                }
+                lastUsage = access.Usage;
+            }
+        }
+
+        mFinalTransitions.clear();
+        for (uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mResources.size(); resourceIndex++)
+        {
+            const auto& resource = mResources[resourceIndex];
+            if (onAsyncCompute[resourceIndex])
+            {
+                OwnershipTransfer transfer { resourceIndex, resource.FinalUsage != 0 ? resource.FinalUsage : lastUsages[resourceIndex] };
+                mComputeReleases.push_back(transfer);
+                mFinalAcquires.push_back(transfer);
+                mStats.OwnershipTransfers++;
+            }
+            if (resource.FinalUsage == 0 || (resource.Image == nullptr && resource.Buffer == nullptr)) { continue; }
+            mFinalTransitions.emplace_back(resourceIndex, resource.FinalUsage);
+        }
+    }
+
+    void RenderGraph::CountBarriers()
+    {
+        // 子通道合并会移动或去掉部分屏障，统计最终由RecordPassBarriers录制的屏障
+        for (uint32_t passIndex : mExecutionOrder)
+        {
+            for (const auto& barrier : mPasses[passIndex].Barriers)
+            {
+                if (barrier.bAliasing) { mStats.AliasingBarriers++; }
+                if (mResources[barrier.Resource].bIsBuffer) { mStats.BufferBarriers++; }
+                else { mStats.ImageBarriers++; }
+            }
+        }
+    }
+
+    void RenderGraph::Execute(CommandBufferVK &commands)
+    {
+        if (!mbCompiled) { this->Compile(); }
+        if (mbGpuTimings) { this->StartGpuTimings(commands); }
+
+        uint32_t passCount = (uint32_t)mExecutionOrder.size();
+        if (mAsyncCount == 0)
+        {
+            this->RecordPasses(commands, 0, passCount);
+        }
+        else
+        {
+            // 中途提交会替换当前帧的主命令缓冲，commands必须是当前帧的命令缓冲
+            auto& renderer = GetCurrentRenderer();
+            assert(&commands == &renderer.GetCurrentCommandBuffer());
+            uint32_t asyncBegin = mPreAsyncCount;
+            uint32_t overlapBegin = asyncBegin + mAsyncCount;
+            uint32_t postBegin = overlapBegin + mOverlapCount;
+
+            this->RecordPasses(commands, 0, asyncBegin);
+            for (const auto& transfer : mGraphicsReleases) { this->RecordOwnershipTransfer(commands, transfer, true, true); }
+            uint64_t graphicsReady = renderer.SubmitCurrentCommands();
+
+            auto computeCommands = renderer.AcquireAsyncComputeCommands();
+            computeCommands.Begin();
+            this->RecordPasses(computeCommands, asyncBegin, overlapBegin);
+            for (const auto& transfer : mComputeReleases) { this->RecordOwnershipTransfer(computeCommands, transfer, true, false); }
+            computeCommands.End();
+            uint64_t computeDone = renderer.SubmitAsyncCompute(computeCommands, graphicsReady);
+
+            // 并行的图形Pass单独提交，只有之后的提交等待异步计算完成
+            this->RecordPasses(commands, overlapBegin, postBegin);
+            if (mOverlapCount != 0) { renderer.SubmitCurrentCommands(); }
+            renderer.WaitAsyncCompute(computeDone);
+
+            this->RecordPasses(commands, postBegin, passCount);
+            for (const auto& transfer : mFinalAcquires) { this->RecordOwnershipTransfer(commands, transfer, false, false); }
+        }
+
+        for (const auto& [resourceIndex, usage] : mFinalTransitions)
+        {
+            const auto& resource = mResources[resourceIndex];
+            if (resource.bIsBuffer) { commands.TransitionBuffer(*resource.Buffer, (BufferUsage::Bits)usage); }
+            else { commands.TransitionImage(*resource.Image, (ImageUsage::Bits)usage); }
+        }
+
+        if (!mDumpPath.empty()) { this->WriteDump(); }
+    }
+
+    void RenderGraph::RecordPasses(CommandBufferVK &commands, uint32_t begin, uint32_t end)
+    {
+        // 录制线程的命令池属于图形队列族，异步计算的命令缓冲只能在当前线程录制
+        auto& recorder = GetCurrentRenderer().GetParallelRecorder();
+        bool isAsyncRange = begin < end && mPasses[mExecutionOrder[begin]].bAsyncCompute;
+        if (mbParallelRecording && !isAsyncRange && end - begin > 1 && recorder.GetThreadCount() > 1)
+        {
+            this->RecordPassesParallel(commands, begin, end);
+            return;
+        }
+
+        for (uint32_t orderIndex = begin; orderIndex < end; orderIndex++)
+        {
+            auto& pass = mPasses[mExecutionOrder[orderIndex]];
+            if (mbGpuTimings) { this->BeginPassTiming(commands, pass); }
+            this->RecordPassBarriers(commands, pass);
+
+            RenderPassState state { *this, commands, pass.RenderPass };
+            bool isGraphics = !pass.Pipeline->GetOutputAttachments().empty();
+            if (isGraphics) { this->BeginGraphicsPass(commands, pass, vk::SubpassContents::eInline); }
+            else { commands.BindPassState(pass.RenderPass); }
+
+            if (pass.Record) { pass.Record(state); }
+
+            if (isGraphics) { this->EndGraphicsPass(commands, pass); }
+            if (mbGpuTimings) { this->EndPassTiming(commands, pass); }
+        }
+    }
+
+    void RenderGraph::RecordPassesParallel(CommandBufferVK &commands, uint32_t begin, uint32_t end)
+    {
+        // 图形Pass的secondary继承主命令缓冲上开始的渲染通道，计算Pass的secondary独立录制
+        mParallelInheritance.clear();
+        for (uint32_t orderIndex = begin; orderIndex < end; orderIndex++)
+        {
+            const auto& pass = mPasses[mExecutionOrder[orderIndex]];
+            bool isGraphics = !pass.Pipeline->GetOutputAttachments().empty();
+            mParallelInheritance.push_back(isGraphics ? &pass.RenderPass : nullptr);
+        }
+
+        // 录制线程只读取编译结果，所有跟踪状态的屏障都在下面按执行顺序录制到主命令缓冲
+        auto& recorder = GetCurrentRenderer().GetParallelRecorder();
+        recorder.RecordSecondaries(mParallelInheritance, [this, begin](CommandBufferVK& secondary, uint32_t jobIndex)
+        {
+            auto& pass = mPasses[mExecutionOrder[begin + jobIndex]];
+            RenderPassState state { *this, secondary, pass.RenderPass };
+            secondary.BindPassState(pass.RenderPass);
+            if (pass.Record) { pass.Record(state); }
+        });
+
+        const auto& secondaries = recorder.GetRecordedBuffers();
+        const auto& secondaryStats = recorder.GetRecordedStats();
+        for (uint32_t orderIndex = begin; orderIndex < end; orderIndex++)
+        {
+            auto& pass = mPasses[mExecutionOrder[orderIndex]];
+            // 内容来自secondary命令缓冲的渲染通道内不能写入时间戳，合并的子通道整体记在第一个子通道上
+            bool endsRenderPass = pass.MergedGroup == InvalidIndex || pass.Subpass + 1 == mMergedPasses[pass.MergedGroup].PassCount;
+            if (mbGpuTimings && pass.Subpass == 0) { this->BeginPassTiming(commands, pass); }
+            this->RecordPassBarriers(commands, pass);
+
+            ArrayView<const vk::CommandBuffer> secondary { &secondaries[orderIndex - begin], 1 };
+            ArrayView<const CommandBufferStats> stats { &secondaryStats[orderIndex - begin], 1 };
+            if (mParallelInheritance[orderIndex - begin] != nullptr)
+            {
+                this->BeginGraphicsPass(commands, pass, vk::SubpassContents::eSecondaryCommandBuffers);
+                commands.ExecuteCommands(secondary, stats);
+                this->EndGraphicsPass(commands, pass);
+            }
+            else { commands.ExecuteCommands(secondary, stats); }
+            if (mbGpuTimings && endsRenderPass) { this->EndPassTiming(commands, pass); }
+        }
+    }
+
+    void RenderGraph::BeginGraphicsPass(CommandBufferVK &commands, const Pass &pass, vk::SubpassContents contents)
+    {
+        if (pass.Subpass == 0) { commands.BeginPass(pass.RenderPass, contents); }
+        else { commands.NextSubpass(pass.RenderPass, contents); }
+    }
+
+    void RenderGraph::EndGraphicsPass(CommandBufferVK &commands, const Pass &pass)
+    {
+        if (pass.MergedGroup == InvalidIndex)
+        {
+            commands.EndPass(pass.RenderPass);
+            return;
+        }
+
+        const auto& group = mMergedPasses[pass.MergedGroup];
+        if (pass.Subpass + 1 != group.PassCount) { return; }
+        commands.EndPass(pass.RenderPass);
+
+        // 子通道之间的布局转换由渲染通道完成，结束时附件处于最后一个子通道的布局
+        for (uint32_t attachment = 0; attachment < (uint32_t)group.Attachments.size(); attachment++)
+        {
+            mResources[group.Attachments[attachment]].Image->ResetSubresourceUsage(group.FinalUsages[attachment]);
+        }
+    }
+
+    void RenderGraph::RecordPassBarriers(CommandBufferVK &commands, const Pass &pass)
+    {
+        for (const auto& transfer : pass.Acquires) { this->RecordOwnershipTransfer(commands, transfer, false, pass.bAsyncCompute); }
+        for (const auto& barrier : pass.Barriers)
+        {
+            const auto& resource = mResources[barrier.Resource];
+            if (resource.bIsBuffer) { commands.TransitionBuffer(*resource.Buffer, (BufferUsage::Bits)barrier.Usage); }
+            else if (barrier.bAliasing)
+            {
+                mAliasedImages.clear();
+                for (uint32_t alias : mAliasingPlan.Placements[resource.TransientSlot].Aliases) { mAliasedImages.push_back(std::cref(mTransientImages[alias])); }
+                commands.AliasImage(mAliasedImages, *resource.Image, (ImageUsage::Bits)barrier.Usage);
+            }
+            else { commands.TransitionImage(*resource.Image, (ImageUsage::Bits)barrier.Usage); }
+        }
+    }
+
+    void RenderGraph::RecordOwnershipTransfer(CommandBufferVK &commands, const OwnershipTransfer &transfer, bool release, bool toAsyncCompute)
+    {
+        auto& renderer = GetCurrentRenderer();
+        uint32_t graphicsFamily = renderer.GetQueueFamilyIndex();
+        uint32_t computeFamily = renderer.GetComputeQueueFamilyIndex();
+        uint32_t srcFamily = toAsyncCompute ? graphicsFamily : computeFamily;
+        uint32_t dstFamily = toAsyncCompute ? computeFamily : graphicsFamily;
+
+        const auto& resource = mResources[transfer.Resource];
+        if (resource.bIsBuffer)
+        {
+            if (release) { commands.ReleaseBuffer(*resource.Buffer, (BufferUsage::Bits)transfer.Usage, srcFamily, dstFamily); }
+            else { commands.AcquireBuffer(*resource.Buffer, (BufferUsage::Bits)transfer.Usage, srcFamily, dstFamily); }
+        }
+        else
+        {
+            if (release) { commands.ReleaseImage(*resource.Image, (ImageUsage::Bits)transfer.Usage, srcFamily, dstFamily); }
+            else { commands.AcquireImage(*resource.Image, (ImageUsage::Bits)transfer.Usage, srcFamily, dstFamily); }
+        }
+    }
+
+    const ImageVK &RenderGraph::GetImage(const std::string &name) const
+    {
+        auto it = mResourceLookup.find(name);
+        assert(it != mResourceLookup.end() && mResources[it->second].Image != nullptr);
+        return *mResources[it->second].Image;
+    }
+
+    const BufferVK &RenderGraph::GetBuffer(const std::string &name) const
+    {
+        auto it = mResourceLookup.find(name);
+        assert(it != mResourceLookup.end() && mResources[it->second].Buffer != nullptr);
+        return *mResources[it->second].Buffer;
+    }
+
+    void RenderGraph::StartGpuTimings(CommandBufferVK &commands)
+    {
+        auto& renderer = GetCurrentRenderer();
+        uint32_t queryCount = (uint32_t)mPasses.size() * 2;
+        if (mTimestamps.GetQueryCount() < queryCount)
+        {
+            // 查询池可能仍被在途的帧使用，只在Pass数量超出容量时等待设备空闲后重建
+            if (mTimestamps.GetQueryCount() != 0 && !renderer.IsNullBackend()) { renderer.GetDevice().waitIdle(); }
+            mTimestamps.Init(std::max(queryCount * 2, 64u), (uint32_t)renderer.GetVirtualFrameCount());
+            mTimedPasses.assign(renderer.GetVirtualFrameCount(), { });
+        }
+
+        mTimestampFrame = renderer.GetCurrentFrameIndex();
+        mTimestamps.StartFrame(commands, mTimestampFrame);
+
+        // 结果按名称保存，图结构变化后Pass的下标不再对应
+        auto& timedPasses = mTimedPasses[mTimestampFrame];
+        mPassGpuTimes.clear();
+        for (uint32_t span = 0; span < (uint32_t)timedPasses.size(); span++)
+        {
+            double milliseconds = mTimestamps.GetElapsedMilliseconds(span * 2, span * 2 + 1);
+            if (milliseconds >= 0.0) { mPassGpuTimes[timedPasses[span]] = milliseconds; }
+        }
+        timedPasses.clear();
+    }
+
+    void RenderGraph::BeginPassTiming(CommandBufferVK &commands, const Pass &pass)
+    {
+        // 查询池和时间戳的有效位数都来自图形队列族，异步计算队列上的Pass不计时
+        if (pass.bAsyncCompute) { return; }
+        // 每个Pass最多计时一次，查询数量在StartGpuTimings中按Pass数量保证
+        auto& timedPasses = mTimedPasses[mTimestampFrame];
+        mTimestamps.WriteTimestamp(commands, (uint32_t)timedPasses.size() * 2);
+        timedPasses.push_back(pass.Name);
+    }
+
+    void RenderGraph::EndPassTiming(CommandBufferVK &commands, const Pass &pass)
+    {
+        if (pass.bAsyncCompute) { return; }
+        const auto& timedPasses = mTimedPasses[mTimestampFrame];
+        mTimestamps.WriteTimestamp(commands, (uint32_t)timedPasses.size() * 2 - 1);
+    }
+
+    double RenderGraph::GetPassGpuTime(const std::string &name) const
+    {
+        auto time = mPassGpuTimes.find(name);
+        return time != mPassGpuTimes.end() ? time->second : -1.0;
+    }
+
+    static std::string Escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\') { escaped += '\\'; }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    static std::string Quote(const std::string& text)
+    {
+        return "\"" + Escape(text) + "\"";
+    }
+
+    static std::string UsageToString(bool isBuffer, uint32_t usage)
+    {
+        return isBuffer ? vk::to_string((vk::BufferUsageFlags)usage) : vk::to_string((vk::ImageUsageFlags)usage);
+    }
+
+    std::string RenderGraph::ExportGraphviz() const
+    {
+        std::string dot = "digraph RenderGraph\n{\n    rankdir=LR;\n    node [fontname=\"monospace\"];\n";
+
+        // Pass为方框，剔除的Pass为灰色，异步计算的Pass为蓝色，合并的子通道放在同一个簇中
+        auto passNode = [this](uint32_t passIndex)
+        {
+            const auto& pass = mPasses[passIndex];
+            std::string label = Escape(pass.Name) + "\\n" + std::to_string(pass.Barriers.size()) + " barriers";
+            double gpuTime = this->GetPassGpuTime(pass.Name);
+            if (gpuTime >= 0.0) { label += "\\n" + std::to_string(gpuTime) + " ms"; }
+            const char* color = pass.bCulled ? "gray80" : (pass.bAsyncCompute ? "lightblue" : "white");
+            return "        p" + std::to_string(passIndex) + " [shape=box, style=filled, fillcolor=" + color + ", label=\"" + label + "\"];\n";
+        };
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            if (mPasses[passIndex].MergedGroup == InvalidIndex) { dot += passNode(passIndex).substr(4); }
+        }
+        for (uint32_t group = 0; group < (uint32_t)mMergedPasses.size(); group++)
+        {
+            const auto& merged = mMergedPasses[group];
+            dot += "    subgraph cluster_renderpass" + std::to_string(group) + "\n    {\n        label=\"render pass " + std::to_string(group) + "\";\n        style=dashed;\n";
+            for (uint32_t subpass = 0; subpass < merged.PassCount; subpass++) { dot += passNode(mExecutionOrder[merged.FirstOrder + subpass]); }
+            dot += "    }\n";
+        }
+
+        // 资源为椭圆，共享同一块内存的瞬态图像放在同一个簇中
+        auto resourceNode = [this](uint32_t resourceIndex)
+        {
+            const auto& resource = mResources[resourceIndex];
+            std::string label = Escape(resource.Name);
+            if (resource.TransientSlot != InvalidIndex)
+            {
+                const auto& placement = mAliasingPlan.Placements[resource.TransientSlot];
+                label += "\\n" + std::to_string(placement.Size >> 10) + " KB @ " + std::to_string(placement.Offset);
+            }
+            if (resource.bMemoryless) { label += "\\nmemoryless"; }
+            const char* shape = resource.bIsBuffer ? "cylinder" : "ellipse";
+            const char* color = resource.bIsOutput ? "gold" : (resource.bTransient ? "palegreen" : "white");
+            return "        r" + std::to_string(resourceIndex) + " [shape=" + shape + ", style=filled, fillcolor=" + color + ", label=\"" + label + "\"];\n";
+        };
+        std::vector<std::vector<uint32_t>> heapMembers(mAliasingPlan.HeapSizes.size());
+        for (uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mResources.size(); resourceIndex++)
+        {
+            const auto& resource = mResources[resourceIndex];
+            if (resource.TransientSlot != InvalidIndex) { heapMembers[mAliasingPlan.Placements[resource.TransientSlot].Heap].push_back(resourceIndex); }
+            else { dot += resourceNode(resourceIndex).substr(4); }
+        }
+        for (uint32_t heap = 0; heap < (uint32_t)heapMembers.size(); heap++)
+        {
+            dot += "    subgraph cluster_heap" + std::to_string(heap) + "\n    {\n        label=\"heap " + std::to_string(heap) + " (" +
+                std::to_string(mAliasingPlan.HeapSizes[heap] >> 10) + " KB)\";\n        style=filled;\n        fillcolor=honeydew;\n";
+            for (uint32_t resourceIndex : heapMembers[heap]) { dot += resourceNode(resourceIndex); }
+            dot += "    }\n";
+        }
+
+        // 读写通过资源节点表示，只有先后约束(WAR/WAW)的依赖画成Pass之间的虚线
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            const auto& pass = mPasses[passIndex];
+            std::string passName = "p" + std::to_string(passIndex);
+            for (const auto& access : pass.Accesses)
+            {
+                std::string resourceName = "r" + std::to_string(access.Resource);
+                std::string label = Quote(UsageToString(mResources[access.Resource].bIsBuffer, access.Usage));
+                if (access.bRead) { dot += "    " + resourceName + " -> " + passName + " [label=" + label + "];\n"; }
+                if (access.bWrite) { dot += "    " + passName + " -> " + resourceName + " [label=" + label + "];\n"; }
+            }
+            for (uint32_t dependency : pass.Dependencies)
+            {
+                if (std::find(pass.Producers.begin(), pass.Producers.end(), dependency) != pass.Producers.end()) { continue; }
+                dot += "    p" + std::to_string(dependency) + " -> " + passName + " [style=dashed];\n";
+            }
+        }
+        dot += "}\n";
+        return dot;
+    }
+
+    std::string RenderGraph::ExportJson() const
+    {
+        auto boolean = [](bool value) { return std::string(value ? "true" : "false"); };
+        std::vector<int64_t> orderPositions(mPasses.size(), -1);
+        for (uint32_t orderIndex = 0; orderIndex < (uint32_t)mExecutionOrder.size(); orderIndex++) { orderPositions[mExecutionOrder[orderIndex]] = orderIndex; }
+
+        std::string json = "{\n";
+        json += "  \"renderExtent\": [" + std::to_string(mRenderWidth) + ", " + std::to_string(mRenderHeight) + "],\n";
+        json += "  \"stats\": { \"declaredPasses\": " + std::to_string(mStats.DeclaredPasses) + ", \"culledPasses\": " + std::to_string(mStats.CulledPasses) +
+            ", \"imageBarriers\": " + std::to_string(mStats.ImageBarriers) + ", \"bufferBarriers\": " + std::to_string(mStats.BufferBarriers) +
+            ", \"aliasingBarriers\": " + std::to_string(mStats.AliasingBarriers) + ", \"asyncComputePasses\": " + std::to_string(mStats.AsyncComputePasses) +
+            ", \"ownershipTransfers\": " + std::to_string(mStats.OwnershipTransfers) + ", \"mergedSubpasses\": " + std::to_string(mStats.MergedSubpasses) +
+            ", \"fromCache\": " + boolean(mStats.bFromCache) + " },\n";
+
+        // 瞬态内存：实际分配的堆大小与不做别名时的总和
+        json += "  \"memory\": { \"transientImages\": " + std::to_string(mStats.TransientImages) + ", \"memorylessImages\": " + std::to_string(mStats.MemorylessImages) +
+            ", \"aliasedBytes\": " + std::to_string(mAliasingPlan.AliasedBytes) + ", \"unaliasedBytes\": " + std::to_string(mAliasingPlan.UnaliasedBytes) + ", \"heaps\": [";
+        for (uint32_t heap = 0; heap < (uint32_t)mAliasingPlan.HeapSizes.size(); heap++)
+        {
+            json += std::string(heap == 0 ? "" : ", ") + "{ \"size\": " + std::to_string(mAliasingPlan.HeapSizes[heap]) + ", \"resources\": [";
+            bool first = true;
+            for (const auto& placement : mAliasingPlan.Placements)
+            {
+                if (placement.Heap != heap) { continue; }
+                json += std::string(first ? "" : ", ") + Quote(placement.Resource);
+                first = false;
+            }
+            json += "] }";
+        }
+        json += "] },\n";
+
+        json += "  \"passes\": [\n";
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            const auto& pass = mPasses[passIndex];
+            json += "    { \"index\": " + std::to_string(passIndex) + ", \"name\": " + Quote(pass.Name) + ", \"order\": " + std::to_string(orderPositions[passIndex]) +
+                ", \"culled\": " + boolean(pass.bCulled) + ", \"asyncCompute\": " + boolean(pass.bAsyncCompute) +
+                ", \"renderPass\": " + (pass.MergedGroup == InvalidIndex ? std::string("-1") : std::to_string(pass.MergedGroup)) + ", \"subpass\": " + std::to_string(pass.Subpass) +
+                ", \"gpuMilliseconds\": " + std::to_string(this->GetPassGpuTime(pass.Name)) + ",\n      \"barriers\": [";
+            for (uint32_t barrierIndex = 0; barrierIndex < (uint32_t)pass.Barriers.size(); barrierIndex++)
+            {
+                const auto& barrier = pass.Barriers[barrierIndex];
+                const auto& resource = mResources[barrier.Resource];
+                json += std::string(barrierIndex == 0 ? "" : ", ") + "{ \"resource\": " + Quote(resource.Name) + ", \"usage\": " + Quote(UsageToString(resource.bIsBuffer, barrier.Usage)) +
+                    ", \"aliasing\": " + boolean(barrier.bAliasing) + " }";
+            }
+            json += "],\n      \"acquires\": [";
+            for (uint32_t acquireIndex = 0; acquireIndex < (uint32_t)pass.Acquires.size(); acquireIndex++)
+            {
+                const auto& acquire = pass.Acquires[acquireIndex];
+                const auto& resource = mResources[acquire.Resource];
+                json += std::string(acquireIndex == 0 ? "" : ", ") + "{ \"resource\": " + Quote(resource.Name) + ", \"usage\": " + Quote(UsageToString(resource.bIsBuffer, acquire.Usage)) + " }";
+            }
+            json += "] }" + std::string(passIndex + 1 == mPasses.size() ? "\n" : ",\n");
+        }
+        json += "  ],\n";
+
+        json += "  \"resources\": [\n";
+        for (uint32_t resourceIndex = 0; resourceIndex < (uint32_t)mResources.size(); resourceIndex++)
+        {
+            const auto& resource = mResources[resourceIndex];
+            json += "    { \"index\": " + std::to_string(resourceIndex) + ", \"name\": " + Quote(resource.Name) + ", \"type\": " + (resource.bIsBuffer ? "\"buffer\"" : "\"image\"") +
+                ", \"transient\": " + boolean(resource.bTransient) + ", \"output\": " + boolean(resource.bIsOutput) + ", \"memoryless\": " + boolean(resource.bMemoryless) +
+                ", \"firstPass\": " + (resource.FirstPass == InvalidIndex ? std::string("-1") : std::to_string(resource.FirstPass)) +
+                ", \"lastPass\": " + (resource.LastPass == InvalidIndex ? std::string("-1") : std::to_string(resource.LastPass));
+            if (!resource.bIsBuffer && resource.Image != nullptr)
+            {
+                json += ", \"format\": " + Quote(vk::to_string(ToNative(resource.Image->GetFormat()))) + ", \"width\": " + std::to_string(resource.Image->GetWidth()) +
+                    ", \"height\": " + std::to_string(resource.Image->GetHeight()) + ", \"usage\": " + Quote(UsageToString(false, resource.UsageFlags));
+            }
+            if (resource.TransientSlot != InvalidIndex)
+            {
+                const auto& placement = mAliasingPlan.Placements[resource.TransientSlot];
+                json += ", \"heap\": " + std::to_string(placement.Heap) + ", \"offset\": " + std::to_string(placement.Offset) + ", \"size\": " + std::to_string(placement.Size) + ", \"aliases\": [";
+                for (uint32_t aliasIndex = 0; aliasIndex < (uint32_t)placement.Aliases.size(); aliasIndex++)
+                {
+                    json += std::string(aliasIndex == 0 ? "" : ", ") + Quote(mAliasingPlan.Placements[placement.Aliases[aliasIndex]].Resource);
+                }
+                json += "]";
+            }
+            json += " }" + std::string(resourceIndex + 1 == mResources.size() ? "\n" : ",\n");
+        }
+        json += "  ],\n";
+
+        // RAW依赖来自资源的生产者，其余是WAR/WAW的先后约束
+        json += "  \"edges\": [\n";
+        bool firstEdge = true;
+        for (uint32_t passIndex = 0; passIndex < (uint32_t)mPasses.size(); passIndex++)
+        {
+            const auto& pass = mPasses[passIndex];
+            for (uint32_t dependency : pass.Dependencies)
+            {
+                bool isProducer = std::find(pass.Producers.begin(), pass.Producers.end(), dependency) != pass.Producers.end();
+                json += std::string(firstEdge ? "" : ",\n") + "    { \"from\": " + std::to_string(dependency) + ", \"to\": " + std::to_string(passIndex) +
+                    ", \"type\": " + (isProducer ? "\"raw\"" : "\"order\"") + " }";
+                firstEdge = false;
+            }
+        }
+        json += "\n  ]\n}\n";
+        return json;
+    }
+
+    void RenderGraph::WriteDump()
+    {
+        // 无论是否成功都只尝试一次，避免路径无效时每帧重复写入
+        auto writeFile = [](const std::string& path, const std::string& content)
+        {
+            std::ofstream file(path, std::ios::out | std::ios::trunc);
+            if (!file.is_open())
+            {
+                GDebugInfoCallback("RenderGraph", "failed to open " + path + " for the graph dump");
+                return false;
+            }
+            file << content;
+            file.flush();
+            if (!file)
+            {
+                GDebugInfoCallback("RenderGraph", "failed to write the graph dump to " + path);
+                return false;
+            }
+            return true;
+        };
+
+        bool dotWritten = writeFile(mDumpPath + ".dot", this->ExportGraphviz());
+        bool jsonWritten = writeFile(mDumpPath + ".json", this->ExportJson());
+        if (dotWritten && jsonWritten) { GDebugInfoCallback("RenderGraph", "dumped compiled graph to " + mDumpPath + ".dot and " + mDumpPath + ".json"); }
+        mDumpPath.clear();
+    }
+}
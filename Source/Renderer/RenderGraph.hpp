@@ -0,0 +1,327 @@
+#pragma once
+
+#include "Utilities/Utilities.hpp"
+#include "RHI/RHIForward.hpp"
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Renderer
+{
+    struct PassFlags
+    {
+        using Value = uint32_t;
+
+        enum Bits : Value
+        {
+            NONE = 0,
+            // 有外部副作用(回读、调试输出等)的Pass即使输出无人读取也不剔除
+            NEVER_CULL = 1 << 0,
+            // 没有输出附件的计算Pass可以在独立的计算队列上与图形工作并行执行，没有计算队列时仍在图形队列上执行
+            ASYNC_COMPUTE = 1 << 1,
+        };
+    };
+
+    struct RenderGraphStats
+    {
+        uint32_t DeclaredPasses = 0;
+        uint32_t CulledPasses = 0;
+        uint32_t ImageBarriers = 0;
+        uint32_t BufferBarriers = 0;
+        uint32_t TransientImages = 0;
+        uint32_t AliasingBarriers = 0;
+        uint32_t AsyncComputePasses = 0;
+        uint32_t OwnershipTransfers = 0;
+        // 作为前一个Pass的后续子通道合并执行的Pass数量，以及内容不离开渲染通道的附件数量
+        uint32_t MergedSubpasses = 0;
+        uint32_t MemorylessImages = 0;
+        // 本次编译是否直接复用了上一次的结果
+        bool bFromCache = false;
+    };
+
+    // 瞬态图像按生命周期共享内存的结果，偏移和大小以字节为单位，生命周期是执行顺序中的下标
+    struct AliasingPlan
+    {
+        struct Placement
+        {
+            std::string Resource;
+            uint32_t Heap = 0;
+            uint64_t Offset = 0;
+            uint64_t Size = 0;
+            uint32_t FirstPass = 0;
+            uint32_t LastPass = 0;
+            // 与该资源内存区间重叠的其他资源，首次使用前需要等待它们的访问完成
+            std::vector<uint32_t> Aliases;
+        };
+
+        std::vector<uint64_t> HeapSizes;
+        std::vector<Placement> Placements;
+        uint64_t AliasedBytes = 0;
+        uint64_t UnaliasedBytes = 0;
+    };
+
+    // 每帧重新声明Pass，依赖从PipelineVK的输出附件和AddDependency推导
+    // Compile生成执行顺序，剔除对输出没有贡献的Pass，并为每个Pass预先计算需要的资源转换
+    // 编译结果按图结构的哈希缓存，结构不变的帧只重新绑定导入资源和动态渲染附件
+    class RenderGraph
+    {
+    public:
+        using RecordFunction = std::function<void(RHI::Vulkan::RenderPassState& state)>;
+        // 返回与renderPass的subpass子通道兼容的管线，通常把RenderPass和Subpass填入GraphicsPipelineDesc后从PipelineCacheVK获取
+        using PipelineResolver = std::function<vk::Pipeline(vk::RenderPass renderPass, uint32_t subpass)>;
+        constexpr static uint32_t InvalidIndex = uint32_t(-1);
+
+        NOCOPY(RenderGraph)
+        RenderGraph() = default;
+        ~RenderGraph();
+
+        void Destroy();
+        // 清空上一帧声明的Pass和导入资源，编译结果和瞬态图像保留到下一帧复用
+        void Reset();
+        void SetRenderExtent(uint32_t width, uint32_t height);
+
+        // finalUsage不为UNKNOWN时，图执行结束后资源转换到该用途，同时视为图的输出
+        void ImportImage(const std::string& name, const RHI::Vulkan::ImageVK& image, RHI::ImageUsage::Bits finalUsage = RHI::ImageUsage::UNKNOWN);
+        void ImportBuffer(const std::string& name, const RHI::Vulkan::BufferVK& buffer, RHI::BufferUsage::Bits finalUsage = RHI::BufferUsage::UNKNOWN);
+        void MarkOutput(const std::string& name);
+
+        // 有输出附件的Pass使用动态渲染，否则作为计算Pass只绑定管线状态
+        uint32_t AddPass(const std::string& name, const RHI::Vulkan::PipelineVK& pipeline, const RHI::Vulkan::NativeRenderPass& renderPass, RecordFunction record, PassFlags::Value flags = PassFlags::NONE);
+        // 只有设置了解析函数的Pass参与子通道合并，合并后每次Compile用它替换NativeRenderPass::Pipeline
+        void SetPassPipelineResolver(uint32_t passIndex, PipelineResolver resolver);
+
+        void Compile();
+        void Execute(RHI::Vulkan::CommandBufferVK& commands);
+        // 开启后图形队列上的Pass分发到录制线程，各自录制secondary命令缓冲，屏障仍按执行顺序录制在主命令缓冲上
+        // 并行录制时Record只能录制绑定、绘制和调度，不能转换资源或依赖资源的跟踪状态
+        void SetParallelRecording(bool enabled) { mbParallelRecording = enabled; }
+        // 开启后，只以INPUT_ATTACHMENT读取前面Pass在同一像素输出的连续图形Pass合并为一个vk::RenderPass的多个子通道
+        // 合并后Pass的管线由SetPassPipelineResolver按GetMergedRenderPass返回的渲染通道和子通道创建，渲染通道结构不变时该句柄保持不变
+        void SetSubpassMerging(bool enabled) { mbSubpassMerging = enabled; mbCompiled = false; }
+
+        const RHI::Vulkan::ImageVK& GetImage(const std::string& name) const;
+        const RHI::Vulkan::BufferVK& GetBuffer(const std::string& name) const;
+        bool IsPassCulled(uint32_t passIndex) const { return mPasses[passIndex].bCulled; }
+        bool IsPassAsyncCompute(uint32_t passIndex) const { return mPasses[passIndex].bAsyncCompute; }
+        // 没有合并的Pass返回空句柄
+        vk::RenderPass GetMergedRenderPass(uint32_t passIndex) const;
+        uint32_t GetSubpassIndex(uint32_t passIndex) const { return mPasses[passIndex].Subpass; }
+
+        // 开启后记录图形队列上每个Pass的GPU时间，结果在同一虚拟帧下一次执行时读取，不等待GPU
+        void SetGpuTimings(bool enabled) { mbGpuTimings = enabled; }
+        // 上一轮完成的帧中该Pass的GPU时间(毫秒)，没有记录时返回负数
+        double GetPassGpuTime(const std::string& name) const;
+        // 编译后的图：Pass、资源、依赖边、屏障、别名分组、GPU时间和瞬态内存占用
+        std::string ExportGraphviz() const;
+        std::string ExportJson() const;
+        // 运行时随时调用，下一次Execute结束时写入pathPrefix.dot和pathPrefix.json
+        void RequestDump(const std::string& pathPrefix) { mDumpPath = pathPrefix; }
+        const std::vector<uint32_t>& GetExecutionOrder() const { return mExecutionOrder; }
+        const RenderGraphStats& GetStats() const { return mStats; }
+        const AliasingPlan& GetAliasingPlan() const { return mAliasingPlan; }
+
+    private:
+        struct ResourceAccess
+        {
+            uint32_t Resource = InvalidIndex;
+            // ImageUsage::Bits或BufferUsage::Bits，由资源类型决定
+            uint32_t Usage = 0;
+            bool bRead = false;
+            bool bWrite = false;
+            // 瞬态图像的首次访问，需要等待共享同一内存的其他图像
+            bool bAliasing = false;
+        };
+
+        // 在源队列上release，在目标队列上acquire，资源在目标队列上转换到Usage
+        struct OwnershipTransfer
+        {
+            uint32_t Resource = InvalidIndex;
+            uint32_t Usage = 0;
+        };
+
+        struct Pass
+        {
+            std::string Name;
+            const RHI::Vulkan::PipelineVK* Pipeline = nullptr;
+            RHI::Vulkan::NativeRenderPass RenderPass;
+            RecordFunction Record;
+            PipelineResolver ResolvePipeline;
+            PassFlags::Value Flags = PassFlags::NONE;
+
+            std::vector<ResourceAccess> Accesses;
+            // 执行前需要的转换，只包含用途变化或存在写入冲突的资源
+            std::vector<ResourceAccess> Barriers;
+            // 所有先后约束(RAW/WAR/WAW)决定排序，只有RAW的生产者决定是否剔除
+            std::vector<uint32_t> Dependencies;
+            std::vector<uint32_t> Producers;
+            // 从另一个队列接收的资源，替代这些资源在本Pass的普通屏障
+            std::vector<OwnershipTransfer> Acquires;
+            bool bCulled = false;
+            bool bAsyncCompute = false;
+            uint32_t MergedGroup = InvalidIndex;
+            uint32_t Subpass = 0;
+        };
+
+        struct Resource
+        {
+            std::string Name;
+            bool bIsBuffer = false;
+            bool bIsOutput = false;
+            // 被异步计算Pass访问的瞬态图像不参与别名
+            bool bAsyncAccess = false;
+            const RHI::Vulkan::ImageVK* Image = nullptr;
+            const RHI::Vulkan::BufferVK* Buffer = nullptr;
+            uint32_t FinalUsage = 0;
+
+            // 瞬态图像的声明，导入资源为空
+            bool bTransient = false;
+            RHI::Vulkan::PipelineVK::AttachmentDeclaration Declaration;
+            RHI::ImageUsage::Value UsageFlags = RHI::ImageUsage::UNKNOWN;
+            uint32_t TransientSlot = InvalidIndex;
+            // 只在一个合并的渲染通道内使用的瞬态附件，不需要写回内存
+            bool bMemoryless = false;
+
+            uint32_t FirstPass = InvalidIndex;
+            uint32_t LastPass = InvalidIndex;
+        };
+
+        // 决定瞬态图像和内存布局的全部参数，不变时沿用上一次的图像和别名方案
+        struct TransientDesc
+        {
+            std::string Name;
+            RHI::Format ImageFormat = { };
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            RHI::ImageOptions::Value Options = RHI::ImageOptions::DEFAULT;
+            RHI::ImageUsage::Value UsageFlags = RHI::ImageUsage::UNKNOWN;
+            uint32_t FirstPass = 0;
+            uint32_t LastPass = 0;
+            // 使用惰性分配的内存，与普通瞬态图像分开放置
+            bool bLazy = false;
+
+            bool operator==(const TransientDesc& other) const = default;
+        };
+
+        // 创建合并渲染通道的全部参数，相同时重新编译沿用已创建的vk::RenderPass，管线也因此保持兼容
+        struct MergedRenderPassLayout
+        {
+            std::vector<vk::AttachmentDescription> Attachments;
+            std::vector<std::vector<vk::AttachmentReference>> ColorReferences;
+            std::vector<std::vector<vk::AttachmentReference>> InputReferences;
+            std::vector<std::vector<uint32_t>> PreserveReferences;
+            std::vector<vk::AttachmentReference> DepthReferences;
+            std::vector<vk::SubpassDependency> Dependencies;
+
+            bool operator==(const MergedRenderPassLayout& other) const = default;
+        };
+
+        struct MergedFramebuffer
+        {
+            std::vector<vk::ImageView> Views;
+            vk::Framebuffer Handle;
+            uint64_t LastUsedFrame = 0;
+        };
+
+        // 合并为一个vk::RenderPass的连续Pass，按执行顺序依次作为子通道
+        struct MergedRenderPass
+        {
+            uint32_t FirstOrder = 0;
+            uint32_t PassCount = 0;
+            std::vector<uint32_t> Attachments;
+            // 每个附件在组内最后的用途，EndPass之后作为图像的跟踪状态
+            std::vector<RHI::ImageUsage::Bits> FinalUsages;
+            vk::RenderPass Handle;
+            // 导入图像每帧可能不同(例如交换链图像)，按附件视图缓存帧缓冲，超过虚拟帧数没有使用的帧缓冲会被销毁
+            std::vector<MergedFramebuffer> Framebuffers;
+        };
+
+    private:
+        uint32_t FindOrAddResource(const std::string& name, bool isBuffer);
+        size_t ComputeStructureHash() const;
+        bool CanRestoreCompiledGraph() const;
+        void RestoreCompiledGraph();
+        void CollectAccesses();
+        void BuildDependencies();
+        void CullPasses();
+        void SortPasses();
+        void ScheduleQueues();
+        void ComputeLifetimes();
+        void MergeSubpasses();
+        bool GetAttachmentExtent(uint32_t resourceIndex, vk::Extent2D& extent) const;
+        bool IsMergeableGraphicsPass(const Pass& pass, vk::Extent2D& extent) const;
+        bool CanMergeSubpass(uint32_t groupBegin, uint32_t orderIndex) const;
+        void AddMergedRenderPass(uint32_t groupBegin, uint32_t groupEnd);
+        void BuildMergedRenderPasses();
+        void SetupMergedRenderPasses();
+        void DestroyMergedRenderPasses();
+        vk::RenderPass FindOrCreateRenderPass(const MergedRenderPassLayout& layout);
+        void ReleaseUnusedRenderPasses();
+        void CreateTransientImages();
+        void BuildAliasingPlan(const std::vector<TransientDesc>& layout);
+        void DestroyTransientImages();
+        void ComputeBarriers();
+        void CountBarriers();
+        void RecordPasses(RHI::Vulkan::CommandBufferVK& commands, uint32_t begin, uint32_t end);
+        void RecordPassesParallel(RHI::Vulkan::CommandBufferVK& commands, uint32_t begin, uint32_t end);
+        void RecordPassBarriers(RHI::Vulkan::CommandBufferVK& commands, const Pass& pass);
+        void BeginGraphicsPass(RHI::Vulkan::CommandBufferVK& commands, const Pass& pass, vk::SubpassContents contents);
+        void EndGraphicsPass(RHI::Vulkan::CommandBufferVK& commands, const Pass& pass);
+        void StartGpuTimings(RHI::Vulkan::CommandBufferVK& commands);
+        void BeginPassTiming(RHI::Vulkan::CommandBufferVK& commands, const Pass& pass);
+        void EndPassTiming(RHI::Vulkan::CommandBufferVK& commands, const Pass& pass);
+        void WriteDump();
+        void RecordOwnershipTransfer(RHI::Vulkan::CommandBufferVK& commands, const OwnershipTransfer& transfer, bool release, bool toAsyncCompute);
+
+    private:
+        std::vector<Pass> mPasses;
+        std::vector<Resource> mResources;
+        std::unordered_map<std::string, uint32_t> mResourceLookup;
+
+        std::vector<TransientDesc> mTransientLayout;
+        std::vector<RHI::Vulkan::ImageVK> mTransientImages;
+        std::vector<VmaAllocation> mTransientHeaps;
+        AliasingPlan mAliasingPlan;
+        std::vector<RHI::Vulkan::ImageVKReference> mAliasedImages;
+
+        // 按录制顺序排列：异步计算依赖的图形Pass、异步计算Pass、与之并行的图形Pass、等待异步计算的图形Pass
+        std::vector<uint32_t> mExecutionOrder;
+        uint32_t mPreAsyncCount = 0;
+        uint32_t mAsyncCount = 0;
+        uint32_t mOverlapCount = 0;
+        std::vector<OwnershipTransfer> mGraphicsReleases;
+        std::vector<OwnershipTransfer> mComputeReleases;
+        std::vector<OwnershipTransfer> mFinalAcquires;
+        std::vector<std::pair<uint32_t, uint32_t>> mFinalTransitions;
+
+        // 上一次编译的Pass和资源，结构哈希相同时其中的编译结果直接移动到本帧
+        std::vector<Pass> mCachedPasses;
+        std::vector<Resource> mCachedResources;
+        std::unordered_map<std::string, uint32_t> mCachedResourceLookup;
+        size_t mCompiledHash = 0;
+        bool mbHasCompiledGraph = false;
+
+        std::vector<MergedRenderPass> mMergedPasses;
+        // 上一次编译使用的渲染通道，DestroyMergedRenderPasses只销毁帧缓冲，句柄在下一次编译不再使用时才销毁
+        std::vector<std::pair<MergedRenderPassLayout, vk::RenderPass>> mRenderPassCache;
+        // 每次SetupMergedRenderPasses递增，用于判断帧缓冲是否还可能被执行中的帧引用
+        uint64_t mFramebufferFrame = 0;
+        bool mbSubpassMerging = false;
+        bool mbParallelRecording = true;
+
+        RHI::Vulkan::TimestampQueryVK mTimestamps;
+        // 每个虚拟帧写入时间戳的Pass名称，第i个名称对应第2i和2i+1个查询
+        std::vector<std::vector<std::string>> mTimedPasses;
+        std::unordered_map<std::string, double> mPassGpuTimes;
+        size_t mTimestampFrame = 0;
+        bool mbGpuTimings = false;
+        std::string mDumpPath;
+        std::vector<const RHI::Vulkan::NativeRenderPass*> mParallelInheritance;
+
+        uint32_t mRenderWidth = 0;
+        uint32_t mRenderHeight = 0;
+        bool mbCompiled = false;
+        RenderGraphStats mStats;
+    };
+}
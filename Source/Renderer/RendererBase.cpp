@@ -56,8 +56,59 @@ namespace Renderer
         return { };
     }
 
+    // 只选择不支持图形的计算队列族，与图形队列共享族时无法真正并行执行
+    std::optional<uint32_t> DetermineComputeQueueFamilyIndex(const vk::PhysicalDevice device)
+    {
+        auto queueFamilyProperties = device.getQueueFamilyProperties();
+        for (uint32_t index = 0; index < (uint32_t)queueFamilyProperties.size(); index++)
+        {
+            const auto& property = queueFamilyProperties[index];
+            if ((property.queueCount > 0) &&
+                (property.queueFlags & vk::QueueFlagBits::eCompute) &&
+                !(property.queueFlags & vk::QueueFlagBits::eGraphics))
+            {
+                return index;
+            }
+        }
+        return { };
+    }
+
+    // 无绑定描述符堆、时间线信号量和动态渲染依赖的特性，缺少任何一项的设备不会被选择
+    std::vector<std::string> GetMissingRequiredFeatures(const vk::PhysicalDevice device)
+    {
+        vk::PhysicalDeviceVulkan13Features features13 {};
+        vk::PhysicalDeviceVulkan12Features features12 {};
+        features12.setPNext(&features13);
+        vk::PhysicalDeviceFeatures2 features2 {};
+        features2.setPNext(&features12);
+        device.getFeatures2(&features2);
+
+        std::vector<std::string> missing;
+        auto require = [&missing](vk::Bool32 supported, const char* name) { if (!supported) { missing.push_back(name); } };
+        require(features12.bufferDeviceAddress, "bufferDeviceAddress");
+        require(features12.descriptorIndexing, "descriptorIndexing");
+        require(features12.runtimeDescriptorArray, "runtimeDescriptorArray");
+        require(features12.descriptorBindingPartiallyBound, "descriptorBindingPartiallyBound");
+        require(features12.descriptorBindingUpdateUnusedWhilePending, "descriptorBindingUpdateUnusedWhilePending");
+        require(features12.descriptorBindingSampledImageUpdateAfterBind, "descriptorBindingSampledImageUpdateAfterBind");
+        require(features12.descriptorBindingStorageImageUpdateAfterBind, "descriptorBindingStorageImageUpdateAfterBind");
+        require(features12.descriptorBindingStorageBufferUpdateAfterBind, "descriptorBindingStorageBufferUpdateAfterBind");
+        require(features12.timelineSemaphore, "timelineSemaphore");
+        require(features12.hostQueryReset, "hostQueryReset");
+        require(features13.synchronization2, "synchronization2");
+        require(features13.dynamicRendering, "dynamicRendering");
+        return missing;
+    }
+
     void RendererBase::InitContext(const RendererCreateInfo &createInfo)
     {
+        mbNullBackend = createInfo.bNullBackend;
+        if (mbNullBackend)
+        {
+            this->InitNullContext(createInfo);
+            return;
+        }
+
         vk::ApplicationInfo appInfo {};
         appInfo.setPApplicationName(createInfo.ApplicationName);
         appInfo.setApplicationVersion(VK_MAKE_VERSION(1, 3, 0));
@@ -130,11 +181,23 @@ namespace Renderer
                 GDebugInfoCallback("Renderer", "  - no suitable queue family found");
                 continue;
             }
+            auto missingFeatures = GetMissingRequiredFeatures(pd);
+            if (!missingFeatures.empty())
+            {
+                for (const auto& feature : missingFeatures) { GDebugInfoCallback("Renderer", "  - missing required feature " + feature); }
+                continue;
+            }
             mPhysicalDevice = pd;
             mPhysicalDeviceProperties = properties;
             mQueueFamilyIndex = queueFamilyIndex.value();
             if (properties.deviceType == vk::PhysicalDeviceType::eDiscreteGpu) { break; }
         }
+        if (!mPhysicalDevice)
+        {
+            GDebugInfoCallback("Renderer", "No physical device supports the required queues and features");
+            assert(false);
+            return;
+        }
         GDebugInfoCallback("Renderer", "Selected physical device: " + std::string(mPhysicalDeviceProperties.deviceName.data()));
 
         auto presentModes = mPhysicalDevice.getSurfacePresentModesKHR(mSurface);
@@ -158,32 +221,105 @@ namespace Renderer
         GDebugInfoCallback("Renderer", "Selected surface format: " + std::string(vk::to_string(mSurfaceFormat.format)));
         GDebugInfoCallback("Renderer", "Selected present mode: " + std::string(vk::to_string(mPresentMode)));
 
-        vk::DeviceQueueCreateInfo deviceQueueCI {};
         std::array queuePriorities = { 1.0f };
-        deviceQueueCI.setQueueFamilyIndex(mQueueFamilyIndex);
-        deviceQueueCI.setQueuePriorities(queuePriorities);
+        std::vector<vk::DeviceQueueCreateInfo> deviceQueueCIs(1);
+        deviceQueueCIs[0].setQueueFamilyIndex(mQueueFamilyIndex);
+        deviceQueueCIs[0].setQueuePriorities(queuePriorities);
 
-        auto deviceExtensions = {
+        auto computeQueueFamilyIndex = DetermineComputeQueueFamilyIndex(mPhysicalDevice);
+        mbAsyncComputeEnabled = createInfo.bEnableAsyncCompute && computeQueueFamilyIndex.has_value();
+        if (mbAsyncComputeEnabled)
+        {
+            mComputeQueueFamilyIndex = computeQueueFamilyIndex.value();
+            auto& computeQueueCI = deviceQueueCIs.emplace_back();
+            computeQueueCI.setQueueFamilyIndex(mComputeQueueFamilyIndex);
+            computeQueueCI.setQueuePriorities(queuePriorities);
+        }
+        GDebugInfoCallback("Renderer", std::string("Async compute: ") + (mbAsyncComputeEnabled ? "queue family " + std::to_string(mComputeQueueFamilyIndex) : "disabled"));
+
+        std::vector<const char*> deviceExtensions = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
             VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
             VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
         };
+
+        auto supportedDeviceExt = mPhysicalDevice.enumerateDeviceExtensionProperties();
+        auto isDeviceExtSupported = [&supportedDeviceExt](const char* name)
+        {
+            return std::find_if(supportedDeviceExt.begin(), supportedDeviceExt.end(),
+                [name](const vk::ExtensionProperties& extension) { return std::strcmp(extension.extensionName.data(), name) == 0; }) != supportedDeviceExt.end();
+        };
+
+        // 扩展存在时还需要确认descriptorBuffer特性，特性结构只能在扩展支持时查询
+        mbDescriptorBufferEnabled = createInfo.bPreferDescriptorBuffer && isDeviceExtSupported(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+        if (mbDescriptorBufferEnabled)
+        {
+            auto features = mPhysicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDescriptorBufferFeaturesEXT>();
+            mbDescriptorBufferEnabled = features.get<vk::PhysicalDeviceDescriptorBufferFeaturesEXT>().descriptorBuffer;
+        }
+        if (mbDescriptorBufferEnabled) { deviceExtensions.push_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME); }
+        GDebugInfoCallback("Renderer", std::string("Descriptor backend: ") + (mbDescriptorBufferEnabled ? "descriptor buffer" : "descriptor pool"));
         auto deviceLayers = {
             VK_KRONOS_VALIDATION_LAYER_NAME,
         };
 
+        // 必需的特性在选择设备时已经检查，可选的1.2特性按设备支持情况启用
+        vk::PhysicalDeviceVulkan12Features supportedFeatures12 {};
+        vk::PhysicalDeviceFeatures2 supportedFeatures2 {};
+        supportedFeatures2.setPNext(&supportedFeatures12);
+        mPhysicalDevice.getFeatures2(&supportedFeatures2);
+        mbDrawIndirectCountEnabled = supportedFeatures12.drawIndirectCount;
+
         vk::PhysicalDeviceVulkan12Features features12 {};
         features12.setBufferDeviceAddress(true);
         features12.setDescriptorIndexing(true);
+        features12.setRuntimeDescriptorArray(true);
+        features12.setDescriptorBindingPartiallyBound(true);
+        features12.setDescriptorBindingUpdateUnusedWhilePending(true);
+        features12.setDescriptorBindingSampledImageUpdateAfterBind(true);
+        features12.setDescriptorBindingStorageImageUpdateAfterBind(true);
+        features12.setDescriptorBindingStorageBufferUpdateAfterBind(true);
+        // 非一致索引只在着色器使用nonuniformEXT时需要
+        features12.setShaderSampledImageArrayNonUniformIndexing(supportedFeatures12.shaderSampledImageArrayNonUniformIndexing);
+        features12.setShaderStorageImageArrayNonUniformIndexing(supportedFeatures12.shaderStorageImageArrayNonUniformIndexing);
+        features12.setShaderStorageBufferArrayNonUniformIndexing(supportedFeatures12.shaderStorageBufferArrayNonUniformIndexing);
+        features12.setDrawIndirectCount(mbDrawIndirectCountEnabled);
+        // 帧内多次提交以及与计算队列之间的同步使用时间线信号量
+        features12.setTimelineSemaphore(true);
+        // 新建的时间戳查询池在主机端重置，之后每帧在命令缓冲上重置
+        features12.setHostQueryReset(true);
+
+        vk::PhysicalDeviceVulkan13Features features13 {};
+        features13.setSynchronization2(true);
+        features13.setDynamicRendering(true);
+        features12.setPNext(&features13);
+
+        vk::PhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures {};
+        descriptorBufferFeatures.setDescriptorBuffer(true);
+        if (mbDescriptorBufferEnabled) { features13.setPNext(&descriptorBufferFeatures); }
+
+        auto supportedFeatures = mPhysicalDevice.getFeatures();
+        vk::PhysicalDeviceFeatures features {};
+        features.setSamplerAnisotropy(supportedFeatures.samplerAnisotropy);
+        // 计算着色器逐mip写入时使用不带格式的存储图像数组
+        features.setShaderStorageImageReadWithoutFormat(supportedFeatures.shaderStorageImageReadWithoutFormat);
+        features.setShaderStorageImageWriteWithoutFormat(supportedFeatures.shaderStorageImageWriteWithoutFormat);
+        features.setShaderStorageImageArrayDynamicIndexing(supportedFeatures.shaderStorageImageArrayDynamicIndexing);
+        // 一次间接调用提交多个绘制，并通过firstInstance传递每个绘制的索引
+        features.setMultiDrawIndirect(supportedFeatures.multiDrawIndirect);
+        features.setDrawIndirectFirstInstance(supportedFeatures.drawIndirectFirstInstance);
 
         vk::DeviceCreateInfo deviceCI {};
-        deviceCI.setQueueCreateInfos(deviceQueueCI);
+        deviceCI.setPEnabledFeatures(&features);
+        deviceCI.setQueueCreateInfos(deviceQueueCIs);
         deviceCI.setPEnabledExtensionNames(deviceExtensions);
         deviceCI.setPEnabledLayerNames(deviceLayers);
         deviceCI.setPNext(&features12);
 
         mDevice = mPhysicalDevice.createDevice(deviceCI);
+        mEnabledFeatures = features;
         mDeviceQueue = mDevice.getQueue(mQueueFamilyIndex, 0);
+        if (mbAsyncComputeEnabled) { mComputeQueue = mDevice.getQueue(mComputeQueueFamilyIndex, 0); }
         GDebugInfoCallback("Renderer", "Created logical device");
 
         mDynamicDispatch.init(mInstance, mDevice);
@@ -199,29 +335,62 @@ namespace Renderer
         allocatorCI.device = mDevice;
         allocatorCI.instance = mInstance;
         allocatorCI.vulkanApiVersion = appInfo.apiVersion;
+        allocatorCI.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
         vmaCreateAllocator(&allocatorCI, &mAllocator);
         GDebugInfoCallback("Renderer", "Created allocator");
 
+        mBindlessHeap.Init(mInFlightFrames);
+        GDebugInfoCallback("Renderer", "Created bindless heap");
+
+        mSamplerCache.Init(mInFlightFrames);
+        mPipelineCache.Init(mInFlightFrames, createInfo.PipelineCachePath, createInfo.PipelineCacheSaveInterval);
+        GDebugInfoCallback("Renderer", "Created pipeline cache");
+
         glslang::InitializeProcess();
         GDebugInfoCallback("Renderer", "Initialized glslang");
 
         RecreateSwapchain(surfaceCapabilities.maxImageExtent.width, surfaceCapabilities.maxImageExtent.height);
         GDebugInfoCallback("Renderer", "Created swapchain");
 
-        mImageAvailableSemaphore = mDevice.createSemaphore({});
-        mRenderFinishedSemaphore = mDevice.createSemaphore({});
         mImmediateFence = mDevice.createFence({});
 
-        vk::CommandPoolCreateInfo commandPoolCI;
-        commandPoolCI.setQueueFamilyIndex(mQueueFamilyIndex);
-        commandPoolCI.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient);
-        mCommandPool = mDevice.createCommandPool(commandPoolCI);
+        this->InitFrameResources(createInfo);
+    }
 
-        // vk::CommandBufferAllocateInfo commandBufferAI;
-        // commandBufferAI.setCommandPool(mCommandPool);
-        // commandBufferAI.setLevel(vk::CommandBufferLevel::ePrimary);
-        // commandBufferAI.setCommandBufferCount(mInFlightFrames);
-        
+    void RendererBase::InitNullContext(const RendererCreateInfo &createInfo)
+    {
+        GDebugInfoCallback("Renderer", "Using null backend, no vulkan objects will be created");
+
+        mInFlightFrames = 3;
+        mQueueFamilyIndex = 0;
+        mbDescriptorBufferEnabled = false;
+        mbAsyncComputeEnabled = false;
+        mSurfaceExtent = vk::Extent2D{ createInfo.Width, createInfo.Height };
+
+        mBindlessHeap.Init(mInFlightFrames);
+        mSamplerCache.Init(mInFlightFrames);
+        mPipelineCache.Init(mInFlightFrames, createInfo.PipelineCachePath, createInfo.PipelineCacheSaveInterval);
+        this->InitFrameResources(createInfo);
+    }
+
+    void RendererBase::InitFrameResources(const RendererCreateInfo &createInfo)
+    {
+        mImmediateCommandPool.Init(mQueueFamilyIndex);
+
+        mVirtualFrames.Init(mInFlightFrames, createInfo.StageBufferSize);
+        GDebugInfoCallback("Renderer", "Created " + std::to_string(mInFlightFrames) + " virtual frames");
+
+        uint32_t recordingThreadCount = createInfo.RecordingThreadCount;
+        if (recordingThreadCount == 0) { recordingThreadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1; }
+        mParallelRecorder.Init(recordingThreadCount, mInFlightFrames);
+        GDebugInfoCallback("Renderer", "Created " + std::to_string(recordingThreadCount) + " recording threads");
+
+        if (mbDescriptorBufferEnabled)
+        {
+            mDescriptorBuffer.Init(mInFlightFrames, createInfo.DescriptorBufferFrameSize);
+            GDebugInfoCallback("Renderer", "Created descriptor buffer ring");
+        }
+        mDescriptorCache.Init();
     }
 
     void RendererBase::RecreateSwapchain(uint32_t surfaceWidth, uint32_t surfaceHeight)
@@ -230,6 +399,13 @@ namespace Renderer
 
     void RendererBase::BeginFrame()
     {
+        mSamplerCache.CollectUnused();
+        mPipelineCache.AdvanceFrame();
+        mBindlessHeap.AdvanceFrame();
+        mBindlessHeap.FlushWrites();
+        mVirtualFrames.StartFrame();
+        if (mVirtualFrames.IsFrameRunning()) { mParallelRecorder.StartFrame(mVirtualFrames.GetCurrentFrameIndex()); }
+        if (mbDescriptorBufferEnabled) { mDescriptorBuffer.StartFrame(mVirtualFrames.GetCurrentFrameIndex()); }
     }
 
     void RendererBase::RenderFrame()
@@ -238,10 +414,71 @@ namespace Renderer
 
     void RendererBase::EndFrame()
     {
+        if (mbDescriptorBufferEnabled) { mDescriptorBuffer.Flush(); }
+        mVirtualFrames.EndFrame();
     }
 
     void RendererBase::Cleanup()
     {
+        if (!mbNullBackend) { mDevice.waitIdle(); }
+        mParallelRecorder.Destroy();
+        mVirtualFrames.Destroy();
+        mImmediateCommandPool.Destroy();
+        mDescriptorCache.Destroy();
+        if (mbDescriptorBufferEnabled) { mDescriptorBuffer.Destroy(); }
+        mSamplerCache.Destroy();
+        mPipelineCache.Destroy();
+        mBindlessHeap.Destroy();
+    }
+
+    bool RendererBase::IsFrameRunning() const
+    {
+        return mVirtualFrames.IsFrameRunning();
+    }
+
+    RHI::Vulkan::CommandBufferVK &RendererBase::GetCurrentCommandBuffer()
+    {
+        return mVirtualFrames.GetCurrentFrame().Commands;
+    }
+
+    RHI::Vulkan::StageBufferVK &RendererBase::GetCurrentStageBuffer()
+    {
+        return mVirtualFrames.GetCurrentFrame().StagingBuffer;
+    }
+
+    RHI::Vulkan::DescriptorAllocatorVK &RendererBase::GetCurrentDescriptorAllocator()
+    {
+        return mVirtualFrames.GetCurrentFrame().Descriptors;
+    }
+
+    RHI::Vulkan::CommandPoolVK &RendererBase::GetCurrentCommandPool()
+    {
+        return mVirtualFrames.GetCurrentFrame().CommandPool;
+    }
+
+    RHI::Vulkan::CommandBufferVK &RendererBase::GetImmediateCommandBuffer()
+    {
+        // 上一次立即提交已经等待完成，直接整体重置
+        mImmediateCommandPool.Reset();
+        mCommandBuffer = RHI::Vulkan::CommandBufferVK{ mImmediateCommandPool.Acquire() };
+        mCommandBuffer.Begin();
+        return mCommandBuffer;
+    }
+
+    void RendererBase::SubmitCommandsImmediate(RHI::Vulkan::CommandBufferVK &commands)
+    {
+        commands.End();
+        if (mbNullBackend) { return; }
+
+        vk::CommandBufferSubmitInfo cmdBufferInfo {};
+        cmdBufferInfo.setCommandBuffer(commands.GetNativeCmdBuffer());
+
+        vk::SubmitInfo2 submitInfo {};
+        submitInfo.setCommandBufferInfos(cmdBufferInfo);
+        mDeviceQueue.submit2(submitInfo, mImmediateFence);
+
+        (void)mDevice.waitForFences(mImmediateFence, true, UINT64_MAX);
+        mDevice.resetFences(mImmediateFence);
     }
 }
 
@@ -22,6 +22,20 @@ namespace Renderer
         uint32_t Width = 1280;
         uint32_t Height = 720;
         bool bEnableValidationLayers = true;
+        size_t StageBufferSize = 64 * 1024 * 1024;
+        // 设备支持VK_EXT_descriptor_buffer及其特性时使用描述符缓冲，否则回退到DescriptorPool
+        // Pass通过SetupPassDescriptors写入描述符，两种模式下BeginPass的绑定方式随之切换
+        bool bPreferDescriptorBuffer = true;
+        size_t DescriptorBufferFrameSize = 4 * 1024 * 1024;
+        // 并行录制的工作线程数，0表示使用硬件线程数减一
+        uint32_t RecordingThreadCount = 0;
+        // 不创建任何Vulkan对象，命令和资源调用只做状态跟踪与统计后立即完成，用于在没有GPU的机器上测量引擎自身的CPU开销
+        bool bNullBackend = false;
+        // 设备有不支持图形的独立计算队列族时，RenderGraph可以把标记为异步计算的Pass调度到该队列上
+        bool bEnableAsyncCompute = true;
+        // 驱动管线缓存的保存路径，为空时不读写磁盘；除了关闭时保存，每隔PipelineCacheSaveInterval帧也会保存一次，0表示只在关闭时保存
+        std::string PipelineCachePath = "PipelineCache.bin";
+        uint32_t PipelineCacheSaveInterval = 3600;
     };
 
     class RendererBase
@@ -43,26 +57,55 @@ namespace Renderer
         const RHI::Vulkan::ImageVK& AcquireCurrentSwapchainImage(RHI::ImageUsage::Bits usage);
         RHI::Vulkan::CommandBufferVK& GetCurrentCommandBuffer();
         RHI::Vulkan::StageBufferVK& GetCurrentStageBuffer();
+        RHI::Vulkan::DescriptorAllocatorVK& GetCurrentDescriptorAllocator();
+        // 额外的命令缓冲在本帧结束后自动回收，不需要释放
+        RHI::Vulkan::CommandPoolVK& GetCurrentCommandPool();
         size_t GetVirtualFrameCount() const { return mVirtualFrames.GetFrameCount(); }
-        void SubmitCommandsImmediate(const RHI::Vulkan::CommandBufferVK& commands);
+        size_t GetCurrentFrameIndex() const { return mVirtualFrames.GetCurrentFrameIndex(); }
+        const RHI::Vulkan::CommandBufferStats& GetLastFrameStats() const { return mVirtualFrames.GetLastFrameStats(); }
+        void SubmitCommandsImmediate(RHI::Vulkan::CommandBufferVK& commands);
         RHI::Vulkan::CommandBufferVK& GetImmediateCommandBuffer();
 
+        // 帧内多次提交，用于与异步计算队列同步，见VirtualFrameProvider
+        uint64_t SubmitCurrentCommands() { return mVirtualFrames.SubmitCommands(); }
+        RHI::Vulkan::CommandBufferVK AcquireAsyncComputeCommands() { return mVirtualFrames.AcquireComputeCommands(); }
+        uint64_t SubmitAsyncCompute(const RHI::Vulkan::CommandBufferVK& commands, uint64_t waitValue) { return mVirtualFrames.SubmitAsyncCompute(commands, waitValue); }
+        void WaitAsyncCompute(uint64_t value) { mVirtualFrames.WaitTimeline(value); }
+
         const vk::Instance& GetInstance() const { return mInstance; }
         const vk::PhysicalDevice& GetPhysicalDevice() const { return mPhysicalDevice; }
+        const vk::PhysicalDeviceProperties& GetPhysicalDeviceProperties() const { return mPhysicalDeviceProperties; }
+        // 创建设备时实际启用的核心特性，可选特性使用前需要检查
+        const vk::PhysicalDeviceFeatures& GetEnabledFeatures() const { return mEnabledFeatures; }
         const vk::Device& GetDevice() const { return mDevice; }
         const vk::Queue& GetDeviceQueue() const { return mDeviceQueue; }
-        const vk::CommandPool& GetCommandPool() const { return mCommandPool; }
+        uint32_t GetQueueFamilyIndex() const { return mQueueFamilyIndex; }
+        const vk::Queue& GetComputeQueue() const { return mComputeQueue; }
+        uint32_t GetComputeQueueFamilyIndex() const { return mComputeQueueFamilyIndex; }
+        bool IsAsyncComputeEnabled() const { return mbAsyncComputeEnabled; }
+        // 不支持时不能使用CommandBufferVK::DrawIndexedIndirectCount
+        bool IsDrawIndirectCountEnabled() const { return mbDrawIndirectCountEnabled; }
         const vk::SwapchainKHR& GetSwapchain() const { return mSwapchain; }
         const vk::SurfaceKHR& GetSurface() const { return mSurface; }
-        const vk::Semaphore& GetImageAvailableSemaphore() const { return mImageAvailableSemaphore; }
-        const vk::Semaphore& GetRenderFinishedSemaphore() const { return mRenderFinishedSemaphore; }
         RHI::Vulkan::DescriptorCacheVK& GetDescriptorCache() { return mDescriptorCache; }
+        RHI::Vulkan::BindlessHeapVK& GetBindlessHeap() { return mBindlessHeap; }
+        RHI::Vulkan::SamplerCacheVK& GetSamplerCache() { return mSamplerCache; }
+        RHI::Vulkan::PipelineCacheVK& GetPipelineCache() { return mPipelineCache; }
+        RHI::Vulkan::ParallelRecorderVK& GetParallelRecorder() { return mParallelRecorder; }
+        RHI::Vulkan::DescriptorBufferVK& GetDescriptorBuffer() { return mDescriptorBuffer; }
+        bool IsDescriptorBufferEnabled() const { return mbDescriptorBufferEnabled; }
+        const vk::DispatchLoaderDynamic& GetDynamicDispatch() const { return mDynamicDispatch; }
         const VmaAllocator& GetAllocator() const { return mAllocator; }
         bool IsRenderingEnabled() const { return mbRenderingEnabled; }
+        bool IsNullBackend() const { return mbNullBackend; }
 
         const RHI::Vulkan::ImageVK& AcquireSwapchainImage(size_t index, RHI::ImageUsage::Bits usage);
         const RHI::ImageUsage::Bits GetSwapchainImageUsage(size_t index) const;
 
+    private:
+        void InitNullContext(const RendererCreateInfo& createInfo);
+        void InitFrameResources(const RendererCreateInfo& createInfo);
+
     private:
         vk::Instance mInstance;
         vk::SurfaceKHR mSurface;
@@ -72,18 +115,24 @@ namespace Renderer
 
         vk::PhysicalDevice mPhysicalDevice;
         vk::PhysicalDeviceProperties mPhysicalDeviceProperties;
+        vk::PhysicalDeviceFeatures mEnabledFeatures;
         vk::Device mDevice;
         vk::Queue mDeviceQueue;
         uint32_t mQueueFamilyIndex;
+        vk::Queue mComputeQueue;
+        uint32_t mComputeQueueFamilyIndex = 0;
 
-        vk::Semaphore mImageAvailableSemaphore;
-        vk::Semaphore mRenderFinishedSemaphore;
         vk::Fence mImmediateFence;
 
-        vk::CommandPool mCommandPool;
+        RHI::Vulkan::CommandPoolVK mImmediateCommandPool;
         RHI::Vulkan::CommandBufferVK mCommandBuffer;
         RHI::Vulkan::VirtualFrameProvider mVirtualFrames;
         RHI::Vulkan::DescriptorCacheVK mDescriptorCache;
+        RHI::Vulkan::BindlessHeapVK mBindlessHeap;
+        RHI::Vulkan::SamplerCacheVK mSamplerCache;
+        RHI::Vulkan::PipelineCacheVK mPipelineCache;
+        RHI::Vulkan::DescriptorBufferVK mDescriptorBuffer;
+        RHI::Vulkan::ParallelRecorderVK mParallelRecorder;
 
         vk::SwapchainKHR mSwapchain;
         vk::DebugUtilsMessengerEXT mDebugMessenger;
@@ -92,6 +141,10 @@ namespace Renderer
         VmaAllocator mAllocator;
 
         bool mbRenderingEnabled = true;
+        bool mbDescriptorBufferEnabled = false;
+        bool mbNullBackend = false;
+        bool mbAsyncComputeEnabled = false;
+        bool mbDrawIndirectCountEnabled = false;
         uint8_t mInFlightFrames;
         uint32_t mFrameIndex = 0;
 
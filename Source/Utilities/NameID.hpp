@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Utilities.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Utilities
+{
+    // 64位FNV-1a，字面量可在编译期求值
+    constexpr uint64_t HashName(std::string_view name)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : name)
+        {
+            hash ^= (uint64_t)(uint8_t)c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    struct NameHash
+    {
+        uint64_t Value = 0;
+        std::string_view Name;
+
+        constexpr NameHash() = default;
+        constexpr NameHash(std::string_view name) : Value(HashName(name)), Name(name) { }
+        template <size_t N>
+        constexpr NameHash(const char (&name)[N]) : NameHash(std::string_view(name, N - 1)) { }
+    };
+
+    // 把名字映射为连续的整数索引，资源表可以直接用索引寻址
+    class NameRegistry
+    {
+    public:
+        static NameRegistry& Get()
+        {
+            static NameRegistry registry;
+            return registry;
+        }
+
+        uint32_t Intern(NameHash hash)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mIndices.find(hash.Value);
+            if (it != mIndices.end())
+            {
+                // 两个名字共享同一个索引会让资源表静默地返回错误的资源，发布版本同样终止
+                if (mNames[it->second] != hash.Name)
+                {
+                    GDebugInfoCallback("NameID", "hash collision between " + mNames[it->second] + " and " + std::string(hash.Name));
+                    std::abort();
+                }
+                return it->second;
+            }
+            uint32_t index = uint32_t(mNames.size());
+            mNames.emplace_back(hash.Name);
+            mIndices.emplace(hash.Value, index);
+            return index;
+        }
+
+        std::string GetName(uint32_t index) const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return index < mNames.size() ? mNames[index] : std::string();
+        }
+
+        uint32_t GetCount() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return uint32_t(mNames.size());
+        }
+
+    private:
+        mutable std::mutex mMutex;
+        std::unordered_map<uint64_t, uint32_t> mIndices;
+        std::vector<std::string> mNames;
+    };
+
+    // 构造时需要加锁查找注册表，每帧使用的名字应保存为static const NameID
+    struct NameID
+    {
+        constexpr static uint32_t InvalidIndex = uint32_t(-1);
+
+        uint32_t Index = InvalidIndex;
+
+        NameID() = default;
+        explicit NameID(NameHash hash) : Index(NameRegistry::Get().Intern(hash)) { }
+        explicit NameID(const std::string& name) : NameID(NameHash(std::string_view(name))) { }
+        explicit NameID(const char* name) : NameID(NameHash(std::string_view(name))) { }
+
+        bool IsValid() const { return Index != InvalidIndex; }
+        std::string GetName() const { return NameRegistry::Get().GetName(Index); }
+
+        bool operator==(const NameID& other) const { return Index == other.Index; }
+        bool operator!=(const NameID& other) const { return Index != other.Index; }
+    };
+
+    namespace Literals
+    {
+        constexpr NameHash operator""_name(const char* name, size_t length)
+        {
+            return NameHash(std::string_view(name, length));
+        }
+    }
+}
@@ -5,7 +5,9 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <memory>
 
 namespace Utilities
 {
@@ -35,53 +37,58 @@ namespace Utilities
         void SetThreadCount(uint32_t count);
         void Wait();
 
-    public:
+        uint32_t GetThreadCount() const { return (uint32_t)mThreads.size(); }
+        // 任务按线程顺序执行，同一线程上的任务不会并发
+        Thread& GetThread(uint32_t index) { return *mThreads[index]; }
+
+    private:
         std::vector<std::unique_ptr<Thread>> mThreads;
     };
 
-    Thread::Thread()
+    inline Thread::Thread()
     {
         mWorker = std::thread(&Thread::queueLoop, this);
     }
 
-    Thread::~Thread()
+    inline Thread::~Thread()
     {
         if (mWorker.joinable())
         {
             Wait();
             mQueueMutex.lock();
             mbDestroying = true;
-            mCondition.notify_one();
+            mCondition.notify_all();
             mQueueMutex.unlock();
             mWorker.join();
         }
     }
 
-    void Thread::AddJob(std::function<void()> function)
+    inline void Thread::AddJob(std::function<void()> function)
     {
         std::lock_guard<std::mutex> lock(mQueueMutex);
         mJobQueue.push(std::move(function));
-        mCondition.notify_one();
+        // Wait()与工作线程共用同一个条件变量，必须全部唤醒
+        mCondition.notify_all();
     }
 
-    void Thread::Wait()
+    inline void Thread::Wait()
     {
         std::unique_lock<std::mutex> lock(mQueueMutex);
         mCondition.wait(lock, [this]() { return mJobQueue.empty(); });
     }
 
-    void ThreadPool::SetThreadCount(uint32_t count)
+    inline void ThreadPool::SetThreadCount(uint32_t count)
     {
         mThreads.clear();
-        for (auto i = 0; i < count; i++) mThreads.push_back(std::make_unique<Thread>());
+        for (uint32_t i = 0; i < count; i++) mThreads.push_back(std::make_unique<Thread>());
     }
 
-    void ThreadPool::Wait()
+    inline void ThreadPool::Wait()
     {
         for (auto & t : mThreads) t->Wait();
     }
 
-    void Thread::queueLoop()
+    inline void Thread::queueLoop()
     {
         while (true)
         {
@@ -96,7 +103,7 @@ namespace Utilities
             {
                 std::lock_guard<std::mutex> lock(mQueueMutex);
                 mJobQueue.pop();
-                mCondition.notify_one();
+                mCondition.notify_all();
             }
         }
     }
@@ -34,6 +34,13 @@ static std::function<void(const std::string&, const std::string&)> GDebugInfoCal
 
 namespace Utilities
 {
+    // 把value的哈希合并进seed，用于由多个字段组成的缓存键
+    template<typename T>
+    inline void HashCombine(size_t& seed, const T& value)
+    {
+        seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
     class FileUtils
     {
     public:
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "Core/VaultEngine.hpp"
+#include "Renderer/RenderGraph.hpp"
+
+#include <deque>
+
+using namespace RHI;
+using namespace RHI::Vulkan;
+
+// 空后端不创建Vulkan对象，在没有GPU的机器上验证RenderGraph的编译结果
+class RenderGraphTest : public testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        Renderer::RendererCreateInfo rendererCI;
+        rendererCI.Width = Width;
+        rendererCI.Height = Height;
+        rendererCI.bNullBackend = true;
+        rendererCI.PipelineCachePath = "";
+        rendererCI.RecordingThreadCount = 1;
+        Core::VaultEngine::GetInstance()->Init(nullptr, rendererCI);
+    }
+
+    static void TearDownTestSuite()
+    {
+        Core::VaultEngine::GetInstance()->Shutdown();
+    }
+
+    void SetUp() override
+    {
+        mOutput.Init(Width, Height, Format::R8G8B8A8_UNORM, ImageUsage::COLOR_ATTACHMENT | ImageUsage::SHADER_READ, MemoryUsage::GPUOnly, ImageOptions::DEFAULT);
+        mGraph.SetRenderExtent(Width, Height);
+    }
+
+    // 读取inputs并写入output的图形Pass，output不是导入图像时声明为瞬态图像
+    uint32_t AddPass(const std::string& name, std::initializer_list<const char*> inputs, const std::string& output, PassFlags::Value flags = PassFlags::NONE)
+    {
+        auto& pipeline = mPipelines.emplace_back();
+        for (const char* input : inputs) { pipeline.AddDependency(input, ImageUsage::SHADER_READ); }
+        if (output != "Output") { pipeline.DeclareAttachment(output, Format::R8G8B8A8_UNORM); }
+        pipeline.AddOutputAttachment(output, ClearColor{ });
+        return mGraph.AddPass(name, pipeline, NativeRenderPass{ }, [](RenderPassState&) { }, flags);
+    }
+
+    // T0 -> T1 -> T2 -> Output，T0和T2的生命周期不重叠，可以共享内存
+    void DeclareChain()
+    {
+        mGraph.ImportImage("Output", mOutput, ImageUsage::SHADER_READ);
+        this->AddPass("First", { }, "T0");
+        this->AddPass("Second", { "T0" }, "T1");
+        this->AddPass("Third", { "T1" }, "T2");
+        this->AddPass("Final", { "T2" }, "Output");
+    }
+
+protected:
+    constexpr static uint32_t Width = 64;
+    constexpr static uint32_t Height = 64;
+
+    ImageVK mOutput;
+    std::deque<PipelineVK> mPipelines;
+    Renderer::RenderGraph mGraph;
+};
+
+TEST_F(RenderGraphTest, CullsPassesWithoutOutputContribution)
+{
+    this->DeclareChain();
+    uint32_t unused = this->AddPass("Unused", { "T0" }, "Scratch");
+    uint32_t debug = this->AddPass("Debug", { "T1" }, "DebugView", PassFlags::NEVER_CULL);
+    mGraph.Compile();
+
+    EXPECT_TRUE(mGraph.IsPassCulled(unused));
+    EXPECT_FALSE(mGraph.IsPassCulled(debug));
+    EXPECT_EQ(mGraph.GetStats().CulledPasses, 1u);
+    EXPECT_EQ(mGraph.GetExecutionOrder().size(), 5u);
+}
+
+TEST_F(RenderGraphTest, AliasesTransientImagesWithDisjointLifetimes)
+{
+    this->DeclareChain();
+    mGraph.Compile();
+
+    const auto& plan = mGraph.GetAliasingPlan();
+    EXPECT_EQ(mGraph.GetStats().TransientImages, 3u);
+    ASSERT_EQ(plan.Placements.size(), 3u);
+    EXPECT_LT(plan.AliasedBytes, plan.UnaliasedBytes);
+}
+
+TEST_F(RenderGraphTest, ReusesCompiledGraphWhenStructureIsUnchanged)
+{
+    this->DeclareChain();
+    mGraph.Compile();
+    EXPECT_FALSE(mGraph.GetStats().bFromCache);
+    auto executionOrder = mGraph.GetExecutionOrder();
+
+    // 缓存的Pass仍指向上一帧的管线，mPipelines只增不减
+    mGraph.Reset();
+    this->DeclareChain();
+    mGraph.Compile();
+    EXPECT_TRUE(mGraph.GetStats().bFromCache);
+    EXPECT_EQ(mGraph.GetExecutionOrder(), executionOrder);
+
+    mGraph.Reset();
+    this->DeclareChain();
+    this->AddPass("Extra", { "T2" }, "Output");
+    mGraph.Compile();
+    EXPECT_FALSE(mGraph.GetStats().bFromCache);
+}
+
+TEST_F(RenderGraphTest, RecompilesWhenImportedImageChanges)
+{
+    this->DeclareChain();
+    mGraph.Compile();
+
+    // 导入图像的名字和用途不变，只有尺寸变化
+    mGraph.Reset();
+    mOutput.Init(Width / 2, Height / 2, Format::R8G8B8A8_UNORM, ImageUsage::COLOR_ATTACHMENT | ImageUsage::SHADER_READ, MemoryUsage::GPUOnly, ImageOptions::DEFAULT);
+    this->DeclareChain();
+    mGraph.Compile();
+    EXPECT_FALSE(mGraph.GetStats().bFromCache);
+}